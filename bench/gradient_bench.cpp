@@ -0,0 +1,162 @@
+#include "../include/rocket_model.hpp"
+#include "../include/simulation.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+/*
+        Cost of d(final landing state) / d(throttle schedule):
+  forward-mode AD (one Dual pass) against finite differences on the double
+  model and on the float Rocket itself, which runs the same templated
+  core.
+
+        A Dual step costs about one double step per direction, and finite
+  differences N + 1 double runs, so on the cheap double model the two are
+  close. The AD pass only carries the directions of the segments started
+  so far (N (N + 1) / 2 segment-directions instead of N^2), which keeps it
+  level with finite differences there while its derivatives are exact.
+  Against finite differences on Rocket, stepped as the game steps it, it is
+  several times faster.
+*/
+
+constexpr int SEGMENTS = 8;
+constexpr int STEPS_PER_SEGMENT = 30;
+constexpr double DT = 1. / 60.;
+
+using Clock = std::chrono::steady_clock;
+
+template <typename F> double timeIt(int repeats, F &&f) {
+  const auto begin = Clock::now();
+  for (int i = 0; i < repeats; i++)
+    f();
+  return std::chrono::duration<double, std::micro>(Clock::now() - begin)
+             .count() /
+         repeats;
+}
+
+void runRocket(Rocket &rocket, const SimState &start, const double *throttle,
+               double out[LANDING_STATE_SIZE]) {
+  rocket.restoreState(start);
+
+  for (int k = 0; k < SEGMENTS; k++) {
+    for (int i = 0; i < STEPS_PER_SEGMENT; i++) {
+      ControlInput input;
+      input.bottom = true;
+      input.dBottomOut = static_cast<float>(throttle[k]) -
+                         rocket.getBottomBooster().target_output;
+      stepRocket(rocket, input, static_cast<float>(DT));
+    }
+  }
+
+  out[0] = rocket.getPos().x;
+  out[1] = rocket.getPos().y;
+  out[2] = rocket.getVel().x;
+  out[3] = rocket.getVel().y;
+  out[4] = rocket.getAngle();
+  out[5] = rocket.getAngularVel();
+  out[6] = rocket.getMass();
+}
+
+void runModel(const RocketGeometry &geometry, const SimState &start,
+              const double *throttle, double out[LANDING_STATE_SIZE]) {
+  const auto model = runThrottleSchedule<double>(
+      geometry, start, throttle, SEGMENTS, STEPS_PER_SEGMENT, DT);
+
+  double state[LANDING_STATE_SIZE];
+  getLandingState(model, state);
+  std::copy(state, state + LANDING_STATE_SIZE, out);
+}
+
+// Forward differences: N + 1 runs.
+template <typename Run>
+void finiteDifferences(Run &&run, const double *throttle, double h,
+                       double jacobian[LANDING_STATE_SIZE][SEGMENTS]) {
+  double base[LANDING_STATE_SIZE];
+  run(throttle, base);
+
+  double perturbed[SEGMENTS];
+  std::copy(throttle, throttle + SEGMENTS, perturbed);
+
+  for (int j = 0; j < SEGMENTS; j++) {
+    double out[LANDING_STATE_SIZE];
+    perturbed[j] += h;
+    run(perturbed, out);
+    perturbed[j] = throttle[j];
+
+    for (int i = 0; i < LANDING_STATE_SIZE; i++)
+      jacobian[i][j] = (out[i] - base[i]) / h;
+  }
+}
+
+double maxRelativeError(const double a[LANDING_STATE_SIZE][SEGMENTS],
+                        const double b[LANDING_STATE_SIZE][SEGMENTS]) {
+  double worst = 0.;
+  for (int i = 0; i < LANDING_STATE_SIZE; i++) {
+    for (int j = 0; j < SEGMENTS; j++) {
+      const double scale = std::max(std::abs(a[i][j]), 1e-3);
+      worst = std::max(worst, std::abs(a[i][j] - b[i][j]) / scale);
+    }
+  }
+  return worst;
+}
+
+int main() {
+  Rocket rocket = createRocket(SITE_WIDTH, SITE_HEIGHT);
+  rocket.setInitialPosition(SITE_WIDTH / 2, -25);
+
+  const auto geometry = rocket.getGeometry();
+  const auto start = rocket.getState();
+
+  double throttle[SEGMENTS];
+  for (int j = 0; j < SEGMENTS; j++)
+    throttle[j] = 1.0 + 0.2 * j;
+
+  const int repeats = 200;
+
+  ScheduleJacobian<SEGMENTS> ad;
+  const double ad_us = timeIt(repeats, [&] {
+    ad = throttleScheduleJacobian<SEGMENTS>(geometry, start, throttle,
+                                            STEPS_PER_SEGMENT, DT);
+  });
+
+  double fd_model[LANDING_STATE_SIZE][SEGMENTS];
+  const double fd_model_us = timeIt(repeats, [&] {
+    finiteDifferences(
+        [&](const double *u, double *out) {
+          runModel(geometry, start, u, out);
+        },
+        throttle, 1e-6, fd_model);
+  });
+
+  double fd_rocket[LANDING_STATE_SIZE][SEGMENTS];
+  const double fd_rocket_us = timeIt(repeats, [&] {
+    finiteDifferences(
+        [&](const double *u, double *out) { runRocket(rocket, start, u, out); },
+        throttle, 1e-2, fd_rocket);
+  });
+
+  double single_run[LANDING_STATE_SIZE];
+  const double model_run_us = timeIt(
+      repeats, [&] { runModel(geometry, start, throttle, single_run); });
+
+  std::printf("Gradient of %d final state values w.r.t. %d throttle "
+              "segments (%d steps)\n",
+              LANDING_STATE_SIZE, SEGMENTS, SEGMENTS * STEPS_PER_SEGMENT);
+  std::printf("%-28s %10s %10s %12s\n", "method", "us", "runs", "max rel err");
+  std::printf("%-28s %10.1f %10d %12s\n", "model<double> (1 run)",
+              model_run_us, 1, "-");
+  std::printf("%-28s %10.1f %10d %12s\n", "forward AD (Dual<1..8>)", ad_us,
+              1, "reference");
+  std::printf("%-28s %10.1f %10d %12.2e\n", "finite diff model<double>",
+              fd_model_us, SEGMENTS + 1,
+              maxRelativeError(ad.jacobian, fd_model));
+  std::printf("%-28s %10.1f %10d %12.2e\n", "finite diff Rocket (float)",
+              fd_rocket_us, SEGMENTS + 1,
+              maxRelativeError(ad.jacobian, fd_rocket));
+  std::printf("AD speedup vs Rocket finite differences: %.1fx\n",
+              fd_rocket_us / ad_us);
+
+  return 0;
+}
@@ -0,0 +1,320 @@
+#include "../include/rocket_model.hpp"
+#include "../include/simulation.hpp"
+#include "../include/world.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <type_traits>
+#include <vector>
+
+/*
+        Throughput and drift of RocketModel under each precision policy.
+
+        precision-bench [float|double|fixed ...]
+        precision-bench --parity
+
+        Every mode flies the same open loop: the main engine through a
+  throttle schedule, the side engines rocking the vehicle, 20 s at 120 Hz.
+  Drift is the distance from the double run after 1, 10 and 20 s. The
+  fixed run also prints a hash of its final state: it is the same on every
+  machine and build, so two hosts can check they are in lockstep.
+
+        Rocket is RocketModel<float> with a look, but the game steps it
+  through stepRocket() and ControlInput's deltas, not ModelControl's
+  absolute targets. So Rocket flies the open loop too, step for step
+  beside RocketModel<float>. Their distance has to stay within
+  PARITY_FACTOR times the float model's own rounding drift from double;
+  past that the game no longer flies what the optimizer and the benches
+  model, and the bench exits with status 1. --parity runs only this check
+  (the rocket-model-parity test).
+
+        Then a long-range descent: World, in float, falls from 100 km with
+  the origin fixed and with it following the vehicle, checked against the
+  double model over 2 minutes.
+*/
+
+constexpr double DT = 1. / 120.;
+constexpr long STEPS = 2400;
+constexpr long HORIZONS[] = {120, 1200, 2400};
+constexpr int HORIZON_COUNT = 3;
+constexpr int TIMING_RUNS = 5;
+
+constexpr double SCHEDULE[] = {3., 2., 2.5, 1.5, 3., 2., 1., 2.5};
+constexpr long SEGMENT_STEPS = 300;
+
+constexpr double PARITY_FACTOR = 8.;
+constexpr double PARITY_FLOOR = 2e-5; // m, for runs with no drift yet.
+
+constexpr float DESCENT_START_Y = -1e5f; // 100 km above the site top.
+constexpr long DESCENT_STEPS = 14400;
+constexpr long DESCENT_HORIZONS[] = {1200, 7200, 14400};
+constexpr float DESCENT_REBASE = 64.f;
+
+using Clock = std::chrono::steady_clock;
+
+// The open loop with its outputs converted to S once, like the model's
+// constants, so a fixed run does no floating point per step.
+template <typename S> struct OpenLoop {
+  S throttle[8];
+  S side = 0.3;
+
+  OpenLoop() {
+    for (int i = 0; i < 8; i++)
+      throttle[i] = SCHEDULE[i];
+  }
+
+  ModelControl<S> at(long t) const {
+    ModelControl<S> control;
+    control.bottom = true;
+    control.bottom_target = throttle[t / SEGMENT_STEPS % 8];
+
+    const long phase = t / 90 % 4;
+    control.left = phase == 1;
+    control.right = phase == 3;
+    control.left_target = side;
+    control.right_target = side;
+    return control;
+  }
+};
+
+struct Sample {
+  double x, y, vx, vy, angle, mass;
+};
+
+template <typename S> Sample sampleOf(const RocketModel<S> &model) {
+  return {double(model.pos.x), double(model.pos.y), double(model.vel.x),
+          double(model.vel.y), double(model.angle), double(model.mass)};
+}
+
+struct Run {
+  Sample at[HORIZON_COUNT];
+  double ns_per_step;
+  std::uint64_t hash = 0; // Fixed only.
+};
+
+// FNV-1a over the raw bits of the final state.
+std::uint64_t stateHash(const RocketModel<Fixed> &model) {
+  const Fixed values[] = {model.pos.x, model.pos.y,  model.vel.x, model.vel.y,
+                          model.angle, model.angVel, model.mass};
+  std::uint64_t hash = 14695981039346656037ull;
+  for (const auto &value : values) {
+    auto raw = std::uint64_t(value.getRaw());
+    for (int i = 0; i < 8; i++, raw >>= 8) {
+      hash ^= raw & 0xff;
+      hash *= 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
+template <typename S>
+Run fly(const RocketGeometry &geometry, const SimState &start) {
+  Run run;
+  const OpenLoop<S> loop;
+  const S dt = DT;
+
+  {
+    RocketModel<S> model(geometry, start);
+    int h = 0;
+    for (long t = 0; t < STEPS; t++) {
+      model.step(loop.at(t), dt);
+      if (t + 1 == HORIZONS[h])
+        run.at[h++] = sampleOf(model);
+    }
+    if constexpr (std::is_same_v<S, Fixed>)
+      run.hash = stateHash(model);
+  }
+
+  std::vector<double> times;
+  for (int r = 0; r < TIMING_RUNS; r++) {
+    RocketModel<S> model(geometry, start);
+    const auto begin = Clock::now();
+    for (long t = 0; t < STEPS; t++)
+      model.step(loop.at(t), dt);
+    times.push_back(
+        std::chrono::duration<double, std::nano>(Clock::now() - begin)
+            .count() /
+        STEPS);
+    asm volatile("" : : "r,m"(model.pos.y) : "memory");
+  }
+  std::sort(times.begin(), times.end());
+  run.ns_per_step = times[TIMING_RUNS / 2];
+
+  return run;
+}
+
+struct Parity {
+  double divergence; // Worst Rocket to RocketModel<float> distance (m).
+  double rounding;   // Worst RocketModel<float> to <double> distance (m).
+};
+
+Parity checkParity(const Rocket &prototype) {
+  Rocket rocket = prototype;
+  const auto start = rocket.getState();
+  RocketModel<float> model(rocket.getGeometry(), start);
+  RocketModel<double> reference(rocket.getGeometry(), start);
+  const OpenLoop<float> loop;
+  const OpenLoop<double> reference_loop;
+
+  Parity parity = {0., 0.};
+  for (long t = 0; t < STEPS; t++) {
+    const auto control = loop.at(t);
+
+    ControlInput input;
+    input.bottom = control.bottom;
+    input.left = control.left;
+    input.right = control.right;
+    input.dBottomOut =
+        control.bottom_target - rocket.getBottomBooster().target_output;
+    input.dLeftOut =
+        control.left_target - rocket.getLeftBooster().target_output;
+    input.dRightOut =
+        control.right_target - rocket.getRightBooster().target_output;
+
+    stepRocket(rocket, input, float(DT));
+    model.step(control, float(DT));
+    reference.step(reference_loop.at(t), DT);
+
+    const auto pos = rocket.getPos();
+    parity.divergence =
+        std::max(parity.divergence,
+                 std::hypot(double(pos.x) - model.pos.x,
+                            double(pos.y) - model.pos.y));
+    parity.rounding = std::max(
+        parity.rounding, std::hypot(double(model.pos.x) - reference.pos.x,
+                                    double(model.pos.y) - reference.pos.y));
+  }
+  return parity;
+}
+
+// Prints the parity line; false when Rocket and the model have diverged.
+bool reportParity(const Rocket &rocket) {
+  const auto parity = checkParity(rocket);
+  const double limit = std::max(PARITY_FACTOR * parity.rounding, PARITY_FLOOR);
+  std::printf("Rocket against RocketModel<float>: %.3g m apart, limit "
+              "%.3g m (%.0fx float rounding)\n",
+              parity.divergence, limit, PARITY_FACTOR);
+  if (parity.divergence <= limit)
+    return true;
+
+  std::fprintf(stderr, "precision-bench: Rocket and RocketModel have "
+                       "diverged\n");
+  return false;
+}
+
+struct Descent {
+  double error[HORIZON_COUNT]; // Meters from the double model.
+  double ns_per_step;
+};
+
+Descent descend(const Rocket &rocket, const Terrain &terrain,
+                float rebase_distance) {
+  const auto start = rocket.getState();
+  RocketModel<double> reference(rocket.getGeometry(), start);
+
+  World world(terrain, 1);
+  world.rebase_distance = rebase_distance;
+  world.addVehicle(rocket);
+
+  Descent descent;
+  int h = 0;
+  const auto begin = Clock::now();
+  double model_ns = 0.;
+  for (long t = 0; t < DESCENT_STEPS; t++) {
+    world.step(float(DT));
+
+    const auto model_begin = Clock::now();
+    reference.step(ModelControl<double>{}, DT);
+    model_ns +=
+        std::chrono::duration<double, std::nano>(Clock::now() - model_begin)
+            .count();
+
+    if (t + 1 == DESCENT_HORIZONS[h]) {
+      const auto pos = world.getWorldPos(0);
+      descent.error[h++] = std::hypot(pos.x - double(reference.pos.x),
+                                      pos.y - double(reference.pos.y));
+    }
+  }
+  descent.ns_per_step =
+      (std::chrono::duration<double, std::nano>(Clock::now() - begin).count() -
+       model_ns) /
+      DESCENT_STEPS;
+  return descent;
+}
+
+int main(int argc, char **argv) {
+  try {
+    // As main.cpp builds them.
+    Rocket rocket = createRocket(SITE_WIDTH, SITE_HEIGHT);
+    if (argc == 2 && std::strcmp(argv[1], "--parity") == 0)
+      return reportParity(rocket) ? 0 : 1;
+
+    std::vector<Precision> modes;
+    for (int i = 1; i < argc; i++)
+      modes.push_back(parsePrecision(argv[i]));
+    if (modes.empty())
+      modes = {Precision::FLOAT, Precision::DOUBLE, Precision::FIXED};
+
+    const auto geometry = rocket.getGeometry();
+    const auto start = rocket.getState();
+
+    const Run reference = fly<double>(geometry, start);
+
+    std::printf("%-8s %10s %12s   %-6s %12s %12s %10s %10s\n", "mode",
+                "ns/step", "steps/s", "after", "pos (m)", "vel (m/s)",
+                "angle", "mass (kg)");
+    for (const auto mode : modes) {
+      const Run run = withPrecision(mode, [&](auto scalar) {
+        return fly<decltype(scalar)>(geometry, start);
+      });
+
+      for (int h = 0; h < HORIZON_COUNT; h++) {
+        const auto &a = run.at[h];
+        const auto &b = reference.at[h];
+        const double pos = std::hypot(a.x - b.x, a.y - b.y);
+        const double vel = std::hypot(a.vx - b.vx, a.vy - b.vy);
+
+        if (h == 0)
+          std::printf("%-8s %10.1f %12.0f", precisionName(mode),
+                      run.ns_per_step, 1e9 / run.ns_per_step);
+        else
+          std::printf("%-8s %10s %12s", "", "", "");
+        std::printf("   %4.0f s %12.3g %12.3g %10.3g %10.3g\n",
+                    HORIZONS[h] * DT, pos, vel, std::abs(a.angle - b.angle),
+                    std::abs(a.mass - b.mass));
+      }
+      if (mode == Precision::FIXED)
+        std::printf("fixed final state hash: %016llx\n",
+                    static_cast<unsigned long long>(run.hash));
+    }
+
+    std::printf("\n");
+    if (!reportParity(rocket))
+      return 1;
+
+    Rocket high = rocket;
+    auto state = start;
+    state.pos.y = DESCENT_START_Y;
+    high.restoreState(state);
+    const Terrain terrain = createTerrain(SITE_WIDTH, SITE_HEIGHT);
+
+    std::printf("\ndescent from 100 km, World in float against the double "
+                "model\n%-8s %10s   %12s %12s %12s\n",
+                "origin", "ns/step", "10 s (m)", "60 s (m)", "120 s (m)");
+    for (const float rebase : {0.f, DESCENT_REBASE}) {
+      const auto descent = descend(high, terrain, rebase);
+      std::printf("%-8s %10.1f   %12.3g %12.3g %12.3g\n",
+                  rebase > 0.f ? "floating" : "fixed", descent.ns_per_step,
+                  descent.error[0], descent.error[1], descent.error[2]);
+    }
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "precision-bench: %s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,723 @@
+#include "../include/contact.hpp"
+#include "../include/genetic_algorithm.hpp"
+#include "../include/mission.hpp"
+#include "../include/nozzle.hpp"
+#include "../include/rocket_env.h"
+#include "../include/simulation.hpp"
+#include "../include/telemetry.hpp"
+#include "../include/terrain.hpp"
+#include "../include/wind.hpp"
+#include "../include/world.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/*
+        Hot path micro benchmarks and end to end macro benchmarks.
+
+        rocket-bench [--filter TEXT] [--min-time SECONDS] [--json FILE]
+                     [--baseline FILE] [--threshold PERCENT]
+
+        Micro benchmarks report the median ns per call over 5 batches, each
+  batch sized to take --min-time / 5; macro benchmarks report a rate
+  (simulated seconds per wall second, GA generations per minute), the
+  median of 3 runs. "spread" is (max - min) / median of the samples.
+
+        --json writes the results ("-" for stdout, the table then goes to
+  stderr). --baseline compares with a file written by --json and exits
+  with 1 when a benchmark got slower by more than --threshold percent
+  (default 10). A slowdown where the current or the baseline spread is
+  above the threshold is reported as noisy, not as a regression.
+*/
+
+using Clock = std::chrono::steady_clock;
+
+constexpr float DT = 1.f / 120.f;
+constexpr int MICRO_SAMPLES = 5;
+constexpr int MACRO_SAMPLES = 3;
+
+// Keeps the compiler from dropping a result nobody reads.
+template <typename T> void keep(const T &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+struct BenchResult {
+  std::string name;
+  const char *unit;
+  bool higher_is_better;
+  double value;
+  double spread;
+};
+
+double median(std::vector<double> samples) {
+  std::sort(samples.begin(), samples.end());
+  return samples[samples.size() / 2];
+}
+
+double spreadOf(const std::vector<double> &samples) {
+  const auto [lo, hi] = std::minmax_element(samples.begin(), samples.end());
+  const double mid = median(samples);
+  return mid > 0. ? (*hi - *lo) / mid : 0.;
+}
+
+class Bench {
+public:
+  // Results are printed to log as they come.
+  Bench(const char *filter, double min_time, std::FILE *log)
+      : filter(filter), min_time(min_time), log(log) {}
+
+  // reset runs before every batch, untimed; op is timed n times per batch,
+  // n at most max_batch. A sample adds up batches until it lasts
+  // batch_time, so a capped batch is not left to a single timer tick.
+  void micro(const char *name, const std::function<void()> &reset,
+             const std::function<void()> &op, long max_batch = 1l << 30) {
+    if (!selected(name))
+      return;
+
+    const double batch_time = min_time / MICRO_SAMPLES;
+    long n = 1;
+    while (runBatch(reset, op, n) < batch_time && n < max_batch)
+      n = std::min(n * 2, max_batch);
+
+    std::vector<double> samples;
+    for (int s = 0; s < MICRO_SAMPLES; s++) {
+      double time = 0.;
+      long ops = 0;
+      do {
+        time += runBatch(reset, op, n);
+        ops += n;
+      } while (time < batch_time);
+      samples.push_back(time * 1e9 / ops);
+    }
+
+    add({name, "ns/op", false, median(samples), spreadOf(samples)});
+  }
+
+  // run returns the rate of one run.
+  void macro(const char *name, const char *unit,
+             const std::function<double()> &run) {
+    if (!selected(name))
+      return;
+
+    std::vector<double> samples;
+    for (int s = 0; s < MACRO_SAMPLES; s++)
+      samples.push_back(run());
+
+    add({name, unit, true, median(samples), spreadOf(samples)});
+  }
+
+  const std::vector<BenchResult> &getResults() const { return results; }
+
+private:
+  const char *filter;
+  double min_time;
+  std::FILE *log;
+  std::vector<BenchResult> results;
+
+  bool selected(const char *name) const {
+    return !filter || std::strstr(name, filter);
+  }
+
+  static double runBatch(const std::function<void()> &reset,
+                         const std::function<void()> &op, long n) {
+    reset();
+    const auto begin = Clock::now();
+    for (long i = 0; i < n; i++)
+      op();
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+  }
+
+  void add(const BenchResult &result) {
+    std::fprintf(log, "%-36s %14.2f %-8s spread %5.1f%%\n",
+                 result.name.c_str(), result.value, result.unit,
+                 result.spread * 100.);
+    std::fflush(log);
+    results.push_back(result);
+  }
+};
+
+void writeJson(std::ostream &out, const std::vector<BenchResult> &results) {
+  // One benchmark per line: readBaseline() depends on it.
+  out << "{\n  \"version\": 1,\n  \"benchmarks\": [\n";
+  for (std::size_t i = 0; i < results.size(); i++) {
+    const auto &r = results[i];
+    out << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit
+        << "\", \"value\": " << r.value << ", \"spread\": " << r.spread
+        << ", \"higher_is_better\": "
+        << (r.higher_is_better ? "true" : "false") << "}"
+        << (i + 1 < results.size() ? "," : "") << "\n";
+  }
+  out << "  ]\n}\n";
+}
+
+struct BaselineEntry {
+  double value;
+  double spread;
+};
+
+// Reads what writeJson() writes: name -> value and spread.
+std::map<std::string, BaselineEntry> readBaseline(const char *path) {
+  std::ifstream in(path);
+  if (!in)
+    throw std::runtime_error(std::string("Cannot open baseline ") + path);
+
+  std::map<std::string, BaselineEntry> entries;
+  std::string line;
+  while (std::getline(in, line)) {
+    const auto name = line.find("\"name\": \"");
+    const auto value = line.find("\"value\": ");
+    const auto spread = line.find("\"spread\": ");
+    if (name == std::string::npos || value == std::string::npos)
+      continue;
+
+    const auto begin = name + 9;
+    const auto end = line.find('"', begin);
+    entries[line.substr(begin, end - begin)] = {
+        std::strtod(line.c_str() + value + 9, nullptr),
+        spread == std::string::npos
+            ? 0.
+            : std::strtod(line.c_str() + spread + 10, nullptr)};
+  }
+  return entries;
+}
+
+// Prints the change of every benchmark; true when one regressed.
+bool compare(std::FILE *log, const std::vector<BenchResult> &results,
+             const std::map<std::string, BaselineEntry> &baseline,
+             double threshold) {
+  bool regressed = false;
+
+  std::fprintf(log, "\n%-36s %14s %14s %9s\n", "benchmark", "baseline",
+               "current", "change");
+  for (const auto &r : results) {
+    const auto found = baseline.find(r.name);
+    if (found == baseline.end() || found->second.value <= 0.) {
+      std::fprintf(log, "%-36s %14s %14.2f %9s\n", r.name.c_str(), "-",
+                   r.value, "new");
+      continue;
+    }
+
+    // Positive is better for both kinds.
+    const auto &base = found->second;
+    const double change = r.higher_is_better ? r.value / base.value - 1.
+                                             : base.value / r.value - 1.;
+    // Either run too unsteady to tell a slowdown from noise.
+    const bool noisy = std::max(r.spread, base.spread) > threshold;
+    const bool worse = change < -threshold;
+    regressed |= worse && !noisy;
+
+    std::fprintf(log, "%-36s %14.2f %14.2f %+8.1f%%%s\n", r.name.c_str(),
+                 base.value, r.value, change * 100.,
+                 !worse ? "" : noisy ? "  noisy" : "  REGRESSION");
+  }
+
+  return regressed;
+}
+
+/* Micro benchmarks */
+
+void benchBooster(Bench &bench, const Rocket &prototype) {
+  RocketBooster booster = prototype.getBottomBooster();
+  booster.curr_output = booster.target_output = 1.f;
+  const float ae[2] = {booster.minAe, booster.maxAe};
+  long i = 0;
+
+  // A new nozzle area every call: the Newton solve and the exit state.
+  bench.micro(
+      "booster/calculate_mach", [] {},
+      [&] {
+        booster.curr_Ae = ae[i++ & 1];
+        booster.solve();
+        keep(booster.Mach);
+      });
+
+  // Same area: the nozzle solution is cached, only the thrust is left.
+  bench.micro(
+      "booster/get_force", [] {}, [&] { keep(booster.getForce()); });
+
+  Newton_Raphson solver;
+  const double gamma = booster.gamma;
+  const double epsilon = booster.maxAe / booster.maxAt;
+  nozzle::solveExitMach(gamma, epsilon, 2., solver);
+  bench.micro(
+      "newton_raphson/solve", [] {}, [&] { keep(solver.solve(2.)); });
+}
+
+void benchRocket(Bench &bench, const Rocket &prototype) {
+  Rocket rocket = prototype;
+  const auto start = prototype.getState();
+
+  // Free fall: drag settles the speed, so batches of any size stay finite.
+  bench.micro(
+      "rocket/update", [&] { rocket.restoreState(start); },
+      [&] {
+        rocket.update(DT);
+        keep(rocket.getPos());
+      });
+
+  bench.micro(
+      "rocket/update_cm_and_inertia", [] {},
+      [&] {
+        rocket.updateCmAndInertia();
+        keep(rocket.getInertia());
+      });
+
+  ControlInput burn;
+  burn.bottom = true;
+  bench.micro(
+      "rocket/step_burning",
+      [&] {
+        rocket.restoreState(start);
+        rocket.setBoosterOutputs(0.f, 0.f, 1.f);
+      },
+      [&] {
+        stepRocket(rocket, burn, DT);
+        keep(rocket.getPos());
+      });
+}
+
+void benchContact(Bench &bench, const Rocket &prototype,
+                  const Terrain &terrain) {
+  // Let the prototype settle on the ground first.
+  World settle(terrain, 1);
+  settle.addVehicle(prototype);
+  for (int i = 0; i < 5 * 120; i++)
+    settle.step(DT);
+
+  Rocket rocket = settle.getVehicle(0);
+  const auto resting = rocket.getState();
+  ContactSolver solver(rocket);
+  solver.setTerrain(terrain);
+  solver.step(rocket, {}, DT);
+
+  // resolveGroundContact's successors: the swept step and the solver alone.
+  bench.micro(
+      "contact/step_resting", [&] { rocket.restoreState(resting); },
+      [&] { keep(solver.step(rocket, {}, DT)); });
+
+  bench.micro(
+      "contact/solve_resting", [&] { rocket.restoreState(resting); },
+      [&] { keep(solver.solve(rocket, DT)); });
+
+  // One airborne vehicle, all a World step costs before telemetry.
+  World flying(terrain, 1);
+  Rocket dropped = prototype;
+  dropped.setInitialPosition(SITE_WIDTH * 0.5f, SITE_HEIGHT * 0.2f);
+  flying.addVehicle(dropped);
+  WorldState airborne;
+  flying.saveState(airborne);
+  bench.micro("world/step_flying", [] {}, [&] {
+    flying.restoreState(airborne);
+    flying.step(DT);
+    keep(flying.getVehicle(0).getPos());
+  });
+
+  // The same step with the vehicle flown in double and in fixed point
+  // (FlightModel): the model step plus its float mirror.
+  for (const auto precision : {Precision::DOUBLE, Precision::FIXED}) {
+    World precise(terrain, 1, precision);
+    precise.addVehicle(dropped);
+    WorldState start;
+    precise.saveState(start);
+    const auto name = std::string("world/step_flying_") +
+                      precisionName(precision);
+    bench.micro(name.c_str(), [] {}, [&] {
+                  precise.restoreState(start);
+                  precise.step(DT);
+                  keep(precise.getVehicle(0).getPos());
+                });
+  }
+
+  // What the physics thread pays per step for telemetry: one row. Called
+  // back to back the writer falls behind, which a 120 Hz flight (a block
+  // every 8.5 s) never makes it do, so each batch starts on an empty block
+  // with the writer idle and stays within it. Budget: 5% of
+  // world/step_flying.
+  TelemetryRecorder telemetry("/dev/null", DT);
+  const auto contact = solver.step(rocket, {}, DT);
+  std::uint32_t tick = 0;
+  const auto record = [&] { telemetry.record(++tick, rocket, contact); };
+  bench.micro(
+      "telemetry/record",
+      [&] {
+        while (telemetry.getRecords() % TelemetryRecorder::BLOCK_CAPACITY)
+          record();
+        const auto until = Clock::now() + std::chrono::microseconds(50);
+        while (Clock::now() < until) {
+        }
+      },
+      record, TelemetryRecorder::BLOCK_CAPACITY - 1);
+}
+
+void benchGenetic(Bench &bench) {
+  constexpr int POPULATION = 64;
+  constexpr int DNA_SIZE = 16;
+  constexpr int BEST = 5;
+
+  gen.seed(1);
+  std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+  auto pop = initial_pop<float>(POPULATION, [&] {
+    DNA<float> dna(DNA_SIZE);
+    for (auto &v : dna)
+      v = uniform(gen);
+    return dna;
+  });
+  for (auto &gene : pop)
+    gene.fitness = 0.1 + uniform(gen);
+
+  bench.micro(
+      "ga/selection", [] {},
+      [&] { keep(selection<float>(BEST, pop).size()); });
+
+  bench.micro(
+      "ga/crossover", [] {},
+      [&] { keep(crossover(pop[0], pop[1]).dna.size()); });
+
+  const auto best = selection<float>(BEST, pop);
+  const auto tournament = Rules::Tournament::Tournament_K_best<float>(3);
+  const mut_rule<float> mutation = [&](float &v) { v = uniform(gen); };
+  Population<float> next(POPULATION);
+
+  bench.micro(
+      "ga/create_next_generation", [] {},
+      [&] {
+        create_next_generation(next, pop, best, mutation, 0.1, tournament);
+        keep(next[POPULATION - 1].dna.size());
+      });
+}
+
+void benchWind(Bench &bench, const WindField &field) {
+  constexpr std::size_t POINTS = 16;
+  WindParams params;
+  params.speed = 1.f;
+  params.gust = 0.333f;
+
+  float x[POINTS], y[POINTS], u[POINTS], v[POINTS];
+  for (std::size_t i = 0; i < POINTS; i++) {
+    x[i] = 2.333f + 0.75f * i;
+    y[i] = SITE_HEIGHT * 0.2f - 0.5f * (i % 3);
+  }
+
+  double time = 0.;
+  bench.micro(
+      "wind/sample_16", [] {},
+      [&] {
+        field.sample(params, x, y, POINTS, time, u, v);
+        time += DT;
+        keep(u[POINTS - 1] + v[POINTS - 1]);
+      });
+}
+
+// One vectorized step of 64 environments on one thread, one physics step
+// each: the physics plus the per environment API overhead.
+void benchEnv(Bench &bench) {
+  constexpr std::uint32_t COUNT = 64;
+  RocketEnvConfig config;
+  rocket_env_default_config(&config);
+  config.count = COUNT;
+  config.threads = 1;
+  config.action_repeat = 1;
+
+  RocketEnv *env = rocket_env_create(&config);
+  if (!env)
+    throw std::runtime_error(rocket_env_last_error());
+
+  std::vector<float> actions(COUNT * ROCKET_ENV_ACTION_SIZE, 0.5f);
+  std::vector<float> obs(COUNT * ROCKET_ENV_OBS_SIZE);
+  std::vector<float> rewards(COUNT);
+  std::vector<std::uint8_t> dones(COUNT);
+  rocket_env_reset(env, nullptr, obs.data());
+
+  bench.micro(
+      "env/step_64", [] {},
+      [&] {
+        rocket_env_step(env, actions.data(), obs.data(), rewards.data(),
+                        dones.data());
+        keep(obs[0]);
+      });
+
+  rocket_env_destroy(env);
+}
+
+// Engine pulses on timed waits and polled conditions, periods spread over
+// the vehicles so every tick resumes a few of them.
+Mission pulse(MissionControl &mc) {
+  const float period = 0.1f + 0.01f * (mc.getVehicle() % 64);
+  for (;;) {
+    mc.fire(Engine::MAIN, true);
+    co_await mc.wait(period);
+    mc.fire(Engine::MAIN, false);
+    const double end = mc.time() + period;
+    co_await mc.until(
+        [end](const MissionControl &mc) { return mc.time() >= end; });
+  }
+}
+
+// One sequencer tick over 4096 scripted vehicles, commands handed to the
+// world; the world itself is not stepped.
+void benchMission(Bench &bench, const Rocket &prototype,
+                  const Terrain &terrain) {
+  constexpr std::size_t COUNT = 4096;
+  World world(terrain, 1);
+  for (std::size_t i = 0; i < COUNT; i++)
+    world.addVehicle(prototype);
+
+  MissionSequencer sequencer(world, DT);
+  for (std::size_t i = 0; i < COUNT; i++)
+    sequencer.start(i, pulse);
+
+  bench.micro(
+      "mission/tick_4096", [] {},
+      [&] {
+        sequencer.tick();
+        sequencer.apply(world);
+        keep(sequencer.getInput(COUNT - 1).bottom);
+      });
+}
+
+// Separating a stage, alone and as a World step; each op puts it back on
+// first (restoreState), which is timed too.
+void benchStaging(Bench &bench, const Terrain &terrain) {
+  auto params = defaultRocketParams(SITE_WIDTH, SITE_HEIGHT);
+  params.stage_dry_mass = 20.f;
+  params.stage_fuel = 20.f;
+  const sf::Vector2f offset = {params.stage_x, params.stage_y};
+
+  Rocket whole = createRocket(params);
+  Rocket body = createStage(params);
+  const auto start = whole.getState();
+  bench.micro(
+      "rocket/separate", [] {},
+      [&] {
+        whole.restoreState(start);
+        whole.separate(1, body, offset);
+        keep(body.getPos());
+      });
+
+  World world(terrain, 1);
+  world.addVehicle(createRocket(params));
+  world.addStage(0, 1, createStage(params), offset);
+  WorldState mounted;
+  world.saveState(mounted);
+
+  ControlInput separate;
+  separate.stage = 1;
+  bench.micro(
+      "world/step_staging", [] {},
+      [&] {
+        world.restoreState(mounted);
+        world.setInput(0, separate);
+        world.step(DT);
+        keep(world.getVehicle(1).getPos());
+      });
+}
+
+/* Macro benchmarks */
+
+// Simulated seconds per wall second of one World run of sim_seconds.
+template <typename Setup, typename Tick>
+double worldRate(const Terrain &terrain, double sim_seconds, Setup &&setup,
+                 Tick &&tick) {
+  World world(terrain, 1);
+  setup(world);
+
+  const long ticks = static_cast<long>(sim_seconds / DT);
+  const auto begin = Clock::now();
+  for (long t = 0; t < ticks; t++) {
+    tick(world, t);
+    world.step(DT);
+  }
+  return sim_seconds /
+         std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+void benchWorld(Bench &bench, const Rocket &prototype, const Terrain &terrain,
+                const WindField &wind) {
+  // Take off, coast, fall back and come to rest: 60 s.
+  bench.macro("macro/world_flight", "sim_s/s", [&] {
+    return worldRate(
+        terrain, 60.,
+        [&](World &world) { world.addVehicle(prototype); },
+        [](World &world, long t) {
+          ControlInput input;
+          input.bottom = t < 240;
+          if (t == 0)
+            input.dBottomOut = 3.f;
+          if (t == 240)
+            input.dBottomOut = -3.f;
+          world.setInput(0, input);
+        });
+  });
+
+  // 16 vehicles dropped side by side, touching and settling: 30 s.
+  bench.macro("macro/world_16_vehicles", "sim_s/s", [&] {
+    return worldRate(
+        terrain, 30.,
+        [&](World &world) {
+          for (int i = 0; i < 16; i++) {
+            Rocket rocket = prototype;
+            rocket.setInitialPosition(2.333f + 0.75f * i,
+                                      SITE_HEIGHT * 0.2f - 0.5f * (i % 3));
+            world.addVehicle(rocket);
+          }
+        },
+        [](World &, long) {});
+  });
+
+  // The same drop in sheared, gusty wind: the cost of sampling the field.
+  bench.macro("macro/world_16_vehicles_wind", "sim_s/s", [&] {
+    WindParams params;
+    params.speed = 1.f;
+    params.ground_y = SITE_HEIGHT;
+    params.gust = 0.333f;
+    return worldRate(
+        terrain, 30.,
+        [&](World &world) {
+          world.setWind(&wind, params);
+          for (int i = 0; i < 16; i++) {
+            Rocket rocket = prototype;
+            rocket.setInitialPosition(2.333f + 0.75f * i,
+                                      SITE_HEIGHT * 0.2f - 0.5f * (i % 3));
+            world.addVehicle(rocket);
+          }
+        },
+        [](World &, long) {});
+  });
+}
+
+// Evolves an 8 segment throttle schedule for a soft landing; fitness
+// runs the real Rocket, so this is the end to end cost of a generation.
+void benchEvolution(Bench &bench, const Rocket &prototype) {
+  constexpr int POPULATION = 32;
+  constexpr int SEGMENTS = 8;
+  constexpr int STEPS_PER_SEGMENT = 30;
+  constexpr int GENERATIONS = 5;
+  constexpr int BEST = 4;
+
+  Rocket rocket = prototype;
+  rocket.setInitialPosition(SITE_WIDTH * 0.5f, -25.f);
+  const auto start = rocket.getState();
+
+  const auto evaluate = [&](const DNA<float> &throttle) {
+    rocket.restoreState(start);
+    for (int k = 0; k < SEGMENTS; k++) {
+      for (int i = 0; i < STEPS_PER_SEGMENT; i++) {
+        ControlInput input;
+        input.bottom = true;
+        input.dBottomOut =
+            throttle[k] - rocket.getBottomBooster().target_output;
+        stepRocket(rocket, input, DT);
+      }
+    }
+    return 1. / (1. + std::abs(rocket.getVel().y) +
+                 std::abs(rocket.getPos().y - SITE_HEIGHT * 0.6f) * 0.01);
+  };
+
+  bench.macro("macro/ga_generations", "gen/min", [&] {
+    gen.seed(1);
+    std::uniform_real_distribution<float> throttle(0.f, 4.f);
+    const mut_rule<float> mutation = [&](float &v) { v = throttle(gen); };
+    const auto tournament = Rules::Tournament::Tournament_K_best<float>(3);
+
+    auto pop = initial_pop<float>(POPULATION, [&] {
+      DNA<float> dna(SEGMENTS);
+      for (auto &v : dna)
+        v = throttle(gen);
+      return dna;
+    });
+    Population<float> next(POPULATION);
+
+    const auto begin = Clock::now();
+    for (int g = 0; g < GENERATIONS; g++) {
+      for (auto &gene : pop)
+        fitness<float>(gene, evaluate);
+
+      const auto best = selection<float>(BEST, pop);
+      create_next_generation(next, pop, best, mutation, 0.1, tournament);
+      pop.swap(next);
+    }
+    return GENERATIONS * 60. /
+           std::chrono::duration<double>(Clock::now() - begin).count();
+  });
+}
+
+int main(int argc, char **argv) {
+  const char *filter = nullptr;
+  const char *json_path = nullptr;
+  const char *baseline_path = nullptr;
+  double min_time = 0.5;
+  double threshold = 10.;
+
+  for (int i = 1; i < argc; i++) {
+    if (i + 1 < argc && !std::strcmp(argv[i], "--filter"))
+      filter = argv[++i];
+    else if (i + 1 < argc && !std::strcmp(argv[i], "--min-time"))
+      min_time = std::max(0.01, std::atof(argv[++i]));
+    else if (i + 1 < argc && !std::strcmp(argv[i], "--json"))
+      json_path = argv[++i];
+    else if (i + 1 < argc && !std::strcmp(argv[i], "--baseline"))
+      baseline_path = argv[++i];
+    else if (i + 1 < argc && !std::strcmp(argv[i], "--threshold"))
+      threshold = std::atof(argv[++i]);
+    else {
+      std::fprintf(stderr,
+                   "usage: %s [--filter TEXT] [--min-time SECONDS] "
+                   "[--json FILE] [--baseline FILE] [--threshold PERCENT]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+
+  try {
+    // Read first: a bad path should not cost a whole run.
+    std::map<std::string, BaselineEntry> baseline;
+    if (baseline_path)
+      baseline = readBaseline(baseline_path);
+
+    const Rocket prototype = createRocket(SITE_WIDTH, SITE_HEIGHT);
+    const Terrain terrain = createTerrain(SITE_WIDTH, SITE_HEIGHT);
+    const WindField wind;
+    const bool json_stdout = json_path && !std::strcmp(json_path, "-");
+    std::FILE *log = json_stdout ? stderr : stdout;
+    Bench bench(filter, min_time, log);
+
+    benchBooster(bench, prototype);
+    benchRocket(bench, prototype);
+    benchContact(bench, prototype, terrain);
+    benchGenetic(bench);
+    benchWind(bench, wind);
+    benchEnv(bench);
+    benchMission(bench, prototype, terrain);
+    benchStaging(bench, terrain);
+    benchWorld(bench, prototype, terrain, wind);
+    benchEvolution(bench, prototype);
+
+    if (json_stdout) {
+      writeJson(std::cout, bench.getResults());
+    } else if (json_path) {
+      std::ofstream out(json_path);
+      writeJson(out, bench.getResults());
+      if (!out)
+        throw std::runtime_error(std::string("Cannot write ") + json_path);
+    }
+
+    if (baseline_path &&
+        compare(log, bench.getResults(), baseline, threshold / 100.))
+      return 1;
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+}
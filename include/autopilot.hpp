@@ -0,0 +1,119 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "rocket.hpp"
+#include "simulation.hpp"
+#include "thread_pool.hpp"
+
+constexpr int AUTOPILOT_SEGMENTS = 6;
+
+/*
+        One piece of a candidate command sequence.
+
+        The flags fire the boosters during the whole segment. throttle is the
+  main engine target output (kg / s); it is reached through the same rate
+  limited deltas the Up/Down keys produce.
+*/
+struct PlanSegment {
+  bool bottom;
+  bool left;
+  bool right;
+  float throttle;
+};
+
+struct Plan {
+  PlanSegment segments[AUTOPILOT_SEGMENTS];
+};
+
+struct AutopilotConfig {
+  // Landing target: x of the pad center and y of the pad top (m, in the
+  // terrain frame).
+  float target_x = 0.f;
+  float ground_y = 0.f;
+
+  float step_dt = 1.f / 30.f; // Rollout time step.
+  int horizon_steps = 90;     // 3 s lookahead.
+  int max_candidates = 512;
+  std::chrono::microseconds budget{2000}; // Hard limit per tick.
+
+  float max_throttle = 3.f;       // kg / s
+  float max_throttle_rate = 10.f; // Same as the manual keys.
+  float safe_speed = 0.133f;      // Touchdown speed that does not explode.
+
+  unsigned threads = std::thread::hardware_concurrency();
+};
+
+struct AutopilotStats {
+  int candidates = 0;  // Rollouts finished in the last tick.
+  float tick_us = 0.f; // Wall time of the last tick.
+  float best_cost = 0.f;
+
+  float mean_tick_us = 0.f;
+  float max_tick_us = 0.f;
+  std::uint64_t ticks = 0;
+  std::uint64_t overruns = 0; // Ticks that went past the budget.
+};
+
+/*
+        Sampling model-predictive autopilot.
+
+        Every tick it forward-simulates as many candidate plans as fit in the
+  budget, starting from a SimState snapshot of the real rocket, and returns
+  the first command of the cheapest one. Candidates are the previous best
+  plan, mutations of it and fresh random plans. Each worker thread owns its
+  own Rocket, so rollouts only cost a restoreState.
+*/
+class Autopilot {
+public:
+  Autopilot(const Rocket &prototype, const AutopilotConfig &config);
+
+  // origin is World::getOrigin() when rocket flies in a World that
+  // rebases: its pose is relative to it, the target is not.
+  ControlInput tick(const Rocket &rocket, float dt,
+                    sf::Vector2<double> origin = {});
+
+  const AutopilotStats &getStats() const { return stats; }
+  const AutopilotConfig &getConfig() const { return config; }
+
+  void reset();
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  struct Worker {
+    Rocket rocket;
+    std::mt19937 rng;
+    Plan best_plan;
+    float best_cost;
+  };
+
+  AutopilotConfig config;
+  AutopilotStats stats;
+  ThreadPool pool;
+  std::vector<Worker> workers;
+
+  Plan best;
+  float plan_time; // Time since best.segments[0] started.
+  float landing_height; // Distance from the CM to the lowest point, upright.
+  // The target in the frame of the rocket being flown this tick.
+  float target_x, ground_y;
+
+  float rollout(Rocket &rocket, const SimState &start, const Plan &plan,
+                Clock::time_point deadline) const;
+  float touchdownCost(const Rocket &rocket) const;
+  float terminalCost(const Rocket &rocket, float height) const;
+
+  Plan randomPlan(std::mt19937 &rng) const;
+  Plan mutatePlan(const Plan &plan, std::mt19937 &rng) const;
+  float segmentDuration() const {
+    return config.horizon_steps * config.step_dt / AUTOPILOT_SEGMENTS;
+  }
+  void shiftPlan(float dt);
+  ControlInput toInput(const PlanSegment &segment, const Rocket &rocket,
+                       float dt) const;
+};
@@ -2,14 +2,31 @@
 
 #include <SFML/System/Vector2.hpp>
 
-// 60 pixel / 1 meter.
+// Typed constants rather than macros: they convert like any double, to
+// float, double or Fixed (fixed.hpp) alike.
+constexpr double PI = 3.14159265358979323846;
+constexpr double DEGREES_TO_RADIANS = PI / 180.;
+constexpr double RADIANS_TO_DEGREES = 180. / PI;
+
+/*
+        The simulation is SI throughout: meters, kilograms, seconds,
+  newtons. Pixels only exist where the app draws, PPM of them to the meter;
+  y points down, as on the screen.
+*/
 const float PPM = 60.f;
 
-// const auto AIR_DENSITY = 1.f;
-const auto AIR_DENSITY = 0.0005f;
-// const auto AIR_PRESSURE = 1.f;
-const auto AIR_PRESSURE = 101325.f;
-// const sf::Vector2f GRAVITY = {0.f, 98 * 7.f};
-const sf::Vector2f GRAVITY = {0.f, 9.8f * PPM * 1.f /*9.8f * PPM*/};
+// The default site (createTerrain(), defaultScenario()), meters: what the
+// app's 1000 x 1000 pixel window shows.
+const float SITE_WIDTH = 50.f / 3.f;
+const float SITE_HEIGHT = 50.f / 3.f;
+
+const auto STANDARD_GRAVITY = 9.8f; // m / s^2
+const auto GAS_CONSTANT = 8314.;    // Universal, J / (kmol K).
+
+// Tuned for the look of the flight rather than measured: about 90 times
+// the real 1.225 kg / m^3.
+const auto AIR_DENSITY = 108.f;
+const auto AIR_PRESSURE = 101325.f; // Pa, at every height.
+const sf::Vector2f GRAVITY = {0.f, STANDARD_GRAVITY};
 
 const auto DRAG_COEFFICIENT = 1.f;
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstdint>
+#include <vector>
+
+#include "rocket.hpp"
+#include "simulation.hpp"
+#include "static_grid.hpp"
+#include "terrain.hpp"
+
+inline float dot(const sf::Vector2f &a, const sf::Vector2f &b) {
+  return a.x * b.x + a.y * b.y;
+}
+inline float cross(const sf::Vector2f &a, const sf::Vector2f &b) {
+  return a.x * b.y - a.y * b.x;
+}
+inline sf::Vector2f cross(float w, const sf::Vector2f &r) {
+  return sf::Vector2f(-w * r.y, w * r.x);
+}
+
+// Oriented box that never moves (pads, ground).
+struct StaticBox {
+  sf::Vector2f center;
+  sf::Vector2f half; // Half extents.
+  float angle = 0.f; // Radians.
+  float friction = 0.5f;
+  float restitution = 0.15f;
+
+  static StaticBox fromRect(const sf::FloatRect &rect) {
+    StaticBox box;
+    box.half = {rect.width / 2.f, rect.height / 2.f};
+    box.center = {rect.left + box.half.x, rect.top + box.half.y};
+    return box;
+  }
+};
+
+struct ContactPoint {
+  sf::Vector2f point;  // World position.
+  sf::Vector2f normal; // Pushes the rocket out of the static body.
+  float penetration;
+  std::uint32_t id; // Feature id, stable between steps, for warm starting.
+
+  float friction, restitution;
+
+  // Solver data.
+  sf::Vector2f r; // From the CM.
+  float normal_mass, tangent_mass, bias; // bias: restitution target.
+  float normal_impulse, tangent_impulse;
+};
+
+constexpr int MAX_CONTACTS = 32;
+constexpr int MAX_HULL_PARTS = 8;
+
+// Feature id kinds (top bits of ContactPoint::id).
+constexpr std::uint32_t FEATURE_BOX_VERTEX = 0u << 28;
+constexpr std::uint32_t FEATURE_BOX_CORNER = 1u << 28;
+constexpr std::uint32_t FEATURE_TERRAIN_VERTEX = 2u << 28;
+constexpr std::uint32_t FEATURE_TERRAIN_POINT = 3u << 28;
+
+struct ContactManifold {
+  ContactPoint points[MAX_CONTACTS];
+  int count = 0;
+};
+
+// Outcome of ContactSolver::step().
+struct SweptStep {
+  bool touched = false;
+  int substeps = 0;
+  float impact_len_vel = 0.f; // getLenVel() before the first touching solve.
+};
+
+/*
+        Rocket against static geometry.
+
+        The rocket hull is its real shape (body, nose and the three thruster
+  boxes), transformed by the rocket pose, so tilted touchdowns get the right
+  contact points. Each step builds a manifold from hull vertices inside
+  static boxes or below the terrain, and box corners or ground points inside
+  hull boxes, then runs a sequential impulse solver (accumulated, clamped
+  normal and friction impulses, with contacts sharing a normal block solved
+  in pairs) warm started from the previous step by feature id. Penetration
+  is removed by separate position iterations (a translation along the
+  normals) instead of a velocity bias, so resting contact does not gain
+  energy or sag with dt.
+
+        Only statics and ground segments under the hull bounds are looked at
+  (uniform grid for the boxes, binary search on the terrain), so the cost
+  does not grow with the size of the map.
+
+        step() adds continuous detection on top: the tick is integrated, the
+  hull motion is swept against the statics and the ground and, on a hit,
+  the tick is replayed from its snapshot up to the time of impact, takes a
+  short step into the contact for the solver and sweeps the rest of the tick
+  again. Resting contacts that a coarse step would sink too deep are
+  sub-stepped as well. Ticks without either cost one sweep, so a coarse dt
+  stays cheap and cannot tunnel through a thin pad.
+*/
+class ContactSolver {
+public:
+  explicit ContactSolver(const Rocket &prototype);
+
+  void addStatic(const StaticBox &box) {
+    statics.push_back(box);
+    grid_dirty = true;
+  }
+  const std::vector<StaticBox> &getStatics() const { return statics; }
+
+  // Ground polyline and its pads (added as static boxes). terrain must
+  // outlive the solver.
+  void setTerrain(const Terrain &terrain);
+
+  // Where the rocket's frame starts in the frame of the statics and the
+  // terrain (World's floating origin). Rocket poses and contact points are
+  // in the rocket's frame.
+  void setOrigin(sf::Vector2f origin) { this->origin = origin; }
+  const sf::Vector2f &getOrigin() const { return origin; }
+
+  // Call after the rocket was integrated. True when it touches something.
+  bool solve(Rocket &rocket, float dt);
+
+  // More velocity iterations on the manifold of the last solve(), for when
+  // other impulses (another vehicle) changed the rocket velocity since.
+  void relax(Rocket &rocket, int count);
+
+  // One stepRocket() tick plus contacts, sub-stepped around impacts.
+  SweptStep step(Rocket &rocket, const ControlInput &input, float dt);
+
+  // Fraction of the motion from start to the rocket pose where a hull vertex
+  // first enters a static box (or a box corner a hull part); above 1 when
+  // nothing is hit. Features already overlapping at start are the solver's;
+  // contact_travel gets the farthest any of them moved.
+  float timeOfImpact(const SimState &start, const Rocket &rocket,
+                     float *contact_travel = nullptr) const;
+
+  // Fills manifold with the current contacts without touching the rocket.
+  void collide(const Rocket &rocket, ContactManifold &manifold) const;
+
+  const ContactManifold &getManifold() const { return manifold; }
+  // The manifold is the warm start of the next step: part of a snapshot.
+  void setManifold(const ContactManifold &last) { manifold = last; }
+
+  // Hull queries, also used for contacts between vehicles.
+  const std::vector<sf::Vector2f> &getHull() const { return hull; }
+  sf::FloatRect hullBounds(const sf::Transform &transform) const;
+  // Index of the hull part holding the world point, -1 if none. normal
+  // points into the hull, out of the shallowest part face.
+  int pointInParts(const sf::Vector2f &world, const sf::Transform &transform,
+                   const sf::Transform &inverse, float &depth,
+                   sf::Vector2f &normal) const;
+
+  int iterations = 10;
+  int position_iterations = 4;
+  float position_correction = 0.8f; // Fraction removed per step.
+  float slop = 0.008f;              // Allowed penetration (m).
+  float restitution_speed = 1.f; // No bounce below this approach speed.
+  int max_substeps = 32;
+  float substep_travel = 0.067f; // Hull travel per sub-step (m).
+
+private:
+  // Rocket hull boxes (design coordinates) and all hull vertices.
+  struct Part {
+    sf::Vector2f min, max;
+  };
+  std::vector<Part> parts;
+  std::vector<sf::Vector2f> hull;
+  float hull_radius = 0.f; // Farthest hull vertex from the CM.
+
+  std::vector<StaticBox> statics;
+  const Terrain *terrain = nullptr;
+  sf::Vector2f origin;
+
+  // Broadphase cache, rebuilt on the first query after addStatic().
+  mutable StaticGrid grid;
+  mutable bool grid_dirty = true;
+  ContactManifold manifold;
+  ContactManifold previous;
+  SimState start; // Snapshot for replaying a tick.
+  int partner[MAX_CONTACTS]; // Paired contact index, or -1.
+
+  const StaticGrid &broadphase() const;
+  // A rocket pose moved into the frame of the statics.
+  sf::Transform toStatics(const sf::Transform &pose) const;
+
+  void collideBox(std::uint32_t b, const sf::Transform &transform,
+                  const sf::Transform &inverse, ContactManifold &out) const;
+  void collideTerrain(const sf::Transform &transform,
+                      const sf::Transform &inverse, const sf::FloatRect &area,
+                      ContactManifold &out) const;
+  void prepare(const Rocket &rocket, float dt);
+  void warmStart(Rocket &rocket);
+  void solveNormalPair(Rocket &rocket, ContactPoint &c1,
+                       ContactPoint &c2) const;
+  void correctPositions(Rocket &rocket) const;
+  void applyImpulse(Rocket &rocket, const ContactPoint &c,
+                    const sf::Vector2f &impulse) const;
+};
@@ -0,0 +1,193 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+
+/*
+        Forward-mode dual number with N tangent directions.
+
+        v is the value and d[i] the derivative with respect to the i-th seed,
+  so one evaluation of a function templated on the scalar type gives a full
+  row of its Jacobian. Comparisons only look at the value, which makes the
+  branches of the physics piecewise differentiable.
+*/
+template <int N> struct Dual {
+  double v = 0.;
+  std::array<double, N> d{};
+
+  Dual() = default;
+  Dual(double value) : v(value) {}
+  // Widens: the same value and tangents, the extra directions zero.
+  template <int M> explicit Dual(const Dual<M> &x) : v(x.v) {
+    static_assert(M <= N, "narrowing would drop derivatives");
+    for (int i = 0; i < M; i++)
+      d[i] = x.d[i];
+  }
+
+  static Dual seed(double value, int i) {
+    Dual x(value);
+    x.d[i] = 1.;
+    return x;
+  }
+
+  Dual &operator+=(const Dual &o) {
+    v += o.v;
+    for (int i = 0; i < N; i++)
+      d[i] += o.d[i];
+    return *this;
+  }
+
+  Dual &operator-=(const Dual &o) {
+    v -= o.v;
+    for (int i = 0; i < N; i++)
+      d[i] -= o.d[i];
+    return *this;
+  }
+
+  Dual &operator*=(const Dual &o) {
+    for (int i = 0; i < N; i++)
+      d[i] = d[i] * o.v + v * o.d[i];
+    v *= o.v;
+    return *this;
+  }
+
+  Dual &operator/=(const Dual &o) {
+    const double inv = 1. / o.v;
+    for (int i = 0; i < N; i++)
+      d[i] = (d[i] - v * inv * o.d[i]) * inv;
+    v *= inv;
+    return *this;
+  }
+};
+
+// Applies the chain rule for f(x) with f'(x) = df.
+template <int N> Dual<N> chain(const Dual<N> &x, double fx, double df) {
+  Dual<N> r(fx);
+  for (int i = 0; i < N; i++)
+    r.d[i] = df * x.d[i];
+  return r;
+}
+
+template <int N> Dual<N> operator+(Dual<N> a, const Dual<N> &b) {
+  return a += b;
+}
+template <int N> Dual<N> operator-(Dual<N> a, const Dual<N> &b) {
+  return a -= b;
+}
+template <int N> Dual<N> operator*(Dual<N> a, const Dual<N> &b) {
+  return a *= b;
+}
+template <int N> Dual<N> operator/(Dual<N> a, const Dual<N> &b) {
+  return a /= b;
+}
+
+template <int N> Dual<N> operator+(Dual<N> a, double b) { return a += b; }
+template <int N> Dual<N> operator+(double a, Dual<N> b) { return b += a; }
+template <int N> Dual<N> operator-(Dual<N> a, double b) { return a -= b; }
+template <int N> Dual<N> operator-(double a, const Dual<N> &b) {
+  return Dual<N>(a) -= b;
+}
+
+template <int N> Dual<N> operator*(Dual<N> a, double b) {
+  a.v *= b;
+  for (int i = 0; i < N; i++)
+    a.d[i] *= b;
+  return a;
+}
+template <int N> Dual<N> operator*(double a, const Dual<N> &b) {
+  return b * a;
+}
+template <int N> Dual<N> operator/(const Dual<N> &a, double b) {
+  return a * (1. / b);
+}
+template <int N> Dual<N> operator/(double a, const Dual<N> &b) {
+  return Dual<N>(a) /= b;
+}
+
+template <int N> Dual<N> operator-(const Dual<N> &a) { return a * -1.; }
+
+template <int N> bool operator<(const Dual<N> &a, const Dual<N> &b) {
+  return a.v < b.v;
+}
+template <int N> bool operator>(const Dual<N> &a, const Dual<N> &b) {
+  return a.v > b.v;
+}
+template <int N> bool operator<=(const Dual<N> &a, const Dual<N> &b) {
+  return a.v <= b.v;
+}
+template <int N> bool operator>=(const Dual<N> &a, const Dual<N> &b) {
+  return a.v >= b.v;
+}
+template <int N> bool operator==(const Dual<N> &a, const Dual<N> &b) {
+  return a.v == b.v;
+}
+template <int N> bool operator<(const Dual<N> &a, double b) { return a.v < b; }
+template <int N> bool operator>(const Dual<N> &a, double b) { return a.v > b; }
+template <int N> bool operator<=(const Dual<N> &a, double b) {
+  return a.v <= b;
+}
+template <int N> bool operator>=(const Dual<N> &a, double b) {
+  return a.v >= b;
+}
+template <int N> bool operator==(const Dual<N> &a, double b) {
+  return a.v == b;
+}
+
+template <int N> Dual<N> sqrt(const Dual<N> &x) {
+  const double s = std::sqrt(x.v);
+  return chain(x, s, 0.5 / s);
+}
+
+template <int N> Dual<N> exp(const Dual<N> &x) {
+  const double e = std::exp(x.v);
+  return chain(x, e, e);
+}
+
+template <int N> Dual<N> log(const Dual<N> &x) {
+  return chain(x, std::log(x.v), 1. / x.v);
+}
+
+template <int N> Dual<N> sin(const Dual<N> &x) {
+  return chain(x, std::sin(x.v), std::cos(x.v));
+}
+
+template <int N> Dual<N> cos(const Dual<N> &x) {
+  return chain(x, std::cos(x.v), -std::sin(x.v));
+}
+
+template <int N> Dual<N> abs(const Dual<N> &x) {
+  return x.v < 0. ? -x : x;
+}
+
+template <int N> Dual<N> pow(const Dual<N> &x, double p) {
+  const double xp = std::pow(x.v, p);
+  return chain(x, xp, x.v == 0. ? 0. : p * xp / x.v);
+}
+
+template <int N> Dual<N> pow(const Dual<N> &x, const Dual<N> &p) {
+  const double xp = std::pow(x.v, p.v);
+  Dual<N> r(xp);
+  const double dx = x.v == 0. ? 0. : p.v * xp / x.v;
+  const double dp = x.v > 0. ? xp * std::log(x.v) : 0.;
+  for (int i = 0; i < N; i++)
+    r.d[i] = dx * x.d[i] + dp * p.d[i];
+  return r;
+}
+
+template <int N> bool isfinite(const Dual<N> &x) { return std::isfinite(x.v); }
+
+// Plain value of a scalar, for branches and output.
+inline double value(double x) { return x; }
+inline float value(float x) { return x; }
+template <int N> double value(const Dual<N> &x) { return x.v; }
+
+// Run constants of a model in scalar S (gravity, lever points,
+// thresholds, dt): S itself, except a plain double for Dual, whose
+// derivatives of them would all be zero.
+template <typename S> struct ConstantOf {
+  using type = S;
+};
+template <int N> struct ConstantOf<Dual<N>> {
+  using type = double;
+};
+template <typename S> using Constant = typename ConstantOf<S>::type;
@@ -0,0 +1,235 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cmath>
+#include <compare>
+#include <cstdint>
+
+/*
+        Q32.32 fixed point scalar: 32 integer bits (about +-2.1e9) and steps
+  of 2^-32 (2.3e-10).
+
+        Every operation, sqrt, sin, cos, log2, exp2 and pow included, is
+  integer arithmetic, so a run gives the same bits whatever the compiler,
+  flags or machine: the scalar for lockstep. Conversion from double rounds
+  to the nearest step with exact IEEE operations, so constants and float
+  inputs convert the same everywhere too. Products and quotients round to
+  nearest. Overflow is not checked; the rocket physics stays well inside
+  the range. Needs __int128 (GCC, Clang).
+*/
+class Fixed {
+public:
+  static constexpr int FRACTION_BITS = 32;
+  static constexpr std::int64_t ONE = std::int64_t(1) << FRACTION_BITS;
+
+  constexpr Fixed() = default;
+  Fixed(double value) : raw(std::llround(value * double(ONE))) {}
+
+  static constexpr Fixed fromRaw(std::int64_t raw) {
+    Fixed f;
+    f.raw = raw;
+    return f;
+  }
+  // num / den, rounded, at compile time.
+  static constexpr Fixed ratio(std::int64_t num, std::int64_t den) {
+    return fromRaw(((num << FRACTION_BITS) + den / 2) / den);
+  }
+
+  constexpr std::int64_t getRaw() const { return raw; }
+  explicit operator double() const { return double(raw) / double(ONE); }
+  explicit operator float() const { return float(double(*this)); }
+
+  constexpr Fixed &operator+=(Fixed o) {
+    raw += o.raw;
+    return *this;
+  }
+  constexpr Fixed &operator-=(Fixed o) {
+    raw -= o.raw;
+    return *this;
+  }
+  constexpr Fixed &operator*=(Fixed o) {
+    const __int128 product = __int128(raw) * o.raw;
+    raw = std::int64_t((product + (__int128(1) << (FRACTION_BITS - 1))) >>
+                       FRACTION_BITS);
+    return *this;
+  }
+  constexpr Fixed &operator/=(Fixed o) {
+    __int128 n = __int128(raw) * ONE;
+    const __int128 half = (o.raw < 0 ? -__int128(o.raw) : o.raw) / 2;
+    n += (n < 0) == (o.raw < 0) ? half : -half; // Half away from zero.
+    raw = std::int64_t(n / o.raw);
+    return *this;
+  }
+
+  friend constexpr Fixed operator+(Fixed a, Fixed b) { return a += b; }
+  friend constexpr Fixed operator-(Fixed a, Fixed b) { return a -= b; }
+  friend constexpr Fixed operator*(Fixed a, Fixed b) { return a *= b; }
+  friend constexpr Fixed operator/(Fixed a, Fixed b) { return a /= b; }
+  friend constexpr Fixed operator-(Fixed a) { return fromRaw(-a.raw); }
+
+  friend constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+  friend constexpr auto operator<=>(Fixed a, Fixed b) {
+    return a.raw <=> b.raw;
+  }
+
+private:
+  std::int64_t raw = 0;
+};
+
+namespace fixed_detail {
+
+constexpr Fixed HALF_PI = Fixed::fromRaw(6746518852);     // pi / 2
+constexpr Fixed TWO_OVER_PI = Fixed::fromRaw(2734261102); // 2 / pi
+
+// Mantissas in log2 / exp2: [1, 2) with 62 fraction bits.
+constexpr int Q = 62;
+
+// floor(sqrt(n)): Newton's method from a power of two above the root,
+// which decreases to it.
+inline std::uint64_t isqrt(unsigned __int128 n) {
+  if (n == 0)
+    return 0;
+
+  const auto high = std::uint64_t(n >> 64);
+  const int bits = high ? 128 - std::countl_zero(high)
+                        : 64 - std::countl_zero(std::uint64_t(n));
+  auto r = (unsigned __int128)1 << (bits + 1) / 2;
+  for (;;) {
+    const auto next = (r + n / r) / 2;
+    if (next >= r)
+      return std::uint64_t(r);
+    r = next;
+  }
+}
+
+// 2^(2^-(i + 1)) in Q62, by repeated square roots of 2.
+inline const std::array<std::uint64_t, 32> &exp2Table() {
+  static const auto table = [] {
+    std::array<std::uint64_t, 32> t{};
+    std::uint64_t x = std::uint64_t(1) << (Q + 1); // 2
+    for (auto &entry : t)
+      entry = x = isqrt((unsigned __int128)x << Q);
+    return t;
+  }();
+  return table;
+}
+
+} // namespace fixed_detail
+
+inline Fixed abs(Fixed x) { return x < Fixed() ? -x : x; }
+
+inline Fixed sqrt(Fixed x) {
+  if (x.getRaw() <= 0)
+    return Fixed();
+  return Fixed::fromRaw(std::int64_t(fixed_detail::isqrt(
+      (unsigned __int128)x.getRaw() << Fixed::FRACTION_BITS)));
+}
+
+// Reduces to r in [-pi / 4, pi / 4] around a quarter turn, then the Taylor
+// series to r^13 / r^14 (error below 2^-40 there).
+inline void sincos(Fixed x, Fixed &s, Fixed &c) {
+  using namespace fixed_detail;
+
+  const std::int64_t k =
+      ((x * TWO_OVER_PI).getRaw() + Fixed::ONE / 2) >> Fixed::FRACTION_BITS;
+  const Fixed r = Fixed::fromRaw(x.getRaw() - k * HALF_PI.getRaw());
+  const Fixed r2 = r * r;
+  const Fixed one = Fixed::fromRaw(Fixed::ONE);
+
+  Fixed sr = one - r2 * Fixed::ratio(1, 156);
+  sr = one - r2 * Fixed::ratio(1, 110) * sr;
+  sr = one - r2 * Fixed::ratio(1, 72) * sr;
+  sr = one - r2 * Fixed::ratio(1, 42) * sr;
+  sr = one - r2 * Fixed::ratio(1, 20) * sr;
+  sr = r * (one - r2 * Fixed::ratio(1, 6) * sr);
+
+  Fixed cr = one - r2 * Fixed::ratio(1, 182);
+  cr = one - r2 * Fixed::ratio(1, 132) * cr;
+  cr = one - r2 * Fixed::ratio(1, 90) * cr;
+  cr = one - r2 * Fixed::ratio(1, 56) * cr;
+  cr = one - r2 * Fixed::ratio(1, 30) * cr;
+  cr = one - r2 * Fixed::ratio(1, 12) * cr;
+  cr = one - r2 * Fixed::ratio(1, 2) * cr;
+
+  switch (k & 3) {
+  case 0:
+    s = sr, c = cr;
+    break;
+  case 1:
+    s = cr, c = -sr;
+    break;
+  case 2:
+    s = -sr, c = -cr;
+    break;
+  default:
+    s = -cr, c = sr;
+    break;
+  }
+}
+
+inline Fixed sin(Fixed x) {
+  Fixed s, c;
+  sincos(x, s, c);
+  return s;
+}
+
+inline Fixed cos(Fixed x) {
+  Fixed s, c;
+  sincos(x, s, c);
+  return c;
+}
+
+// x > 0. One squaring per fraction bit.
+inline Fixed log2(Fixed x) {
+  using fixed_detail::Q;
+
+  const auto v = std::uint64_t(x.getRaw());
+  const int msb = 63 - std::countl_zero(v);
+  std::uint64_t m = msb >= Q ? v >> (msb - Q) : v << (Q - msb);
+
+  std::int64_t result = std::int64_t(msb - Fixed::FRACTION_BITS)
+                        << Fixed::FRACTION_BITS;
+  for (int bit = Fixed::FRACTION_BITS - 1; bit >= 0; bit--) {
+    m = std::uint64_t(((unsigned __int128)m * m) >> Q);
+    if (m >> (Q + 1)) {
+      m >>= 1;
+      result |= std::int64_t(1) << bit;
+    }
+  }
+  return Fixed::fromRaw(result);
+}
+
+// 2^x: the integer part is a shift, the fraction a product of table
+// entries, one per set bit.
+inline Fixed exp2(Fixed x) {
+  using fixed_detail::Q;
+
+  const std::int64_t k = x.getRaw() >> Fixed::FRACTION_BITS;
+  const auto fraction = std::uint32_t(x.getRaw());
+  const auto &table = fixed_detail::exp2Table();
+
+  std::uint64_t m = std::uint64_t(1) << Q;
+  for (int i = 0; i < Fixed::FRACTION_BITS; i++)
+    if (fraction >> (Fixed::FRACTION_BITS - 1 - i) & 1)
+      m = std::uint64_t(((unsigned __int128)m * table[i]) >> Q);
+
+  const std::int64_t shift = Q - Fixed::FRACTION_BITS - k;
+  if (shift >= 64)
+    return Fixed();
+  if (shift <= 0)
+    return Fixed::fromRaw(std::int64_t(m << -shift));
+  return Fixed::fromRaw(
+      std::int64_t((m + (std::uint64_t(1) << (shift - 1))) >> shift));
+}
+
+// x^y for x > 0; 0 for x <= 0 (the physics only takes positive powers).
+inline Fixed pow(Fixed x, Fixed y) {
+  if (x.getRaw() <= 0)
+    return Fixed();
+  return exp2(y * log2(x));
+}
+
+// As value() and isfinite() of the other scalars: Fixed has no infinities.
+inline double value(Fixed x) { return double(x); }
+inline bool isfinite(Fixed) { return true; }
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/Graphics/View.hpp>
+#include <cstddef>
+#include <vector>
+
+#include "rocket.hpp"
+#include "sim_state.hpp"
+#include "thread_pool.hpp"
+
+/*
+        Draws many rockets of the same design with one draw call.
+
+        update() transforms the design polygons of every state on the CPU
+  into a single vertex array, skipping rockets outside the view. Chunks of
+  rockets are spread over the caller's pool; a fleet that fits in one chunk
+  stays on the calling thread. When a rocket would be smaller than
+  lod_line_px on screen it becomes a line from the nose tip to the bottom,
+  and below lod_point_px a single point. The vertex array only grows, so
+  steady-state frames do not allocate.
+*/
+class FleetRenderer : public sf::Drawable {
+public:
+  enum class Lod { Full, Line, Point };
+
+  // pool must outlive the renderer.
+  FleetRenderer(const Rocket &prototype, ThreadPool &pool);
+
+  void update(const SimState *states, std::size_t count, const sf::View &view,
+              const sf::Vector2u &target_size);
+
+  void setLodThresholds(float line_px, float point_px) {
+    lod_line_px = line_px;
+    lod_point_px = point_px;
+  }
+
+  Lod getLod() const { return lod; }
+  std::size_t getVisibleCount() const { return visible; }
+
+private:
+  // Design-space triangle list of one rocket and the color of each vertex.
+  std::vector<sf::Vector2f> local;
+  std::vector<sf::Color> colors;
+  sf::Vector2f nose_tip, bottom_center;
+  sf::Color nose_color, body_color; // Of the Line LOD ends.
+  float radius; // Bounding radius around any CM, for culling.
+  float height;
+
+  float lod_line_px = 12.f;
+  float lod_point_px = 3.f;
+  Lod lod = Lod::Full;
+
+  ThreadPool &pool;
+  std::vector<std::size_t> chunk_counts;  // Visible rockets per chunk.
+  std::vector<std::size_t> chunk_offsets; // Where each chunk starts writing.
+  std::vector<std::uint32_t> visible_index;
+  std::size_t visible = 0;
+
+  sf::VertexArray vertices;
+
+  void addRect(sf::Vector2f pos, sf::Vector2f size, const sf::Color &color);
+  void addTriangle(sf::Vector2f a, sf::Vector2f b, sf::Vector2f c,
+                   const sf::Color &color);
+
+  void draw(sf::RenderTarget &target, sf::RenderStates states) const override {
+    target.draw(vertices, states);
+  }
+};
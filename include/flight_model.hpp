@@ -0,0 +1,53 @@
+#pragma once
+
+#include <type_traits>
+#include <variant>
+
+#include "contact.hpp"
+#include "rocket_model.hpp"
+#include "simulation.hpp"
+
+/*
+        The flight of one vehicle in a chosen Precision.
+
+        In float the Rocket flies itself. In double or fixed point a
+  RocketModel of that scalar holds the vehicle and steps it; the Rocket
+  mirrors its state after every tick, in float, for what only knows Rocket:
+  the contact solver, vehicle pairs, drawing, telemetry and logs. So a
+  flight through free space is double (reference runs) or bit exact on
+  every machine and build (lockstep, replays) for as long as it lasts.
+
+        Touching or about to touch something, the tick goes through the
+  contact solver in float as before, and the model restarts from the
+  outcome; so does it after anything else moves the Rocket from outside
+  (vehicle pairs, staging, a restored snapshot): call sync().
+*/
+class FlightModel {
+public:
+  // Float: the Rocket flies itself.
+  FlightModel() = default;
+  FlightModel(Precision precision, const Rocket &rocket);
+
+  Precision getPrecision() const;
+
+  // The Rocket changed from outside: continue from its state.
+  void sync(const Rocket &rocket);
+  // The Rocket moved by shift (World::rebase); exact for whole multiples
+  // of World::REBASE_GRID.
+  void shift(sf::Vector2f shift);
+
+  // ContactSolver::step() for the tick, the flight in the model's scalar.
+  SweptStep step(ContactSolver &contacts, Rocket &rocket,
+                 const ControlInput &input, float dt);
+
+private:
+  std::variant<std::monostate, RocketModel<double>, RocketModel<Fixed>>
+      model;
+
+  template <typename S>
+  SweptStep fly(RocketModel<S> &model, ContactSolver &contacts,
+                Rocket &rocket, const ControlInput &input, float dt);
+};
+
+// Flight logs store it raw in their keyframes.
+static_assert(std::is_trivially_copyable_v<FlightModel>);
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/Text.hpp>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "profiler.hpp"
+#include "rocket.hpp"
+
+/*
+        Fixed-size text builder for HUD values.
+
+        Numbers go through std::to_chars into an inline buffer, so building a
+  value never allocates. Floats use 2 decimals.
+*/
+class HudWriter {
+public:
+  static constexpr std::size_t CAPACITY = 64;
+
+  HudWriter &operator<<(const char *text) {
+    while (*text && len < CAPACITY - 1)
+      buf[len++] = *text++;
+    buf[len] = '\0';
+    return *this;
+  }
+
+  HudWriter &operator<<(double value) {
+    const auto [end, ec] = std::to_chars(buf + len, buf + CAPACITY - 1, value,
+                                         std::chars_format::fixed, 2);
+    if (ec == std::errc())
+      len = end - buf;
+    else
+      *this << "###";
+    buf[len] = '\0';
+    return *this;
+  }
+
+  HudWriter &operator<<(float value) {
+    return *this << static_cast<double>(value);
+  }
+
+  template <typename I>
+    requires std::is_integral_v<I>
+  HudWriter &operator<<(I value) {
+    const auto [end, ec] = std::to_chars(buf + len, buf + CAPACITY - 1, value);
+    if (ec == std::errc())
+      len = end - buf;
+    buf[len] = '\0';
+    return *this;
+  }
+
+  const char *c_str() const { return buf; }
+  std::size_t size() const { return len; }
+
+  bool operator==(const HudWriter &o) const {
+    return len == o.len && std::memcmp(buf, o.buf, len) == 0;
+  }
+
+private:
+  char buf[CAPACITY] = {};
+  std::size_t len = 0;
+};
+
+/*
+        Heads-up display made of fixed lines.
+
+        Each line is a static label and a value with its own sf::Text, so a
+  frame only re-lays out the values whose text actually changed; SFML keeps
+  the glyph geometry of the others. Labels are set once.
+*/
+class Hud : public sf::Drawable {
+public:
+  Hud(const sf::Font &font, unsigned int character_size, sf::Vector2f origin,
+      float value_column = 150.f);
+
+  // Lines are laid out top to bottom in the order they are added.
+  void addHeader(const char *text);
+  int addField(const char *label);
+
+  void set(int field, const HudWriter &value);
+
+  std::size_t getUpdatesLastFrame() const { return updates_last_frame; }
+  void endFrame() {
+    updates_last_frame = updates;
+    updates = 0;
+  }
+
+private:
+  struct Line {
+    sf::Text label;
+    sf::Text value;
+    HudWriter shown;
+    bool has_value;
+  };
+
+  const sf::Font &font;
+  unsigned int character_size;
+  sf::Vector2f origin;
+  float value_column;
+  float line_height;
+
+  std::vector<Line> lines;
+  std::size_t updates = 0;
+  std::size_t updates_last_frame = 0;
+
+  sf::Text makeText(const char *text, float x) const;
+
+  void draw(sf::RenderTarget &target, sf::RenderStates states) const override;
+};
+
+// Rocket telemetry (state, mass and balance, engines) as HUD fields.
+class RocketHud {
+public:
+  explicit RocketHud(Hud &hud);
+
+  // origin is World::getOrigin(): the position is shown in the terrain
+  // frame.
+  void update(const SimState &state, const sf::Vector2<double> &origin = {});
+
+private:
+  Hud &hud;
+  int position, velocity, angle, force;
+  int total_mass, fuel_mass, cm;
+  int main_output, left_output, right_output;
+};
+
+// Profiler metrics as HUD fields: p50 / p99 / max over the last window.
+class ProfileHud {
+public:
+  explicit ProfileHud(Hud &hud);
+
+  // Shows what was recorded since the previous call.
+  void update();
+
+private:
+  Hud &hud;
+  int fields[PROFILE_METRIC_COUNT];
+  ProfileSnapshot last;
+};
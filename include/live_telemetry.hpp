@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#include "contact.hpp"
+#include "rocket.hpp"
+#include "world.hpp"
+
+// What RocketHud shows, for one vehicle after one step.
+struct LiveSample {
+  std::uint64_t tick;
+  std::uint32_t vehicle;
+  std::uint32_t flags; // LIVE_CONTACT | LIVE_SLEEPING
+  float pos[2];
+  float vel[2];
+  float angle; // Radians.
+  float ang_vel;
+  float force[2];
+  float mass;
+  float fuel_mass;
+  float cm[2];     // Local.
+  float output[3]; // Current booster outputs: bottom, left, right (kg / s).
+  float target[3]; // Commanded outputs, same order.
+  float impact_len_vel;
+  std::uint32_t substeps;
+};
+
+constexpr std::uint32_t LIVE_CONTACT = 1u << 0;
+constexpr std::uint32_t LIVE_SLEEPING = 1u << 1;
+
+static_assert(std::is_trivially_copyable_v<LiveSample>);
+static_assert(sizeof(LiveSample) == 96, "LiveSample is part of the layout");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "the ring needs address-free 64 bit atomics");
+
+constexpr const char *LIVE_TELEMETRY_NAME = "/rocket-telemetry";
+
+/*
+        Live telemetry ring in POSIX shared memory: one producer (the
+  simulator), any number of readers in other processes.
+
+        Layout of the shared object (native endianness, offsets in bytes):
+          0    char[8]  magic "RKTRING", written last when the ring is ready
+          8    u32      version (2)
+          12   u32      sample size (96)
+          16   u32      capacity, slots, a power of two
+          20   u32      slot size (128)
+          24   u64      producer pid
+          64   u64      head: samples published so far (atomic)
+          128  capacity x slot:
+                 0   u64         seq (atomic)
+                 8   LiveSample  as declared above, 12 u64 words
+        Sample n lives in slot n % capacity. Its writer sets seq to 2n + 1,
+  stores the words, then sets seq to 2n + 2 and head to n + 1 (release).
+
+        The producer never waits and never looks at the readers. A reader
+  keeps its own cursor: it copies slot n, then checks seq is 2n + 2 both
+  before and after the copy (acquire); anything else means the producer
+  lapped it and the sample is dropped, as are samples more than capacity
+  behind head. So a slow reader only loses samples and a dead one costs
+  nothing.
+*/
+class LiveTelemetryWriter {
+public:
+  // Creates (or replaces) the shared object; throws when that fails.
+  explicit LiveTelemetryWriter(const std::string &name = LIVE_TELEMETRY_NAME,
+                               std::uint32_t capacity = 4096);
+  ~LiveTelemetryWriter();
+
+  LiveTelemetryWriter(const LiveTelemetryWriter &) = delete;
+  LiveTelemetryWriter &operator=(const LiveTelemetryWriter &) = delete;
+
+  void publish(const LiveSample &sample);
+  void publish(std::uint64_t tick, std::uint32_t vehicle, const Rocket &rocket,
+               const SweptStep &contact, bool sleeping = false);
+  // Every vehicle of the world.
+  void publish(std::uint64_t tick, const World &world);
+
+private:
+  std::string name;
+  void *memory = nullptr;
+  std::size_t size = 0;
+  std::uint32_t mask = 0;
+  std::uint64_t head = 0; // Producer copy of the shared head.
+};
+
+class LiveTelemetryReader {
+public:
+  // Attaches to a ring; throws when there is none.
+  explicit LiveTelemetryReader(const std::string &name = LIVE_TELEMETRY_NAME);
+  ~LiveTelemetryReader();
+
+  LiveTelemetryReader(const LiveTelemetryReader &) = delete;
+  LiveTelemetryReader &operator=(const LiveTelemetryReader &) = delete;
+
+  // Next sample after the last one read; false when caught up. Never
+  // waits on the producer.
+  bool next(LiveSample &sample);
+  // Skip everything published so far.
+  void skipToLatest();
+
+  std::uint64_t getDropped() const { return dropped; }
+  std::uint32_t getCapacity() const { return mask + 1; }
+
+private:
+  void *memory = nullptr;
+  std::size_t size = 0;
+  std::uint32_t mask = 0;
+  std::uint64_t cursor = 0;
+  std::uint64_t dropped = 0;
+};
@@ -0,0 +1,328 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocket.hpp"
+#include "simulation.hpp"
+#include "timer_wheel.hpp"
+#include "world.hpp"
+
+class MissionControl;
+class MissionSequencer;
+
+/*
+        A mission script: a C++20 coroutine over one vehicle.
+
+          Mission hop(MissionControl &mc) {
+            mc.fire(Engine::MAIN, true);
+            mc.throttle(Engine::MAIN, 9.f);
+            co_await mc.wait(1.f);
+            mc.throttle(Engine::MAIN, 0.f);
+            co_await mc.until([](const MissionControl &mc) {
+              return mc.verticalSpeed() < 0.f;
+            });
+            ...
+          }
+
+        It runs inside MissionSequencer::tick() until its next co_await and
+  never blocks; commands take effect on the next physics step. The
+  sequencer owns the coroutine frame.
+
+        A mission can co_await another one taking the same MissionControl
+  first (co_await land(mc, ground)): it runs to its end in place, and
+  rethrows what escaped it.
+*/
+class Mission {
+public:
+  struct promise_type;
+
+  // Hands control back to the awaiting mission, if any.
+  struct FinalAwaiter {
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<>
+    await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+    void await_resume() const noexcept {}
+  };
+
+  struct promise_type {
+    template <typename... Args>
+    explicit promise_type(MissionControl &control, Args &&...)
+        : control(control) {}
+
+    Mission get_return_object() {
+      return Mission(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+    // Started by the sequencer or the awaiting mission, kept after the end
+    // until it is destroyed.
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    FinalAwaiter final_suspend() noexcept { return {}; }
+    void return_void() {}
+    // Kept for the awaiting mission; the sequencer rethrows it from tick()
+    // for a top level one.
+    void unhandled_exception();
+
+    MissionControl &control;
+    std::coroutine_handle<> continuation; // The awaiting mission.
+    std::exception_ptr error;
+  };
+
+  Mission() = default;
+  Mission(Mission &&other) noexcept : handle(other.handle) {
+    other.handle = {};
+  }
+  Mission &operator=(Mission &&other) noexcept {
+    std::swap(handle, other.handle);
+    return *this;
+  }
+  ~Mission() {
+    if (handle)
+      handle.destroy();
+  }
+
+  bool done() const { return !handle || handle.done(); }
+
+  auto operator co_await() && noexcept {
+    struct Awaiter {
+      std::coroutine_handle<promise_type> handle;
+
+      bool await_ready() const noexcept { return !handle || handle.done(); }
+      std::coroutine_handle<>
+      await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      void await_resume() const {
+        if (handle && handle.promise().error)
+          std::rethrow_exception(handle.promise().error);
+      }
+    };
+    return Awaiter{handle};
+  }
+
+private:
+  friend class MissionSequencer;
+  explicit Mission(std::coroutine_handle<promise_type> handle)
+      : handle(handle) {}
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+using MissionScript = Mission (*)(MissionControl &);
+
+enum class Engine { MAIN, LEFT, RIGHT };
+
+// co_await mc.wait(seconds): resumes that many ticks later (rounded up).
+struct MissionWait : TimerNode {
+  MissionWait(MissionControl &control, std::uint64_t ticks)
+      : control(control), ticks(ticks) {}
+
+  bool await_ready() const noexcept { return ticks == 0; }
+  void await_suspend(std::coroutine_handle<> handle);
+  void await_resume() const noexcept {}
+
+private:
+  MissionControl &control;
+  std::uint64_t ticks;
+  std::coroutine_handle<> handle;
+
+  static void resume(TimerNode &node) {
+    static_cast<MissionWait &>(node).handle.resume();
+  }
+};
+
+// co_await mc.until(condition): resumes on the first poll where
+// condition(mc) holds; polled every poll_ticks through the timer wheel.
+template <typename Condition> struct MissionUntil : TimerNode {
+  MissionUntil(MissionControl &control, Condition condition,
+               std::uint64_t poll_ticks)
+      : control(control), condition(std::move(condition)),
+        poll_ticks(poll_ticks) {}
+
+  bool await_ready() { return condition(control); }
+  void await_suspend(std::coroutine_handle<> handle);
+  void await_resume() const noexcept {}
+
+private:
+  MissionControl &control;
+  Condition condition;
+  std::uint64_t poll_ticks;
+  std::coroutine_handle<> handle;
+
+  static void poll(TimerNode &node);
+};
+
+/*
+        What a script sees of its vehicle and the commands it can give.
+
+        Engine flags and throttle / nozzle targets persist until changed
+  (a fired engine keeps firing every step, like a held key); targets are
+  turned into the ControlInput deltas of the next step. Engines are cut
+  when the script ends.
+*/
+class MissionControl {
+public:
+  const Rocket &rocket() const { return world.getVehicle(vehicle); }
+  std::size_t getVehicle() const { return vehicle; }
+  double time() const; // Seconds since the mission started.
+
+  // Height of the CM above the surface under it, m.
+  float altitude() const;
+  // Up positive, m / s.
+  float verticalSpeed() const { return -rocket().getVel().y; }
+  float speed() const { return std::sqrt(rocket().getLenVel()); }
+  float fuel() const { return rocket().getFuelMass(); }
+  // Touched the terrain or another vehicle in the last step.
+  bool touching() const { return world.getContact(vehicle).touched; }
+
+  void fire(Engine engine, bool on);
+  void throttle(Engine engine, float output);  // Target, kg / s.
+  void nozzleArea(Engine engine, float area); // Exit area, m^2.
+
+  MissionWait wait(float seconds);
+  template <typename Condition>
+  MissionUntil<Condition> until(Condition condition, float poll = 1.f / 30.f) {
+    const auto poll_ticks = std::max<std::uint64_t>(ticksFor(poll), 1);
+    return {*this, std::move(condition), poll_ticks};
+  }
+
+private:
+  friend class MissionSequencer;
+  friend struct Mission::promise_type;
+  friend struct Mission::FinalAwaiter;
+  friend struct MissionWait;
+  template <typename> friend struct MissionUntil;
+
+  MissionControl(MissionSequencer &sequencer, const World &world,
+                 std::size_t vehicle);
+
+  MissionSequencer &sequencer;
+  const World &world;
+  std::size_t vehicle;
+  std::uint64_t start_tick;
+
+  bool firing[3] = {};
+  float output[3];      // NaN: no pending target.
+  float nozzle_area[3]; // NaN: no pending target.
+  bool listed = false;  // In the sequencer's commanding list.
+  bool finished = false;
+  ControlInput input;   // Of the next step.
+
+  std::uint64_t ticksFor(float seconds) const;
+  void schedule(TimerNode &node, std::uint64_t ticks);
+  void commanded();
+  // Builds input from the flags and pending targets; false when empty.
+  bool gather();
+};
+
+/*
+        Runs mission scripts for the vehicles of a World.
+
+        Waits, condition polls and their wake ups all go through one
+  TimerWheel, so a tick costs O(1) per mission that resumes plus the
+  missions that hold an engine on or changed a target; waiting missions
+  cost nothing. Frames are allocated when a mission or sub-mission
+  starts; waits and polls allocate nothing. Per step:
+
+          sequencer.tick();
+          sequencer.apply(world);
+          world.step(dt);
+
+        The world must outlive the sequencer (missions read their vehicles
+  through it).
+*/
+class MissionSequencer {
+public:
+  MissionSequencer(const World &world, float dt);
+
+  // Starts script on a vehicle; it runs to its first co_await at once.
+  // Returns the mission index.
+  std::size_t start(std::size_t vehicle, MissionScript script);
+
+  // One tick: resumes the missions due now and gathers the commands of
+  // the next step. Rethrows the first exception a script let escape.
+  void tick();
+
+  // Command of mission m for the next step, empty when it gives none.
+  const ControlInput &getInput(std::size_t m) const {
+    return missions[m]->control.input;
+  }
+  // setInput of every mission with a command.
+  void apply(World &world) const;
+
+  std::size_t size() const { return missions.size(); }
+  bool isDone(std::size_t m) const { return missions[m]->control.finished; }
+  std::size_t getVehicle(std::size_t m) const {
+    return missions[m]->control.vehicle;
+  }
+
+  float getDt() const { return dt; }
+  std::uint64_t getTick() const { return wheel.now(); }
+
+private:
+  friend class MissionControl;
+  friend struct Mission::promise_type;
+
+  // The frame of script refers to control, so it goes first.
+  struct Entry {
+    Entry(MissionSequencer &sequencer, const World &world,
+          std::size_t vehicle)
+        : control(sequencer, world, vehicle) {}
+
+    MissionControl control;
+    Mission script;
+  };
+
+  const World &world;
+  float dt;
+  TimerWheel wheel; // Before the missions: their frames hold its nodes.
+  std::vector<std::unique_ptr<Entry>> missions;
+  // Missions with a command for the next step (or that just stopped).
+  std::vector<MissionControl *> commanding;
+  std::vector<MissionControl *> gathered;
+  std::exception_ptr error;
+
+  void gather();
+  void rethrow();
+};
+
+inline void MissionWait::await_suspend(std::coroutine_handle<> handle) {
+  this->handle = handle;
+  fire = &MissionWait::resume;
+  control.schedule(*this, ticks);
+}
+
+template <typename Condition>
+void MissionUntil<Condition>::await_suspend(std::coroutine_handle<> handle) {
+  this->handle = handle;
+  fire = &MissionUntil::poll;
+  control.schedule(*this, poll_ticks);
+}
+
+template <typename Condition>
+void MissionUntil<Condition>::poll(TimerNode &node) {
+  auto &self = static_cast<MissionUntil &>(node);
+  if (self.condition(self.control))
+    self.handle.resume();
+  else
+    self.control.schedule(self, self.poll_ticks);
+}
+
+// Built-in scripts, for main --mission NAME.
+struct NamedMission {
+  const char *name;
+  MissionScript script;
+};
+
+extern const NamedMission MISSIONS[];
+extern const std::size_t MISSION_COUNT;
+
+// Throws for an unknown name.
+MissionScript findMission(const std::string &name);
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "scenario.hpp"
+#include "terrain.hpp"
+#include "thread_pool.hpp"
+
+// Welford running mean / variance, mergeable (Chan et al.).
+struct RunningStats {
+  std::uint64_t count = 0;
+  double mean = 0.;
+  double m2 = 0.;
+  double min = 0.;
+  double max = 0.;
+
+  void add(double x);
+  void merge(const RunningStats &other);
+
+  double variance() const { return count > 1 ? m2 / (count - 1) : 0.; }
+  double stddev() const;
+};
+
+/*
+        Quantiles of a stream in fixed memory, within 1% of the value.
+
+        Log buckets of ratio GAMMA for each sign, from MIN_VALUE to
+  MIN_VALUE * GAMMA^BUCKETS (about 1e8); smaller magnitudes count as 0 and
+  larger ones land in the last bucket. Counts only, so merging sketches is
+  exact and order does not matter.
+*/
+class QuantileSketch {
+public:
+  static constexpr double GAMMA = 1.02;
+  static constexpr double MIN_VALUE = 1e-4;
+  static constexpr int BUCKETS = 1400;
+
+  void add(double x);
+  void merge(const QuantileSketch &other);
+  double quantile(double q) const;
+  std::uint64_t getCount() const { return count; }
+
+private:
+  std::array<std::uint64_t, BUCKETS> negative{};
+  std::array<std::uint64_t, BUCKETS> positive{};
+  std::uint64_t zero = 0;
+  std::uint64_t count = 0;
+
+  static int bucketOf(double magnitude);
+  static double bucketValue(int bucket);
+};
+
+// Fixed grid counts over [x_min, x_max] x [y_min, y_max]; points outside
+// go to outside.
+class Histogram2D {
+public:
+  Histogram2D(double x_min, double x_max, std::size_t nx, double y_min,
+              double y_max, std::size_t ny);
+
+  void add(double x, double y);
+  void merge(const Histogram2D &other);
+
+  std::uint64_t at(std::size_t ix, std::size_t iy) const {
+    return counts[iy * nx + ix];
+  }
+  std::size_t getNx() const { return nx; }
+  std::size_t getNy() const { return ny; }
+  double cellX(std::size_t ix) const { return x_min + (ix + 0.5) * dx; }
+  double cellY(std::size_t iy) const { return y_min + (iy + 0.5) * dy; }
+  std::uint64_t getOutside() const { return outside; }
+
+private:
+  double x_min, y_min, dx, dy;
+  std::size_t nx, ny;
+  std::vector<std::uint64_t> counts;
+  std::uint64_t outside = 0;
+};
+
+enum MonteCarloMetric : int {
+  MC_X_ERROR,      // final x - target x, m.
+  MC_IMPACT_SPEED, // Fastest touchdown, m / s.
+  MC_FINAL_ANGLE,  // Radians.
+  MC_FUEL_USED,    // kg.
+  MC_REST_TIME,    // Seconds, landed samples only.
+  MC_METRIC_COUNT
+};
+
+extern const char *const MONTE_CARLO_METRICS[MC_METRIC_COUNT];
+
+struct MonteCarloReport {
+  std::uint64_t samples = 0;
+  std::uint64_t successes = 0;
+  std::uint64_t failed = 0; // Runs that threw.
+  RunningStats moments[MC_METRIC_COUNT];
+  QuantileSketch sketches[MC_METRIC_COUNT];
+  Histogram2D touchdown; // x error against impact speed.
+
+  explicit MonteCarloReport(const MonteCarloConfig &config);
+
+  double successRate() const {
+    return samples ? double(successes) / samples : 0.;
+  }
+  // 95% Wilson score interval of the success rate.
+  void successInterval(double &low, double &high) const;
+};
+
+/*
+        Landing dispersion of a scenario file.
+
+        Sample i perturbs the base scenario with a generator seeded from
+  (seed, i) alone, so any sample can be flown again on its own and the
+  result does not depend on the thread count. Samples are flown in chunks
+  across the pool and folded into per-worker statistics; nothing per
+  sample is kept, so memory stays flat however many samples run. Moments
+  are merged chunk by chunk in sample order, sketches and histograms are
+  counts: the report is the same bit for bit for any thread count.
+*/
+class MonteCarlo {
+public:
+  // wind (ScenarioFile::windField()) may be null.
+  MonteCarlo(const ScenarioFile &file, const Terrain &terrain,
+             const WindField *wind = nullptr);
+
+  // The scenario of sample i.
+  Scenario sample(std::uint64_t i) const;
+
+  // Flies samples [0, count); progress(done) is called between batches.
+  MonteCarloReport
+  run(std::uint64_t count, ThreadPool &pool,
+      const std::function<void(std::uint64_t)> &progress = {}) const;
+
+  float getTargetX() const { return target_x; }
+  bool isSuccess(const ScenarioResult &result) const;
+
+private:
+  const ScenarioFile &file;
+  const Terrain &terrain;
+  const WindField *wind;
+  float target_x;
+};
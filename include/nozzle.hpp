@@ -0,0 +1,136 @@
+#pragma once
+
+#include <cmath>
+
+#include "constants.hpp"
+#include "dual.hpp"
+#include "fixed.hpp"
+#include "numeric_solver.hpp"
+
+/*
+        Isentropic nozzle equations, templated on the scalar type.
+
+        BoosterModel evaluates them in the scalar of its RocketModel: float
+  for Rocket, double, Fixed, or Dual to get derivatives of the thrust with
+  respect to the nozzle and fuel parameters.
+*/
+namespace nozzle {
+
+// Area-Mach relation written as f(M) = 0 for a given Ae / At.
+template <typename S>
+S areaMachResidual(const S &M, const S &gamma, const S &epsilon) {
+  using std::abs;
+  using std::pow;
+
+  const S t1 = 2. / (gamma + 1.);
+  const S t2 = (gamma - 1.) / 2.;
+  const S expoent = (gamma + 1.) / (2. * (gamma - 1.));
+
+  const S m_abs = abs(M);
+  return t2 * pow(m_abs, expoent + 2.) + pow(m_abs, expoent) -
+         pow(epsilon, expoent) / t1;
+}
+
+// df / dM of areaMachResidual.
+template <typename S>
+S areaMachResidualDerivative(const S &M, const S &gamma) {
+  using std::abs;
+  using std::pow;
+
+  const S t2 = (gamma - 1.) / 2.;
+  const S expoent = (gamma + 1.) / (2. * (gamma - 1.));
+
+  const S m_abs = abs(M);
+  return t2 * (expoent + 2.) * pow(m_abs, expoent + 1.) +
+         expoent * pow(m_abs, expoent - 1.);
+}
+
+inline double solveExitMach(double gamma, double epsilon, double x0,
+                            Newton_Raphson &solver) {
+  const auto f = [=](double M) {
+    return areaMachResidual(M, gamma, epsilon);
+  };
+  const auto df = [=](double M) {
+    return areaMachResidualDerivative(M, gamma);
+  };
+
+  solver.setPrecision(0.001f);
+  solver.setFunc(f, df);
+
+  return solver.solve(x0);
+}
+
+// Newton only runs on the value. The tangents come from the implicit
+// function theorem: dM = -(df/dp dp) / (df/dM), evaluated at the root.
+template <int N>
+Dual<N> solveExitMach(const Dual<N> &gamma, const Dual<N> &epsilon, double x0,
+                      Newton_Raphson &solver) {
+  const double M = solveExitMach(gamma.v, epsilon.v, x0, solver);
+
+  const Dual<N> f = areaMachResidual(Dual<N>(M), gamma, epsilon);
+  const double dfdM = areaMachResidualDerivative(M, gamma.v);
+
+  Dual<N> Mach(M);
+  if (dfdM != 0.) {
+    for (int i = 0; i < N; i++)
+      Mach.d[i] = -f.d[i] / dfdM;
+  }
+
+  return Mach;
+}
+
+// Newton_Raphson's iteration carried out in fixed point, so the root does
+// not depend on libm either.
+inline Fixed solveExitMach(const Fixed &gamma, const Fixed &epsilon, double x0,
+                           Newton_Raphson &) {
+  const Fixed tolerance = 0.001;
+  Fixed M = std::abs(x0) < 1e-5 ? 2. : x0;
+
+  for (int i = 0; i < 100; i++) {
+    Fixed df = areaMachResidualDerivative(M, gamma);
+    if (abs(df) < Fixed(1e-9)) {
+      M += 0.1;
+      df = areaMachResidualDerivative(M, gamma);
+      if (df == Fixed())
+        break;
+    }
+
+    const Fixed h = areaMachResidual(M, gamma, epsilon) / df;
+    M -= h;
+    if (abs(h) < tolerance)
+      break;
+  }
+
+  return M;
+}
+
+template <typename S> S exitPressure(const S &gamma, const S &Mach) {
+  using std::pow;
+
+  const S t1 = (gamma - 1.) / 2.;
+  const S expoent = -gamma / (gamma - 1.);
+
+  // Approximate pc = p0 (atmosphere)
+  const double P_chamber = AIR_PRESSURE * 20.0;
+  return P_chamber * pow(1. + t1 * Mach * Mach, expoent);
+}
+
+template <typename S>
+S exitTemperature(const S &gamma, const S &T0, const S &Mach) {
+  const S t1 = (gamma - 1.) / 2.;
+  return T0 / (1. + t1 * Mach * Mach);
+}
+
+template <typename S>
+S exitVelocity(const S &gamma, const S &R, const S &Te, const S &Mach) {
+  using std::sqrt;
+  return Mach * sqrt(gamma * R * Te);
+}
+
+// Thrust, N.
+template <typename S>
+S thrust(const S &output, const S &Vexit, const S &Pe, const S &Ae) {
+  return output * Vexit + (Pe - AIR_PRESSURE) * Ae;
+}
+
+} // namespace nozzle
@@ -5,6 +5,8 @@
 #include <cmath>
 #include <functional>
 
+#include "profiler.hpp"
+
 using namespace std;
 
 struct Newton_Raphson {
@@ -24,8 +26,10 @@ struct Newton_Raphson {
       x = 2.0;
 
     double h = func(x) / derivFunc(x);
+    std::uint64_t iterations = 0;
 
     while (abs(h) >= EPSILON) {
+      iterations++;
       double df = derivFunc(x);
 
       if (std::abs(df) < 1e-9) {
@@ -36,6 +40,7 @@ struct Newton_Raphson {
       h = func(x) / df;
       x = x - h;
     }
+    PROFILE_VALUE(PROFILE_NEWTON_ITERATIONS, iterations);
 
     if (std::isnan(x) || std::isinf(x))
       return 1.0;
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+// Build with -DROCKET_PROFILE=0 to compile every scope out.
+#ifndef ROCKET_PROFILE
+#define ROCKET_PROFILE 1
+#endif
+
+enum ProfileMetric : int {
+  PROFILE_WORLD_STEP, // World::step, all vehicles.
+  PROFILE_BOOSTERS,   // Rocket::updateBoosters.
+  PROFILE_MACH,       // BoosterModel::solve.
+  PROFILE_FUEL,       // Rocket::consumeFuelMass.
+  PROFILE_INTEGRATE,  // Rocket::update.
+  PROFILE_SWEEP,      // ContactSolver::timeOfImpact.
+  PROFILE_CONTACTS,   // ContactSolver::solve.
+  PROFILE_PAIRS,      // World::step after the vehicles: pairs and sleep.
+  PROFILE_AUTOPILOT,  // Autopilot::tick.
+  PROFILE_HUD,        // HUD text updates.
+  PROFILE_DRAW,       // Drawing and display of a frame.
+  PROFILE_NEWTON_ITERATIONS, // Newton_Raphson::solve iterations (a count).
+  PROFILE_METRIC_COUNT
+};
+
+struct ProfileMetricInfo {
+  const char *name;
+  bool is_time; // Nanoseconds, else a plain count.
+};
+
+extern const ProfileMetricInfo PROFILE_METRICS[PROFILE_METRIC_COUNT];
+
+/*
+        Log-linear histogram: exact below 16, then 8 buckets per power of 2,
+  so any quantile is within 12.5% of the truth, from nanoseconds to days, in
+  a fixed array.
+*/
+struct ProfileHistogram {
+  static constexpr int BUCKETS = 16 + 44 * 8;
+
+  std::array<std::uint64_t, BUCKETS> buckets{};
+  std::uint64_t count = 0;
+  std::uint64_t total = 0;
+  std::uint64_t max = 0;
+
+  static int bucketOf(std::uint64_t value);
+  // Largest value falling in bucket.
+  static std::uint64_t bucketTop(int bucket);
+
+  // Value below which a fraction q of the samples fall (bucket top).
+  std::uint64_t quantile(double q) const;
+  double mean() const { return count ? double(total) / count : 0.; }
+
+  // Samples of this one that are not in earlier, for windows over a
+  // running histogram (max stays the running max).
+  ProfileHistogram since(const ProfileHistogram &earlier) const;
+};
+
+struct ProfileSnapshot {
+  ProfileHistogram metrics[PROFILE_METRIC_COUNT];
+};
+
+/*
+        Process-wide profiler behind the PROFILE_* macros.
+
+        Every thread records into its own block of histograms (no lock, no
+  shared cache line, single writer: plain relaxed loads and stores), made
+  on the first record of the thread and kept after it exits. snapshot()
+  merges the blocks of all threads and can run at any time from any thread;
+  a record racing with it lands in this snapshot or the next.
+*/
+class Profiler {
+public:
+  static void record(ProfileMetric metric, std::uint64_t value);
+  static ProfileSnapshot snapshot();
+
+  // {"metric": {"unit", "count", "mean", "p50", "p99", "max"}, ...}
+  static void writeJson(std::ostream &out, const ProfileSnapshot &snapshot);
+};
+
+class ProfileScope {
+public:
+  explicit ProfileScope(ProfileMetric metric, bool enabled = true)
+      : metric(enabled ? metric : PROFILE_METRIC_COUNT),
+        begin(enabled ? std::chrono::steady_clock::now()
+                      : std::chrono::steady_clock::time_point()) {}
+
+  ~ProfileScope() {
+    if (metric == PROFILE_METRIC_COUNT)
+      return;
+    const auto elapsed = std::chrono::steady_clock::now() - begin;
+    Profiler::record(
+        metric,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+  }
+
+  ProfileScope(const ProfileScope &) = delete;
+  ProfileScope &operator=(const ProfileScope &) = delete;
+
+private:
+  ProfileMetric metric;
+  std::chrono::steady_clock::time_point begin;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+
+#if ROCKET_PROFILE
+// Times the rest of the enclosing block.
+#define PROFILE_SCOPE(metric)                                                  \
+  ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(metric)
+// The same, when enabled holds.
+#define PROFILE_SCOPE_IF(enabled, metric)                                      \
+  ProfileScope PROFILE_CONCAT(profile_scope_, __LINE__)(metric, enabled)
+#define PROFILE_VALUE(metric, value) Profiler::record(metric, value)
+#else
+#define PROFILE_SCOPE(metric) ((void)0)
+#define PROFILE_SCOPE_IF(enabled, metric) ((void)0)
+#define PROFILE_VALUE(metric, value) ((void)0)
+#endif
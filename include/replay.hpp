@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "simulation.hpp"
+#include "world.hpp"
+
+/*
+        Flight log: the commands of every tick plus periodic world keyframes.
+
+        The physics is a pure function of the world state and the commands
+  (fixed dt, no clock, no randomness), so a flight replays exactly from its
+  first keyframe and its command stream. Keyframes only make seeking cheap:
+  restore the last one at or before the target and step forward, at most
+  one keyframe interval of ticks. A world flown with wind replays only
+  into a world given the same WindField and WindParams, and one with a
+  floating origin into one with the same rebase_distance and focus.
+
+        Binary file (little endian):
+          char[4]  "RKRP"
+          u32      version (7)
+          f32      dt
+          u32      keyframe interval, ticks
+          u32      vehicle count
+          u32      sizeof(VehicleState), sizeof(PairManifold)
+          u32      World::getPrecision() (0 float, 1 double, 2 fixed)
+          u32      sizeof(FlightModel)
+          records until end of file:
+            u8 0, tick: per vehicle a u8 mask (bit 0 bottom, 1 left,
+                  2 right, bits 3 .. 5 dBottomOut, dLeftOut, dRightOut
+                  present, bit 6 nozzle byte present, bit 7 stage byte
+                  present) followed by the present deltas as f32; then,
+                  with bit 6, a u8 (bits 0 .. 2 dBottomAe, dLeftAe,
+                  dRightAe present) and those deltas as f32; then, with
+                  bit 7, the u8 stage to separate
+            u8 1, keyframe: u64 tick, f64 world time, f64 x 2 origin,
+                  u32 pair count,
+                  vehicle count x u32 order,
+                  vehicle count x VehicleState, pair count x PairManifold,
+                  off float vehicle count x FlightModel
+        A keyframe holds the state after its tick; the first one is tick 0.
+  With the flight models a double or fixed point world seeks to a
+  keyframe bit for bit, as a float one does.
+  The state structs are stored raw, so a log only replays with the build
+  that wrote it (the sizes are checked). A log cut short by a crash replays
+  up to its last complete record.
+*/
+class FlightRecorder {
+public:
+  // Writes the header and the keyframe of the world as it is now. Throws
+  // when the file cannot be created.
+  FlightRecorder(const std::string &path, const World &world, float dt,
+                 std::uint32_t keyframe_interval = 120);
+
+  // Command of vehicle for the coming tick; vehicles without one idle.
+  void command(std::size_t vehicle, const ControlInput &input);
+  // After world.step(): writes the tick and, when due, a keyframe.
+  void endTick(const World &world);
+
+  std::uint64_t getTick() const { return tick; }
+
+private:
+  std::ofstream out;
+  std::uint32_t keyframe_interval;
+  std::uint64_t tick = 0;
+
+  std::vector<ControlInput> inputs;
+  WorldState state;
+
+  void writeKeyframe(const World &world);
+};
+
+class FlightReplay {
+public:
+  // Reads the whole log. Throws when it is not a flight log of this build.
+  explicit FlightReplay(const std::string &path);
+
+  float getDt() const { return dt; }
+  std::uint64_t getTicks() const { return ticks; } // Recorded ticks.
+  std::size_t getKeyframes() const { return keyframes.size(); }
+  std::uint64_t getTick() const { return tick; }   // Ticks applied.
+
+  // world must be built as the recorded one: same terrain, same vehicle
+  // designs in the same order, same parameters and Precision; and only
+  // advanced through this replay, which starts it from the first keyframe.
+  // seek() throws for a world of another Precision.
+  Precision getPrecision() const { return precision; }
+
+  // Puts world at the state after tick (clamped to the log).
+  void seek(World &world, std::uint64_t tick);
+  // Applies the next tick; false at the end of the log.
+  bool step(World &world);
+
+  // Command of vehicle in tick (1 .. getTicks()).
+  const ControlInput &getInput(std::uint64_t tick, std::size_t vehicle) const {
+    return inputs[(tick - 1) * vehicle_count + vehicle];
+  }
+
+private:
+  struct Keyframe {
+    std::uint64_t tick;
+    double time;
+    sf::Vector2<double> origin;
+    std::size_t offset; // Of the keyframe body in data.
+    std::uint32_t pair_count;
+  };
+
+  float dt = 0.f;
+  Precision precision = Precision::FLOAT;
+  std::uint32_t vehicle_count = 0;
+  std::uint64_t ticks = 0;
+  std::uint64_t tick = 0;
+  bool restored = false;
+
+  std::vector<char> data;
+  // Ticks 1 .. ticks; index (t - 1) * vehicle_count + vehicle.
+  std::vector<ControlInput> inputs;
+  std::vector<Keyframe> keyframes;
+  WorldState state;
+
+  void loadKeyframe(const Keyframe &keyframe);
+};
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+
+/*
+        Fixed-capacity FIFO stored inline.
+
+        push_back on a full buffer overwrites the oldest element, which is
+  what a trail wants. Index 0 is the oldest element.
+*/
+template <typename T, std::size_t N> class RingBuffer {
+public:
+  static constexpr std::size_t capacity() { return N; }
+
+  std::size_t size() const { return count; }
+  bool empty() const { return count == 0; }
+  bool full() const { return count == N; }
+
+  void clear() {
+    head = 0;
+    count = 0;
+  }
+
+  void push_back(const T &value) {
+    items[(head + count) % N] = value;
+    if (count < N)
+      count++;
+    else
+      head = (head + 1) % N;
+  }
+
+  void pop_front() {
+    head = (head + 1) % N;
+    count--;
+  }
+
+  T &operator[](std::size_t i) { return items[(head + i) % N]; }
+  const T &operator[](std::size_t i) const { return items[(head + i) % N]; }
+
+  T &front() { return (*this)[0]; }
+  const T &front() const { return (*this)[0]; }
+  T &back() { return (*this)[count - 1]; }
+  const T &back() const { return (*this)[count - 1]; }
+
+private:
+  std::array<T, N> items{};
+  std::size_t head = 0;
+  std::size_t count = 0;
+};
@@ -1,165 +1,121 @@
 #pragma once
 
 #include <SFML/Graphics/Color.hpp>
-#include <SFML/Graphics/ConvexShape.hpp>
 #include <SFML/Graphics/Drawable.hpp>
-#include <SFML/Graphics/RectangleShape.hpp>
+#include <SFML/Graphics/Rect.hpp>
 #include <SFML/Graphics/RenderTarget.hpp>
-#include <SFML/Graphics/Transformable.hpp>
+#include <SFML/Graphics/Transform.hpp>
 #include <SFML/System/Vector2.hpp>
-#include <cmath>
-#include <deque>
-#include <iostream>
-#include <vector>
+#include <cstdint>
 
 #include "constants.hpp"
-#include "numeric_solver.hpp"
-#include "rocket_booster.hpp"
+#include "rocket_model.hpp"
+#include "sim_state.hpp"
 
-#define PI 3.1415926535
-#define DEGREES_TO_RADIANS (PI / 180)
-#define RADIANS_TO_DEGREES (180 / PI)
-
-struct MassComponent {
-  float m;        // Component Mass
-  sf::Vector2f r; // Component Pos
-  float I_local;  // Component Inertia
-};
-
-struct MassProps {
-  float m;           // Total Mass
-  sf::Vector2f r_cm; // Center of Mass Position
-  float I_cm;        // Total inertia (rocket)
+struct RocketColors {
+  sf::Color body;
+  sf::Color nose;
+  sf::Color thrusters;
 };
 
-class Rocket : public sf::Transformable, public sf::Drawable {
+// Design space to world for a body at pos, its CM at cm in design space,
+// turned by the angle of cos_angle and sin_angle.
+sf::Transform designToWorld(sf::Vector2f pos, float cos_angle, float sin_angle,
+                            sf::Vector2f cm);
+
+// Built once in rocket.cpp; everything else only inlines it.
+extern template struct BoosterModel<float>;
+extern template class RocketModel<float>;
+
+/*
+        The vehicle: RocketModel<float>, which owns the physics, plus its
+  design (geometry and colors) and an sf::Vector2f interface. SFML shapes
+  only exist in draw().
+*/
+class Rocket : public RocketModel<float>, public sf::Drawable {
 public:
-  Rocket(int rocket_width, int body_height, int nose_height);
-
-  std::string getStatus() const;
-
-  void setInitialPosition(float x, float y);
-
-  inline void applyForce(sf::Vector2f force) { this->force += force; }
-  inline void resetForce() { force = {0.f, 0.f}; }
+  Rocket(float rocket_width, float body_height, float nose_height);
 
-  void applyTorque(sf::Vector2f force, sf::Vector2f global_dist);
-  inline void resetTorque() { torque = 0.f; }
+  void setInitialPosition(float x, float y) { pos = {x, y}; }
 
-  void applyPos(sf::Vector2f pos) { this->pos += pos; }
-  void applyVel(const sf::Vector2f &vel) { this->vel += vel; }
+  // Contact corrections.
+  void applyPos(sf::Vector2f pos) {
+    this->pos.x += pos.x;
+    this->pos.y += pos.y;
+  }
+  void applyVel(const sf::Vector2f &vel) {
+    this->vel.x += vel.x;
+    this->vel.y += vel.y;
+  }
   void applyAngVel(const float angVel) { this->angVel += angVel; }
+  void setAngVel(float angVel) { this->angVel = angVel; }
 
-  void update(float dt);
-  void updatePosition(float dt);
-  void updateRotation(float dt);
-
-  void applyDragForce();
-
-  void activeLeftBooster();
-  void activeRightBooster();
-  void activeBottomBooster();
-
-  void addComponent(struct MassComponent comp);
-  void updateCmAndInertia();
-  void calculateCm();
-  void calculateInertia();
+  // Air velocity at the vehicle, held until set again (World samples it
+  // every step).
+  void setWind(sf::Vector2f wind) { this->wind = {wind.x, wind.y}; }
+  sf::Vector2f getWind() const { return toVector2f(wind); }
 
-  void consumeFuelMass(float dt);
+  // See RocketModel::separate().
+  void separate(std::uint8_t stage, Rocket &jettisoned, sf::Vector2f offset) {
+    RocketModel::separate(stage, jettisoned, {offset.x, offset.y});
+  }
 
   void configureSideBooster(const float gamma, const float minSideAe,
                             const float minSideAt, const float maxSideAe,
                             const float maxSideAt, const float minBottomAe,
                             const float minBottomAt, const float maxBottomAe,
-
                             const float maxBottomAt);
 
-  void setAngVel(float angVel) { this->angVel = angVel; }
-
-  void setNose(const sf::Color &color);
-  void setBody(const sf::Color &color);
-  void setSideThrusters(const int &y, const int &width, const int &height,
+  void setNose(const sf::Color &color) { colors.nose = color; }
+  void setBody(const sf::Color &color) { colors.body = color; }
+  void setSideThrusters(float y, float width, float height,
                         const sf::Color &color);
-  void setBottomThrusters(const int &x, const int &width, const int &height,
+  void setBottomThrusters(float x, float width, float height,
                           const sf::Color &color);
 
-  void updateBoosters(float dt);
+  void controlLeftOutput(float dOut) { left.controlOutput(dOut); }
+  void controlRightOutput(float dOut) { right.controlOutput(dOut); }
+  void controlBottomOutput(float dOut) { bottom.controlOutput(dOut); }
 
-  void controlLeftOutput(float dOut);
-  void controlRightOutput(float dOut);
-  void controlBottomOutput(float dOut);
+  void controlLeftNozzleArea(float dA) { left.controlNozzleArea(dA); }
+  void controlRightNozzleArea(float dA) { right.controlNozzleArea(dA); }
+  void controlBottomNozzleArea(float dA) { bottom.controlNozzleArea(dA); }
 
-  void controlLeftNozzleArea(float dA);
-  void controlRightNozzleArea(float dA);
-  void controlBottomNozzleArea(float dA);
+  void controlLeftThroatArea(float dA) { left.controlThroatArea(dA); }
+  void controlRightThroatArea(float dA) { right.controlThroatArea(dA); }
+  void controlBottomThroatArea(float dA) { bottom.controlThroatArea(dA); }
 
-  void controlLeftThroatArea(float dA);
-  void controlRightThroatArea(float dA);
-  void controlBottomThroatArea(float dA);
   void setBoosterFuel(double T0, double M);
   void setBoosterOutputs(float leftOut, float rightOut, float bottomOut);
+  // Throttle lag of every booster (BoosterModel::delay, 1 / s).
+  void setBoosterDelay(float delay);
 
-  sf::FloatRect getBounds();
-  const auto getCmWorld() {
-    return getTransform().transformPoint(rocket_prop.r_cm);
-  }
+  const RocketGeometry &getGeometry() const { return geometry; }
+  const RocketColors &getColors() const { return colors; }
 
-  const auto &getVel() { return vel; }
-  const auto &getAngularVel() { return angVel; }
-  const auto &getMass() { return rocket_prop.m; }
-  const auto &getInertia() { return rocket_prop.I_cm; }
-
-  const auto getLenVel() {
-    const auto len = vector_len_sqr(vel);
-    return len;
+  // Design space to world: the pose the physics uses.
+  sf::Transform getTransform() const {
+    return designToWorld(getPos(), cos_angle, sin_angle, getCm());
   }
+  // Of the body, without nose and thrusters.
+  sf::FloatRect getBounds() const;
+
+  const RocketBooster &getLeftBooster() const { return left; }
+  const RocketBooster &getRightBooster() const { return right; }
+  const RocketBooster &getBottomBooster() const { return bottom; }
+
+  sf::Vector2f getPos() const { return toVector2f(pos); }
+  float getAngle() const { return angle; }
+  sf::Vector2f getVel() const { return toVector2f(vel); }
+  float getAngularVel() const { return angVel; }
+  float getMass() const { return mass; }
+  float getInertia() const { return I_cm; }
+  sf::Vector2f getForce() const { return toVector2f(force); }
+  sf::Vector2f getCm() const { return toVector2f(r_cm); }
 
 private:
-  struct Newton_Raphson solver;
-  struct RocketBooster left;
-  struct RocketBooster right;
-  struct RocketBooster bottom;
-
-  float area; // The bigger area at rocket
-
-  sf::Vector2f vel;
-  sf::Vector2f pos;
-  sf::Vector2f acc;
-  sf::Vector2f pos_prev;
-  sf::Vector2f force;
-  // TODO: All functions that use the angle need be fixed. Because the angle =
-  // 0 make the rocket point to up.
-  float angle; // angle = 0 radians (x direction, to right)
-  float torque;
-  float angVel;
-
-  std::vector<struct MassComponent>
-      components; // The tank need be the last component.
-  struct MassProps rocket_prop;
-
-  // Rocket Design
-  const int rocket_width, body_height, nose_height;
-  sf::RectangleShape body;
-  sf::ConvexShape nose;
-  sf::RectangleShape left_thruster;
-  sf::RectangleShape right_thruster;
-  sf::RectangleShape bottom_thruster;
-
-  void draw(sf::RenderTarget &target, sf::RenderStates states) const override {
-    states.transform *= getTransform();
-
-    target.draw(body, states);
-    target.draw(nose, states);
-    target.draw(left_thruster, states);
-    target.draw(right_thruster, states);
-    target.draw(bottom_thruster, states);
-  }
+  RocketGeometry geometry;
+  RocketColors colors;
 
-  inline float vector_mod(const sf::Vector2f vec) {
-    return std::sqrt(vec.x * vec.x + vec.y * vec.y);
-  }
-
-  inline float vector_len_sqr(const sf::Vector2f vec) {
-    return vec.x * vec.x + vec.y * vec.y;
-  }
+  void draw(sf::RenderTarget &target, sf::RenderStates states) const override;
 };
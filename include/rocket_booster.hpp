@@ -1,165 +1,219 @@
 #pragma once
 
-#include "FuelProperties.hpp"
 #include "constants.hpp"
+#include "dual.hpp"
+#include "fixed.hpp"
+#include "nozzle.hpp"
 #include "numeric_solver.hpp"
+#include "profiler.hpp"
 
+#include <algorithm>
 #include <cmath>
-#include <iostream>
+#include <stdexcept>
+#include <type_traits>
 
-/*
-        This struct control the Rocket Booster.
-
-        Define:
-                Rocket Fuel Flow Rate (float output kg / s).
-                                Nozzle Area. This is controllable. (float minAe,
-  maxAe meter^2) Throat area. Inside the tank. (float minAt, maxAt meter^2)
-  specific heat ratio in the tank (float gamma)
-                                   // Fuel temperature (Like 300K - kelvin).
-  (double fuelProperties.T0 = 0)
-  Molar mass of fuel (double fuelProperties.M = 0
-  kg/kmol);
-*/
-struct RocketBooster {
-  // TODO: Ae and At can be modified by the player.
-
-  // Constants.
-  float delay = 0.6;
-
-  // Defined By Player.
+// Plain float copy of the state of a BoosterModel, used by SimState.
+// last_know_Mach and effecVel are only kept for the layout of saved states.
+struct BoosterState {
+  float delay;
   float target_output;
   float curr_output;
   float gamma;
-
   float minAe, minAt;
   float maxAe, maxAt;
-
   float curr_Ae;
   float curr_At;
   float prev_Ae;
-
-  // Defined By Equations
   float Mach;
   float last_know_Mach;
-  float Pe;       // Exit Pressure
-  float effecVel; // Effective Velocity
-  float Vexit;    // Exit Velocity
-  float Te;       // nozzle static temperature
-
-  struct Newton_Raphson solver;
-  struct FuelProperties fuelProperties;
-
-  void initBooster() {
-    fuelProperties.calculateR();
-    target_output = curr_output;
-
-    last_know_Mach = 0.;
-    last_know_Mach = 0.;
-    Mach = 0.;
-    Vexit = 0.;
-    Pe = AIR_PRESSURE;
-  }
+  float Pe;
+  float effecVel;
+  float Vexit;
+  float Te;
+  double T0;
+  double M;
+  double R;
+};
 
-  float getForce() {
-    updateVariables();
+static_assert(std::is_trivially_copyable_v<BoosterState>);
 
-    const auto f = curr_output * Vexit + (Pe - AIR_PRESSURE) * curr_Ae;
-
-    return f * PPM;
+/*
+        One engine of RocketModel, templated on the scalar type like it.
+
+        Fuel flow (output, kg / s) lags toward target_output at delay per
+  second. The nozzle (exit area curr_Ae and throat area curr_At, m^2,
+  within their design ranges) is solved for its exit Mach, pressure,
+  temperature and velocity only when its areas change, so the thrust of a
+  step is nozzle::thrust() of the current output and that solution. T0 is
+  the fuel temperature (K), M its molar mass (kg / kmol) and R = Ru / M.
+  Values with no derivative (area ranges, the settle band) are Constant<S>.
+*/
+template <typename S> struct BoosterModel {
+  S delay = 0.6; // 1 / s.
+
+  S target_output = S();
+  S curr_output = S();
+  S gamma = S();
+
+  Constant<S> minAe = 0., minAt = 0.;
+  Constant<S> maxAe = 0., maxAt = 0.;
+  S curr_Ae = S();
+  S curr_At = S();
+
+  S T0 = S(), R = S();
+  double M = 0.;
+
+  // The nozzle solution for curr_Ae and curr_At, once solved.
+  S Mach = S();
+  S Pe = AIR_PRESSURE; // Exit pressure, Pa.
+  S Te = S();          // Exit static temperature, K.
+  S Vexit = S();       // m / s.
+  bool solved = false;
+
+  // Areas at the middle of their ranges, no flow.
+  void configure(double gamma, double minAe, double minAt, double maxAe,
+                 double maxAt) {
+    this->gamma = gamma;
+    this->minAe = minAe;
+    this->minAt = minAt;
+    this->maxAe = maxAe;
+    this->maxAt = maxAt;
+    curr_Ae = (minAe + maxAe) / 2.;
+    curr_At = (minAt + maxAt) / 2.;
+    curr_output = target_output = S();
+    solved = false;
   }
 
-  void update(float dt) { updateOutput(dt); }
+  void setFuel(double T0, double M) {
+    this->T0 = T0;
+    this->M = M;
+    R = GAS_CONSTANT / M;
+    solved = false;
+  }
 
-  void updateOutput(float dt) {
-    if (std::abs(curr_output - target_output) < 0.0001f) {
-      curr_output = target_output;
-      return;
-    }
+  // BoosterState keeps the nozzle solution of a float booster; any other
+  // scalar solves again in its own precision.
+  void saveState(BoosterState &s) const {
+    s.delay = float(value(delay));
+    s.target_output = float(value(target_output));
+    s.curr_output = float(value(curr_output));
+    s.gamma = float(value(gamma));
+    s.minAe = float(value(minAe));
+    s.minAt = float(value(minAt));
+    s.maxAe = float(value(maxAe));
+    s.maxAt = float(value(maxAt));
+    s.curr_Ae = float(value(curr_Ae));
+    s.curr_At = float(value(curr_At));
+    s.prev_Ae = solved ? s.curr_Ae : -1.f;
+    s.Mach = float(value(Mach));
+    s.last_know_Mach = 0.f;
+    s.Pe = float(value(Pe));
+    s.effecVel = 0.f;
+    s.Vexit = float(value(Vexit));
+    s.Te = float(value(Te));
+    s.T0 = value(T0);
+    s.M = M;
+    s.R = value(R);
+  }
 
-    curr_output += (target_output - curr_output) * delay * dt;
+  void restoreState(const BoosterState &s) {
+    delay = s.delay;
+    target_output = s.target_output;
+    curr_output = s.curr_output;
+    gamma = s.gamma;
+    minAe = s.minAe;
+    minAt = s.minAt;
+    maxAe = s.maxAe;
+    maxAt = s.maxAt;
+    curr_Ae = s.curr_Ae;
+    curr_At = s.curr_At;
+    Mach = s.Mach;
+    Pe = s.Pe;
+    Te = s.Te;
+    Vexit = s.Vexit;
+    T0 = s.T0;
+    M = s.M;
+    R = s.R;
+    solved = std::is_same_v<S, float> && s.prev_Ae == s.curr_Ae;
   }
 
-  void controlOutput(float dOut) {
-    target_output += dOut;
-    if (target_output < 0)
-      target_output = 0;
+  // The same booster in another scalar type.
+  template <typename T> void initFrom(const BoosterModel<T> &other) {
+    delay = S(other.delay);
+    target_output = S(other.target_output);
+    curr_output = S(other.curr_output);
+    gamma = S(other.gamma);
+    minAe = Constant<S>(other.minAe);
+    minAt = Constant<S>(other.minAt);
+    maxAe = Constant<S>(other.maxAe);
+    maxAt = Constant<S>(other.maxAt);
+    curr_Ae = S(other.curr_Ae);
+    curr_At = S(other.curr_At);
+    T0 = S(other.T0);
+    R = S(other.R);
+    M = other.M;
+    Mach = S(other.Mach);
+    Pe = S(other.Pe);
+    Te = S(other.Te);
+    Vexit = S(other.Vexit);
+    solved = other.solved;
   }
 
-  void updateVariables() {
-    calculateMach();
-    calculateExitPressure();
-    calculateTe();
-    calculateVexit();
-    // calculateEffecVel();
+  // Thrust, N.
+  S getForce() {
+    if (!solved)
+      solve();
+    return nozzle::thrust<S>(curr_output, Vexit, Pe, curr_Ae);
   }
 
-  void calculateMach() {
-    if (curr_Ae == prev_Ae)
+  void update(const Constant<S> &dt) {
+    using std::abs;
+
+    if (abs(curr_output - target_output) < SETTLE_BAND) {
+      curr_output = target_output;
       return;
-    prev_Ae = curr_Ae;
-
-    const auto epsilon = curr_Ae / curr_At;
-    const auto t1 = 2.f / (gamma + 1);
-    const auto t2 = (gamma - 1) / 2.f;
-    const auto expoent = (gamma + 1) / (2.f * (gamma - 1));
-
-    const auto f = [&](double M) -> double {
-      double m_abs = std::abs(M);
-      return (t2 * std::pow(m_abs, expoent + 2.f) + std::pow(m_abs, expoent) -
-              std::pow(epsilon, expoent) / t1);
-    };
-
-    const auto df = [&](double M) -> double {
-      double m_abs = std::abs(M);
-      return t2 * (expoent + 1) * std::pow(m_abs, expoent + 1.f) +
-             expoent * std::pow(m_abs, expoent - 1);
-    };
-
-    solver.setPrecision(0.001f);
-    solver.setFunc(f, df);
-
-    auto x0 = 2;
-    if (last_know_Mach > 0.0001f) {
-      x0 = last_know_Mach;
     }
 
-    Mach = solver.solve(x0);
+    curr_output += (target_output - curr_output) * delay * dt;
   }
 
-  void calculateExitPressure() {
-    // TODO: How to optimize it.
-    //  if (curr_Ae == prev_Ae)
-    //    return;
-
-    const auto t1 = (gamma - 1) / 2.;
-    const auto expoent = -gamma / (gamma - 1);
-
-    // Approximate pc = p0 (atmosphere)
-
-    double P_chamber = AIR_PRESSURE * 20.0;
-    Pe = P_chamber * std::pow(1. + t1 * Mach * Mach, expoent);
+  void setTarget(const S &target) {
+    target_output = target < S() ? S() : target;
   }
-
-  void calculateTe() {
-    if (fuelProperties.T0 <= 0) {
-      throw std::runtime_error("Fuel Temperature lower or equal 0");
-    }
-
-    const double t1 = (gamma - 1) / 2.;
-
-    Te = fuelProperties.T0 / (1. + t1 * Mach * Mach);
+  void controlOutput(const S &dOut) { setTarget(target_output + dOut); }
+
+  // Nozzle geometry within its design range; the nozzle is solved again on
+  // the next force when it changed.
+  void controlNozzleArea(const S &dA) {
+    const S area = std::clamp(curr_Ae + dA, S(minAe), S(maxAe));
+    solved &= area == curr_Ae;
+    curr_Ae = area;
+  }
+  void controlThroatArea(const S &dA) {
+    curr_At = std::clamp(curr_At + dA, S(minAt), S(maxAt));
+    solved = false;
   }
 
-  void calculateVexit() {
-    if (fuelProperties.R <= 0) {
-      throw std::runtime_error("FuelProperties.R lower or equal 0");
-    }
+  void solve() {
+    PROFILE_SCOPE(PROFILE_MACH);
 
-    Vexit = Mach * std::sqrt(gamma * fuelProperties.R * Te);
+    if (T0 <= S())
+      throw std::runtime_error("Fuel Temperature lower or equal 0");
+    if (R <= S())
+      throw std::runtime_error("Fuel gas constant R lower or equal 0");
+
+    Newton_Raphson solver;
+    Mach = nozzle::solveExitMach(gamma, S(curr_Ae / curr_At), 2., solver);
+    Pe = nozzle::exitPressure<S>(gamma, Mach);
+    Te = nozzle::exitTemperature<S>(gamma, T0, Mach);
+    Vexit = nozzle::exitVelocity<S>(gamma, R, Te, Mach);
+    solved = true;
   }
 
-  // void calculateEffecVel() {
-  //   const double diff = Pe - AIR_PRESSURE;
-  //   effecVel = Vexit + diff * curr_Ae / output;
-  // }
-};
\ No newline at end of file
+private:
+  // Output close enough to the target to snap to it, kg / s.
+  static inline const Constant<S> SETTLE_BAND = 0.0001;
+};
+
+// The booster of Rocket.
+using RocketBooster = BoosterModel<float>;
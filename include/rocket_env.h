@@ -0,0 +1,108 @@
+#pragma once
+
+/*
+        Vectorized landing environment, C ABI (librocket-env).
+
+        One RocketEnv holds N independent vehicles over the same terrain,
+  each with its own contact solver and episode. A step advances all of them
+  with one call, split across an internal thread pool; buffers belong to
+  the caller and are read and written in place:
+
+          actions  N x ROCKET_ENV_ACTION_SIZE floats, in [0, 1]
+          obs      N x ROCKET_ENV_OBS_SIZE floats
+          rewards  N floats
+          dones    N bytes, 0 or ROCKET_ENV_TERMINATED / ROCKET_ENV_TRUNCATED
+
+        Actions are the main, left and right engine throttles as a fraction
+  of max_main_output / max_side_output; an engine fires while its action is
+  above 0. Observations, per vehicle (m, seconds, radians, kg):
+
+          0 x - target_x        1 target_y - y (height of the CM)
+          2 vx                  3 vy (y down)
+          4 angle               5 angular velocity
+          6 fuel mass           7 .. 9 main, left, right output (kg / s)
+          10 1 while touching the ground
+
+        Episodes start from a state drawn from (seed, episode) alone, so a
+  run does not depend on the thread count. An episode ends by landing
+  (resting on the ground), crashing (impact faster than crash_speed, or
+  leaving the terrain) or reaching max_time. The step that ends it returns
+  its reward and done flag, then the vehicle resets at once: obs already
+  holds the first observation of the next episode.
+
+        Functions returning int give 0 on success and -1 on error;
+  rocket_env_last_error() tells why (per thread). No function throws. A
+  RocketEnv must not be used by two threads at once.
+*/
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#define ROCKET_ENV_API __declspec(dllexport)
+#else
+#define ROCKET_ENV_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ROCKET_ENV_ABI_VERSION 2
+#define ROCKET_ENV_OBS_SIZE 11
+#define ROCKET_ENV_ACTION_SIZE 3
+
+#define ROCKET_ENV_TERMINATED 1
+#define ROCKET_ENV_TRUNCATED 2
+
+typedef struct RocketEnv RocketEnv;
+
+typedef struct RocketEnvConfig {
+  uint32_t count;   /* Environments. */
+  uint32_t threads; /* 0: one per core. */
+
+  const char *scenario; /* Vehicle, wind and precision (scenario.hpp),
+                           or NULL. */
+  const char *terrain;  /* Terrain file (terrain.hpp), or NULL. */
+
+  float dt;               /* Physics step, seconds. */
+  uint32_t action_repeat; /* Physics steps per rocket_env_step. */
+  float max_time;         /* Episode length, seconds. */
+
+  float max_main_output; /* kg / s at action 1. */
+  float max_side_output;
+
+  /* Start states, around the centre of the first pad. */
+  float start_height;       /* Mean height above the pad, m. */
+  float start_height_range; /* Half widths of uniform draws. */
+  float start_x_range;
+  float start_speed_range;
+  float start_angle_range;
+
+  float crash_speed;   /* m / s. */
+  float landing_angle; /* Radians; tilted landings count as crashes. */
+} RocketEnvConfig;
+
+ROCKET_ENV_API int rocket_env_abi_version(void);
+ROCKET_ENV_API void rocket_env_default_config(RocketEnvConfig *config);
+
+/* NULL on error. */
+ROCKET_ENV_API RocketEnv *rocket_env_create(const RocketEnvConfig *config);
+ROCKET_ENV_API void rocket_env_destroy(RocketEnv *env);
+
+ROCKET_ENV_API uint32_t rocket_env_count(const RocketEnv *env);
+
+/* Starts a new episode in every environment: environment i with seeds[i]
+   (i when seeds is NULL). Writes the first observations. */
+ROCKET_ENV_API int rocket_env_reset(RocketEnv *env, const uint64_t *seeds,
+                                    float *obs);
+
+ROCKET_ENV_API int rocket_env_step(RocketEnv *env, const float *actions,
+                                   float *obs, float *rewards,
+                                   uint8_t *dones);
+
+ROCKET_ENV_API const char *rocket_env_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,717 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "constants.hpp"
+#include "dual.hpp"
+#include "fixed.hpp"
+#include "nozzle.hpp"
+#include "profiler.hpp"
+#include "rocket_booster.hpp"
+#include "sim_state.hpp"
+
+// Design-space (local) placement of the parts the physics cares about,
+// meters. Thruster positions are the top-left corners of their shapes.
+struct RocketGeometry {
+  float rocket_width, body_height, nose_height;
+  sf::Vector2f left_thruster;
+  sf::Vector2f right_thruster;
+  sf::Vector2f side_thruster_size;
+  sf::Vector2f bottom_thruster;
+  sf::Vector2f bottom_thruster_size;
+  float area;
+  sf::Vector2f center_of_pressure; // Where drag acts.
+};
+
+/*
+        The vehicle physics, templated on the scalar type.
+
+        Booster forces and torques, booster lag, fuel burn from the tanks,
+  CM / inertia, drag, gravity and the semi-implicit Euler step. Rocket is
+  RocketModel<float> with a design to draw; every other scalar runs the
+  same code on a SimState of it. S is the precision policy:
+
+          float    the fastest, Rocket itself
+          double   the reference run
+          Fixed    Q32.32 (fixed.hpp), the same bits on every machine, for
+                   lockstep runs
+          Dual<N>  derivatives of the final state with respect to N inputs
+
+        Arithmetic stays in S: the constants, the wind and the lever points
+  are Constant<S> (a plain double for Dual, whose derivatives of them would
+  all be zero), converted once, and dt is one too, so a Fixed run does no
+  floating point per step. The wind is held until set again. The data
+  members are the state, free to read; a pose changes through the steps
+  and restoreState(), which keep the cached turn of the angle.
+*/
+template <typename S> struct Vec2T {
+  S x, y;
+};
+
+template <typename S> Vec2T<S> toVec2(const sf::Vector2f &v) {
+  return {S(v.x), S(v.y)};
+}
+
+template <typename S> sf::Vector2f toVector2f(const Vec2T<S> &v) {
+  return {float(value(v.x)), float(value(v.y))};
+}
+
+// A MassComponent in S: only the mass changes (burns).
+template <typename S> struct ComponentModel {
+  S m;
+  Vec2T<Constant<S>> r;
+  Constant<S> I_local;
+  std::uint8_t feeds;
+  std::uint8_t stage;
+};
+
+// Firing flags are discrete; the target outputs (kg / s) are what the
+// derivatives are taken with respect to.
+template <typename S> struct ModelControl {
+  bool bottom = false;
+  bool left = false;
+  bool right = false;
+
+  S bottom_target = S();
+  S left_target = S();
+  S right_target = S();
+};
+
+template <typename S> class RocketModel {
+public:
+  Vec2T<S> pos{}, vel{}, force{};
+  // angle = 0 points the nose up (-y).
+  S angle{}, angVel{}, torque{};
+  Vec2T<Constant<S>> wind{}; // Air velocity at the vehicle, m / s.
+
+  // Total mass, CM (design space) and inertia about it, and the sums
+  // behind them about the design origin: sum m r and sum I_local + m |r|^2.
+  // A burn updates the sums by its own mass alone.
+  S mass{};
+  Vec2T<S> r_cm{};
+  S I_cm{};
+  Vec2T<S> moment{};
+  S second_moment{};
+
+  std::uint32_t component_count = 0;
+  ComponentModel<S> components[MAX_MASS_COMPONENTS];
+
+  BoosterModel<S> left, right, bottom;
+
+  RocketModel() { turn(); }
+
+  RocketModel(const RocketGeometry &geometry, const SimState &state) {
+    setGeometry(geometry);
+    restoreState(state);
+  }
+
+  // The same model in another scalar type, e.g. with more Dual directions.
+  template <typename T> explicit RocketModel(const RocketModel<T> &other) {
+    const auto vec = [](const auto &v) { return Vec2T<S>{S(v.x), S(v.y)}; };
+    const auto point = [](const auto &v) {
+      return Vec2T<Constant<S>>{Constant<S>(v.x), Constant<S>(v.y)};
+    };
+
+    pos = vec(other.pos);
+    vel = vec(other.vel);
+    force = vec(other.force);
+    angle = S(other.angle);
+    angVel = S(other.angVel);
+    torque = S(other.torque);
+    wind = point(other.wind);
+
+    mass = S(other.mass);
+    r_cm = vec(other.r_cm);
+    I_cm = S(other.I_cm);
+    moment = vec(other.moment);
+    second_moment = S(other.second_moment);
+
+    component_count = other.component_count;
+    for (std::uint32_t i = 0; i < component_count; i++) {
+      const auto &c = other.components[i];
+      components[i] = {S(c.m), point(c.r), Constant<S>(c.I_local), c.feeds,
+                       c.stage};
+    }
+    for (int engine = 0; engine < ENGINE_COUNT; engine++)
+      engine_tank[engine] = other.engine_tank[engine];
+
+    left.initFrom(other.left);
+    right.initFrom(other.right);
+    bottom.initFrom(other.bottom);
+
+    profiled = other.profiled;
+
+    left_point = point(other.left_point);
+    right_point = point(other.right_point);
+    bottom_point = point(other.bottom_point);
+    pressure_point = point(other.pressure_point);
+    drag_factor = Constant<S>(other.drag_factor);
+    turn();
+  }
+
+  // The points the forces act at and the drag area.
+  void setGeometry(const RocketGeometry &geometry) {
+    left_point = toVec2<Constant<S>>(geometry.left_thruster);
+    right_point = toVec2<Constant<S>>(geometry.right_thruster);
+    bottom_point = toVec2<Constant<S>>(geometry.bottom_thruster +
+                                       geometry.bottom_thruster_size / 2.f);
+    pressure_point = toVec2<Constant<S>>(geometry.center_of_pressure);
+    drag_factor = 0.5 * AIR_DENSITY * geometry.area;
+  }
+
+  // Snapshot / restore of the whole simulated state (see SimState). A
+  // float model restores the mass sums as saved; any other scalar sums the
+  // components again in its own precision.
+  void saveState(SimState &state) const {
+    state.pos = toVector2f(pos);
+    state.vel = toVector2f(vel);
+    state.acc = {0.f, 0.f};
+    state.pos_prev = state.pos;
+    state.force = toVector2f(force);
+    state.angle = float(value(angle));
+    state.torque = float(value(torque));
+    state.angVel = float(value(angVel));
+    state.wind = toVector2f(wind);
+
+    state.rocket_prop = {float(value(mass)), toVector2f(r_cm),
+                         float(value(I_cm)), toVector2f(moment),
+                         float(value(second_moment))};
+    state.component_count = component_count;
+    for (std::uint32_t i = 0; i < component_count; i++) {
+      const auto &c = components[i];
+      state.components[i] = {float(value(c.m)), toVector2f(c.r),
+                             float(value(c.I_local)), c.feeds, c.stage};
+    }
+
+    left.saveState(state.left);
+    right.saveState(state.right);
+    bottom.saveState(state.bottom);
+  }
+
+  void restoreState(const SimState &state) {
+    pos = toVec2<S>(state.pos);
+    vel = toVec2<S>(state.vel);
+    force = toVec2<S>(state.force);
+    angle = state.angle;
+    torque = state.torque;
+    angVel = state.angVel;
+    wind = toVec2<Constant<S>>(state.wind);
+
+    component_count = state.component_count;
+    for (std::uint32_t i = 0; i < component_count; i++) {
+      const auto &c = state.components[i];
+      components[i] = {S(c.m), toVec2<Constant<S>>(c.r), c.I_local, c.feeds,
+                       c.stage};
+    }
+    if constexpr (std::is_same_v<S, float>) {
+      const auto &p = state.rocket_prop;
+      mass = p.m;
+      r_cm = toVec2<S>(p.r_cm);
+      I_cm = p.I_cm;
+      moment = toVec2<S>(p.moment);
+      second_moment = p.second_moment;
+    } else {
+      updateCmAndInertia();
+    }
+    findTanks();
+
+    left.restoreState(state.left);
+    right.restoreState(state.right);
+    bottom.restoreState(state.bottom);
+    turn();
+  }
+
+  SimState getState() const {
+    SimState state{};
+    saveState(state);
+    return state;
+  }
+
+  // Throws past MAX_MASS_COMPONENTS.
+  void addComponent(const MassComponent &component) {
+    if (component_count >= MAX_MASS_COMPONENTS)
+      throw std::runtime_error(
+          "Too many mass components (MAX_MASS_COMPONENTS)");
+
+    components[component_count++] = {
+        S(component.m), toVec2<Constant<S>>(component.r), component.I_local,
+        component.feeds, component.stage};
+
+    updateCmAndInertia();
+    findTanks();
+  }
+
+  // Sums every component again; burns update the sums as they go.
+  void updateCmAndInertia() {
+    mass = S();
+    moment = {S(), S()};
+    second_moment = S();
+
+    for (std::uint32_t i = 0; i < component_count; i++) {
+      const auto &c = components[i];
+      mass += c.m;
+      moment.x += c.m * c.r.x;
+      moment.y += c.m * c.r.y;
+      second_moment += c.I_local + c.m * (c.r.x * c.r.x + c.r.y * c.r.y);
+    }
+
+    applyMassProps();
+  }
+
+  // One tick with absolute targets: what stepRocket() does with
+  // ControlInput's deltas.
+  void step(const ModelControl<S> &control, const Constant<S> &dt) {
+    if (control.bottom)
+      activeBottomBooster();
+    if (control.left)
+      activeLeftBooster();
+    if (control.right)
+      activeRightBooster();
+
+    bottom.setTarget(control.bottom_target);
+    left.setTarget(control.left_target);
+    right.setTarget(control.right_target);
+
+    updateBoosters(dt);
+    consumeFuelMass(dt);
+    update(dt);
+  }
+
+  // Engine forces for this tick, with the outputs the boosters have. Both
+  // side engines push along the vehicle's y axis; their lever arms, at
+  // either side, turn it opposite ways.
+  void activeLeftBooster() {
+    if (engine_tank[LEFT_ENGINE] < 0)
+      return;
+
+    const S f = left.getForce();
+    applyForceAt(-f * sin_angle, f * cos_angle, left_point);
+  }
+
+  void activeRightBooster() {
+    if (engine_tank[RIGHT_ENGINE] < 0)
+      return;
+
+    const S f = right.getForce();
+    applyForceAt(-f * sin_angle, f * cos_angle, right_point);
+  }
+
+  void activeBottomBooster() {
+    if (engine_tank[BOTTOM_ENGINE] < 0)
+      return;
+
+    const S f = bottom.getForce();
+    applyForceAt(f * sin_angle, -f * cos_angle, bottom_point);
+  }
+
+  void updateBoosters(const Constant<S> &dt) {
+    PROFILE_SCOPE_IF(profiled, PROFILE_BOOSTERS);
+    left.update(dt);
+    right.update(dt);
+    bottom.update(dt);
+  }
+
+  void consumeFuelMass(const Constant<S> &dt) {
+    PROFILE_SCOPE_IF(profiled, PROFILE_FUEL);
+
+    const S outputs[ENGINE_COUNT] = {left.curr_output, right.curr_output,
+                                     bottom.curr_output};
+
+    // Flow out of each tank; engines sharing one add up.
+    int tanks[ENGINE_COUNT];
+    S flows[ENGINE_COUNT];
+    int count = 0;
+    for (int engine = 0; engine < ENGINE_COUNT; engine++) {
+      const int tank = engine_tank[engine];
+      if (tank < 0)
+        continue;
+
+      int k = 0;
+      while (k < count && tanks[k] != tank)
+        k++;
+      if (k == count) {
+        tanks[count] = tank;
+        flows[count++] = outputs[engine];
+      } else {
+        flows[k] += outputs[engine];
+      }
+    }
+
+    bool burned = false, emptied = false;
+    for (int k = 0; k < count; k++) {
+      if (flows[k] == S())
+        continue;
+
+      // Boosters lag behind their commands, so they can still be flowing
+      // when the tank runs dry: never burn more than is left.
+      auto &tank = components[tanks[k]];
+      burn(tank, std::min(S(flows[k] * dt), tank.m));
+      burned = true;
+      emptied |= tank.m <= S();
+    }
+
+    if (burned)
+      applyMassProps();
+    if (emptied)
+      findTanks();
+  }
+
+  // Drag, gravity and the semi-implicit Euler step; clears the force and
+  // torque accumulators.
+  void update(const Constant<S> &dt) {
+    PROFILE_SCOPE_IF(profiled, PROFILE_INTEGRATE);
+    using std::isfinite;
+
+    if (!isfinite(dt) || dt <= Constant<S>())
+      return;
+
+    applyDragForce();
+    force.y += GRAVITY_Y * mass;
+
+    updatePosition(dt);
+    updateRotation(dt);
+
+    force = {S(), S()};
+    torque = S();
+  }
+
+  // In every tank.
+  S getFuelMass() const {
+    S fuel = S();
+    for (std::uint32_t i = 0; i < component_count; i++)
+      if (components[i].feeds)
+        fuel += components[i].m;
+    return fuel;
+  }
+
+  S getLenVel() const { return vel.x * vel.x + vel.y * vel.y; }
+
+  bool hasStage(std::uint8_t stage) const {
+    for (std::uint32_t i = 0; i < component_count; i++)
+      if (components[i].stage == stage)
+        return true;
+    return false;
+  }
+
+  /*
+        Staging: the components of stage leave this vehicle and become the
+  components of jettisoned, a body of its own with its design origin at
+  offset in this vehicle's design. Both parts keep the pose and the
+  velocity they had as one rigid body, so nothing is pushed; this one's
+  CM moves to what is left. Engines switch to the tanks that remain.
+  Allocates nothing. Throws when stage is 0 (the core) or not carried.
+  */
+  void separate(std::uint8_t stage, RocketModel &jettisoned,
+                const Vec2T<Constant<S>> &offset) {
+    if (stage == 0 || !hasStage(stage))
+      throw std::runtime_error("No stage " + std::to_string(stage) +
+                               " to separate");
+
+    // The pose of the whole, before the CM moves.
+    const auto whole_pos = pos, whole_vel = vel, whole_cm = r_cm;
+
+    jettisoned.component_count = 0;
+    std::uint32_t kept = 0;
+    for (std::uint32_t i = 0; i < component_count; i++) {
+      auto component = components[i];
+      if (component.stage == stage) {
+        component.r.x -= offset.x;
+        component.r.y -= offset.y;
+        component.stage = 0;
+        jettisoned.components[jettisoned.component_count++] = component;
+      } else {
+        components[kept++] = component;
+      }
+    }
+    component_count = kept;
+
+    updateCmAndInertia();
+    findTanks();
+    jettisoned.updateCmAndInertia();
+    jettisoned.findTanks();
+
+    // Each part at its own CM, with the velocity of that point of the whole.
+    const S c = cos_angle, s = sin_angle;
+    const auto place = [&](RocketModel &part, const Vec2T<S> &design_cm) {
+      const S dx = design_cm.x - whole_cm.x;
+      const S dy = design_cm.y - whole_cm.y;
+      const S rx = c * dx - s * dy;
+      const S ry = s * dx + c * dy;
+      part.pos = {whole_pos.x + rx, whole_pos.y + ry};
+      part.vel = {whole_vel.x - angVel * ry, whole_vel.y + angVel * rx};
+      part.angle = angle;
+      part.angVel = angVel;
+      part.wind = wind;
+      part.force = {S(), S()};
+      part.torque = S();
+      part.turn();
+    };
+    place(jettisoned, {offset.x + jettisoned.r_cm.x,
+                       offset.y + jettisoned.r_cm.y});
+    place(*this, r_cm);
+  }
+
+protected:
+  // cos and sin of angle, kept with it.
+  S cos_angle, sin_angle;
+
+  // Whether the steps feed the profiler: only the game's vehicles (Rocket
+  // and the models converted from one) do, so the benches' and the
+  // optimizer's model runs stay out of its metrics.
+  bool profiled = false;
+
+private:
+  template <typename> friend class RocketModel;
+
+  // Tank each engine burns from, -1 when none has fuel; see MassComponent.
+  // Engine k is the one of the FEEDS_ bit 1 << k.
+  static constexpr int LEFT_ENGINE = 0, RIGHT_ENGINE = 1, BOTTOM_ENGINE = 2;
+  static constexpr int ENGINE_COUNT = 3;
+  int engine_tank[ENGINE_COUNT] = {-1, -1, -1};
+
+  // Design points the forces act at: the thrusters and the centre of
+  // pressure; and 0.5 rho A of the drag.
+  Vec2T<Constant<S>> left_point{}, right_point{}, bottom_point{},
+      pressure_point{};
+  Constant<S> drag_factor{};
+
+  static inline const Constant<S> GRAVITY_Y = STANDARD_GRAVITY;
+  static inline const Constant<S> MIN_SPEED = 0.001;
+  static inline const Constant<S> MIN_MASS = 1e-6;
+  static inline const Constant<S> MIN_INERTIA = 1e-6;
+
+  void turn() {
+    using std::cos;
+    using std::sin;
+    cos_angle = cos(angle);
+    sin_angle = sin(angle);
+  }
+
+  // A force at a design point: the force and its torque about the CM.
+  void applyForceAt(const S &fx, const S &fy,
+                    const Vec2T<Constant<S>> &local) {
+    force.x += fx;
+    force.y += fy;
+
+    const S dx = local.x - r_cm.x;
+    const S dy = local.y - r_cm.y;
+    const S rx = cos_angle * dx - sin_angle * dy;
+    const S ry = sin_angle * dx + cos_angle * dy;
+    torque += rx * fy - ry * fx;
+  }
+
+  // Drag on the velocity relative to the air, at the centre of pressure:
+  // off the CM, it turns the vehicle into (or away from) the airflow.
+  void applyDragForce() {
+    using std::sqrt;
+
+    const S ax = vel.x - wind.x;
+    const S ay = vel.y - wind.y;
+    const S v_mod = sqrt(ax * ax + ay * ay);
+    if (v_mod < MIN_SPEED)
+      return;
+
+    const S mag_drag = drag_factor * v_mod * v_mod;
+    applyForceAt(-ax / v_mod * mag_drag, -ay / v_mod * mag_drag,
+                 pressure_point);
+  }
+
+  void updatePosition(const Constant<S> &dt) {
+    using std::isfinite;
+
+    if (!isfinite(mass) || mass <= MIN_MASS)
+      return;
+    if (!isfinite(force.x) || !isfinite(force.y))
+      return;
+
+    vel.x += force.x / mass * dt;
+    vel.y += force.y / mass * dt;
+    pos.x += vel.x * dt;
+    pos.y += vel.y * dt;
+
+    if (!isfinite(pos.x) || !isfinite(pos.y) || !isfinite(vel.x) ||
+        !isfinite(vel.y)) {
+      pos = {S(), S()};
+      vel = {S(), S()};
+    }
+  }
+
+  void updateRotation(const Constant<S> &dt) {
+    const S alpha = I_cm > MIN_INERTIA ? S(torque / I_cm) : S();
+    angVel += alpha * dt;
+    angle += angVel * dt;
+    turn();
+  }
+
+  void findTanks() {
+    for (int engine = 0; engine < ENGINE_COUNT; engine++) {
+      engine_tank[engine] = -1;
+      for (auto i = component_count; i-- > 0;) {
+        if (components[i].feeds & (1 << engine) && components[i].m > S()) {
+          engine_tank[engine] = int(i);
+          break;
+        }
+      }
+    }
+  }
+
+  void burn(ComponentModel<S> &tank, const S &burned) {
+    tank.m -= burned;
+    mass -= burned;
+    moment.x -= burned * tank.r.x;
+    moment.y -= burned * tank.r.y;
+    second_moment -= burned * (tank.r.x * tank.r.x + tank.r.y * tank.r.y);
+  }
+
+  // r_cm and I_cm from the sums.
+  void applyMassProps() {
+    if (component_count == 0 || mass <= S()) {
+      r_cm = {S(), S()};
+      return;
+    }
+
+    r_cm = {moment.x / mass, moment.y / mass};
+    // Parallel axis theorem; the difference can round below zero.
+    I_cm = second_moment - mass * (r_cm.x * r_cm.x + r_cm.y * r_cm.y);
+    if (I_cm < S())
+      I_cm = S();
+  }
+};
+
+// The scalars above, for choosing one at run time.
+enum class Precision { FLOAT, DOUBLE, FIXED };
+
+inline const char *precisionName(Precision precision) {
+  switch (precision) {
+  case Precision::FLOAT:
+    return "float";
+  case Precision::DOUBLE:
+    return "double";
+  default:
+    return "fixed";
+  }
+}
+
+// "float", "double" or "fixed"; throws for anything else.
+inline Precision parsePrecision(const std::string &name) {
+  for (const auto precision :
+       {Precision::FLOAT, Precision::DOUBLE, Precision::FIXED})
+    if (name == precisionName(precision))
+      return precision;
+  throw std::runtime_error("Unknown precision: " + name);
+}
+
+// Calls f with a value of the scalar type of precision.
+template <typename F> decltype(auto) withPrecision(Precision precision, F &&f) {
+  switch (precision) {
+  case Precision::FLOAT:
+    return f(float());
+  case Precision::DOUBLE:
+    return f(double());
+  default:
+    return f(Fixed());
+  }
+}
+
+// Final state of a run: x, y, vx, vy, angle, angVel, mass.
+constexpr int LANDING_STATE_SIZE = 7;
+
+template <typename S>
+void getLandingState(const RocketModel<S> &model,
+                     S (&out)[LANDING_STATE_SIZE]) {
+  out[0] = model.pos.x;
+  out[1] = model.pos.y;
+  out[2] = model.vel.x;
+  out[3] = model.vel.y;
+  out[4] = model.angle;
+  out[5] = model.angVel;
+  out[6] = model.mass;
+}
+
+/*
+        Runs a main engine throttle schedule: segment k holds the bottom
+  target output at throttle[k] for steps_per_segment steps, with the main
+  engine firing the whole time.
+*/
+template <typename S>
+RocketModel<S> runThrottleSchedule(const RocketGeometry &geometry,
+                                   const SimState &start, const S *throttle,
+                                   int segments, int steps_per_segment,
+                                   double dt) {
+  RocketModel<S> model(geometry, start);
+  const Constant<S> h = dt;
+
+  ModelControl<S> control;
+  control.bottom = true;
+  control.left_target = model.left.target_output;
+  control.right_target = model.right.target_output;
+
+  for (int k = 0; k < segments; k++) {
+    control.bottom_target = throttle[k];
+    for (int i = 0; i < steps_per_segment; i++)
+      model.step(control, h);
+  }
+
+  return model;
+}
+
+template <int N> struct ScheduleJacobian {
+  double state[LANDING_STATE_SIZE];
+  double jacobian[LANDING_STATE_SIZE][N]; // d state[i] / d throttle[j]
+};
+
+// Segments K - 1 to N - 1 of a throttle schedule. Throttle j only acts
+// from segment j on, so before it the j-th derivative is zero everywhere:
+// segment K - 1 carries K directions, then the model widens by one.
+template <int N, int K>
+RocketModel<Dual<N>> runWidening(RocketModel<Dual<K>> model,
+                                 const double *throttle,
+                                 int steps_per_segment, double dt) {
+  ModelControl<Dual<K>> control;
+  control.bottom = true;
+  control.bottom_target = Dual<K>::seed(throttle[K - 1], K - 1);
+  control.left_target = model.left.target_output;
+  control.right_target = model.right.target_output;
+
+  for (int i = 0; i < steps_per_segment; i++)
+    model.step(control, dt);
+
+  if constexpr (K == N)
+    return model;
+  else
+    return runWidening<N, K + 1>(RocketModel<Dual<K + 1>>(model), throttle,
+                                 steps_per_segment, dt);
+}
+
+// Exact Jacobian of the final state with respect to an N segment throttle
+// schedule, in one forward pass. The pass is runThrottleSchedule() but
+// carries only the directions of the segments started so far, about half
+// the tangent work of a Dual<N> run.
+template <int N>
+ScheduleJacobian<N> throttleScheduleJacobian(const RocketGeometry &geometry,
+                                             const SimState &start,
+                                             const double *throttle,
+                                             int steps_per_segment,
+                                             double dt) {
+  const auto model = runWidening<N, 1>(RocketModel<Dual<1>>(geometry, start),
+                                       throttle, steps_per_segment, dt);
+
+  Dual<N> final_state[LANDING_STATE_SIZE];
+  getLandingState(model, final_state);
+
+  ScheduleJacobian<N> result;
+  for (int i = 0; i < LANDING_STATE_SIZE; i++) {
+    result.state[i] = final_state[i].v;
+    for (int j = 0; j < N; j++)
+      result.jacobian[i][j] = final_state[i].d[j];
+  }
+
+  return result;
+}
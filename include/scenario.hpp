@@ -0,0 +1,193 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "simulation.hpp"
+#include "terrain.hpp"
+#include "wind.hpp"
+
+// One headless flight: the vehicle, an open loop main engine burn and the
+// wind it flies through.
+struct Scenario {
+  RocketParams rocket;
+  WindParams wind; // Ground at the bottom of the site.
+
+  float throttle = 2.f;  // Main engine target output while burning (kg / s).
+  float burn_time = 2.f; // Seconds from the start.
+  float duration = 30.f; // Seconds; a run also ends when the vehicle sleeps.
+  // Seconds from the start to separate stage 1 (RocketParams::stage_*);
+  // below 0 it stays on.
+  float stage_time = -1.f;
+  // World::rebase_distance, meters: set it for flights that start or go
+  // far from the terrain.
+  float rebase_distance = 0.f;
+  // The World's, see FlightModel.
+  Precision precision = Precision::FLOAT;
+};
+
+// The default vehicle and wind on a site of siteW x siteH meters.
+Scenario defaultScenario(float siteW, float siteH);
+
+// A float of Scenario that files and sweeps can name.
+struct ScenarioParam {
+  const char *name;
+  float &(*field)(Scenario &);
+};
+
+extern const ScenarioParam SCENARIO_PARAMS[];
+extern const std::size_t SCENARIO_PARAM_COUNT;
+
+// Index in SCENARIO_PARAMS; throws for an unknown name.
+std::size_t findScenarioParam(const std::string &name);
+
+enum class SweepKind { NONE, CARTESIAN, LATIN_HYPERCUBE };
+
+struct SweepAxis {
+  std::size_t param; // Index in SCENARIO_PARAMS.
+  float from, to;
+  std::uint32_t count; // Cartesian grid points, from and to included.
+};
+
+struct Sweep {
+  SweepKind kind = SweepKind::NONE;
+  std::vector<SweepAxis> axes;
+  std::uint32_t samples = 0; // Latin hypercube.
+  std::uint64_t seed = 1;
+
+  // Runs: 1 without a sweep.
+  std::size_t size() const;
+  // The whole design, size() x axes.size() values row major, in axis
+  // order. Deterministic for a seed.
+  std::vector<float> expand() const;
+};
+
+enum class DispersionKind { NORMAL, UNIFORM };
+
+// Random perturbation of one parameter around its scenario value.
+struct Dispersion {
+  std::size_t param; // Index in SCENARIO_PARAMS.
+  DispersionKind kind;
+  float spread; // Standard deviation (normal) or half width (uniform).
+};
+
+struct MonteCarloConfig {
+  std::uint64_t samples = 0; // 0: no Monte Carlo in the file.
+  std::vector<Dispersion> dispersions;
+
+  // A landing succeeds when the vehicle comes to rest over a pad with
+  // every touchdown slower than success_speed and a final tilt within
+  // success_angle.
+  float success_speed = CRASH_SPEED; // m / s.
+  float success_angle = 0.2f;        // Radians.
+
+  // Touchdown histogram: x error (final x - target_x) against impact
+  // speed. target_x < 0 means the centre of the first pad.
+  float target_x = -1.f;
+  float histogram_x = 3.333f;   // Spans [-histogram_x, histogram_x], m.
+  float histogram_speed = 10.f; // Spans [0, histogram_speed], m / s.
+};
+
+/*
+        Scenario file: text, one setting per line, '#' starts a comment.
+
+          NAME = VALUE              any SCENARIO_PARAMS name
+          sweep cartesian           every combination of the axes
+          sweep lhs SAMPLES         Latin hypercube of SAMPLES runs
+          seed N                    Latin hypercube permutations and jitter
+          vary NAME FROM TO [COUNT] an axis; COUNT is for cartesian only
+          monte_carlo SAMPLES       dispersion runs (rocket-montecarlo)
+          disperse NAME normal SIGMA
+          disperse NAME uniform HALF_WIDTH
+          success_speed, success_angle, target_x, histogram_x,
+          histogram_speed = VALUE   see MonteCarloConfig
+          wind_seed N               turbulence field of every run
+          precision float|double|fixed  Scenario::precision
+
+        The wind_* parameters are WindParams; wind_phase picks where in the
+  shared turbulence field a run starts, so dispersing it gives each sample
+  its own gusts.
+
+        Settings not in the file keep the defaultScenario() values.
+*/
+struct ScenarioFile {
+  Scenario base;
+  Sweep sweep;
+  MonteCarloConfig monte_carlo; // Its seed is sweep.seed.
+  std::uint64_t wind_seed = 1;
+
+  static ScenarioFile load(const std::string &path, float siteW,
+                           float siteH);
+  static ScenarioFile parse(const std::string &text, float siteW,
+                            float siteH);
+
+  // The base scenario with one row of sweep.expand() applied.
+  Scenario at(const float *values) const;
+
+  // The turbulence field shared by every run, built once; null when no
+  // run can have gusts.
+  std::unique_ptr<WindField> windField() const;
+};
+
+struct ScenarioResult {
+  float max_height;   // Above the start, m.
+  float max_speed;    // m / s.
+  float impact_speed; // Fastest touchdown, m / s.
+  float fuel_used;    // kg.
+  float final_x, final_y, final_angle;
+  float rest_time;    // Seconds until the vehicle slept, -1 if it never did.
+  float on_pad;       // 1 when it ended over a pad.
+};
+
+constexpr std::size_t SCENARIO_METRIC_COUNT = 9;
+extern const char *const SCENARIO_METRICS[SCENARIO_METRIC_COUNT];
+
+// Runs one scenario headless in its own World, in the turbulence of wind
+// (none when null: the mean profile only). Throws when the vehicle cannot
+// be built or flown (e.g. a non positive fuel temperature).
+ScenarioResult runScenario(const Scenario &scenario, const Terrain &terrain,
+                           const WindField *wind = nullptr);
+
+/*
+        Streams sweep rows to a file, from any thread, as runs finish; rows
+  are therefore in completion order and carry their run index.
+
+        CSV when the path ends in ".csv": a header line, then
+  run,status,<varied params>,<metrics>.
+
+        Otherwise binary (little endian):
+          char[4]  "RKSW"
+          u32      version (1)
+          u32      varied param count P
+          u32      metric count M
+          P + M    names, each u8 length + chars
+          rows:    u32 run, u32 status (0 ok, 1 failed), P + M x f32
+        Failed runs have NaN metrics.
+*/
+class SweepWriter {
+public:
+  SweepWriter(const std::string &path, const Sweep &sweep);
+  ~SweepWriter();
+
+  SweepWriter(const SweepWriter &) = delete;
+  SweepWriter &operator=(const SweepWriter &) = delete;
+
+  // result is null for a failed run.
+  void write(std::uint32_t run, const float *values,
+             const ScenarioResult *result);
+  void close();
+
+  bool failed() const { return write_failed; }
+
+private:
+  std::mutex mutex;
+  std::ofstream out;
+  bool csv;
+  std::size_t params;
+  bool write_failed = false;
+};
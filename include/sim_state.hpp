@@ -0,0 +1,75 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "rocket_booster.hpp"
+
+// Max components a Rocket can carry. Rocket and SimState store them inline.
+constexpr std::size_t MAX_MASS_COMPONENTS = 16;
+
+// Engines a tank feeds (MassComponent::feeds).
+constexpr std::uint8_t FEEDS_LEFT = 1 << 0;
+constexpr std::uint8_t FEEDS_RIGHT = 1 << 1;
+constexpr std::uint8_t FEEDS_BOTTOM = 1 << 2;
+constexpr std::uint8_t FEEDS_ALL = FEEDS_BOTTOM | FEEDS_LEFT | FEEDS_RIGHT;
+
+/*
+        A point mass of the vehicle. A tank is a component that feeds
+  engines: each engine burns from the last added tank that feeds it and
+  still holds fuel, so outer stages drain before the core. stage tells
+  which components leave together at a staging event (Rocket::separate);
+  0 is the core, which never does.
+*/
+struct MassComponent {
+  float m;        // Component Mass
+  sf::Vector2f r; // Component Pos
+  float I_local;  // Component Inertia
+  std::uint8_t feeds = 0;
+  std::uint8_t stage = 0;
+};
+
+struct MassProps {
+  float m;           // Total Mass
+  sf::Vector2f r_cm; // Center of Mass Position
+  float I_cm;        // Total inertia (rocket)
+
+  // Sums behind them, about the design origin: sum m r and
+  // sum I_local + m |r|^2. A burn updates them by its own mass alone
+  // instead of summing every component again.
+  sf::Vector2f moment;
+  float second_moment;
+};
+
+/*
+        Full snapshot of the simulated state of a Rocket.
+
+        Everything needed to resume the simulation (rigid body, force
+  accumulators, boosters and mass components) and nothing else, so it can be
+  copied with memcpy. Geometry and SFML shapes are not part of it: a state can
+  only be restored into a Rocket built with the same design.
+*/
+struct SimState {
+  sf::Vector2f pos;
+  sf::Vector2f vel;
+  sf::Vector2f acc;
+  sf::Vector2f pos_prev;
+  sf::Vector2f force;
+  float angle;
+  float torque;
+  float angVel;
+  sf::Vector2f wind; // Air velocity at the vehicle, m / s.
+
+  struct MassProps rocket_prop;
+  std::uint32_t component_count;
+  struct MassComponent components[MAX_MASS_COMPONENTS];
+
+  struct BoosterState left;
+  struct BoosterState right;
+  struct BoosterState bottom;
+};
+
+static_assert(std::is_trivially_copyable_v<SimState>,
+              "SimState must stay memcpy-able");
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "rocket.hpp"
+
+/*
+        Commands for one simulation tick.
+
+        The booster flags fire the booster for the tick; the d*Out fields are
+  deltas applied to the booster target outputs (kg / s), exactly what the keys
+  in main.cpp do. The d*Ae fields are deltas of the nozzle exit areas (m^2),
+  clamped to each booster's range.
+*/
+struct ControlInput {
+  bool bottom = false;
+  bool left = false;
+  bool right = false;
+
+  float dBottomOut = 0.f;
+  float dLeftOut = 0.f;
+  float dRightOut = 0.f;
+
+  float dBottomAe = 0.f;
+  float dLeftAe = 0.f;
+  float dRightAe = 0.f;
+
+  // Stage to separate (World::addStage), 0 for none. Needs a World to put
+  // the jettisoned body in; stepRocket() ignores it.
+  std::uint8_t stage = 0;
+};
+
+// Everything createRocket() needs: shape (m), nozzle areas (m^2), fuel and
+// mass components (kg, local m).
+struct RocketParams {
+  float rocket_width, body_height, nose_height;
+  float side_thruster_y, side_thruster_w, side_thruster_h;
+  float bottom_thruster_x, bottom_thruster_w, bottom_thruster_h;
+
+  float gamma;
+  float side_min_ae, side_min_at, side_max_ae, side_max_at;
+  float bottom_min_ae, bottom_min_at, bottom_max_ae, bottom_max_at;
+  float fuel_t0;         // K.
+  float fuel_molar_mass; // kg / kmol.
+  float booster_delay;   // Throttle lag, BoosterModel::delay.
+
+  float body_mass, body_x, body_y;
+  float nose_mass, nose_x, nose_y;
+  float tank_mass, tank_x, tank_y; // The core tank, feeds every engine.
+
+  // Optional stage 1, a lower stage, drop tank or strap-on booster: a box
+  // of stage_width x stage_height with its top left at (stage_x, stage_y)
+  // in the vehicle's design, outside its hull, carrying dry mass and a
+  // tank for the main engine, drained before the core one. The dry mass is
+  // spread over the box, which gives the separated body its inertia. None
+  // when the dry mass is 0; createRocket() throws for fuel without it.
+  float stage_fuel, stage_dry_mass;
+  float stage_x, stage_y, stage_width, stage_height;
+
+  float start_x, start_y;
+  float start_vx, start_vy; // m / s.
+  float start_angle;        // Radians.
+};
+
+// The default vehicle, standing at (siteW / 2, 0.6 siteH) on a site of
+// siteW x siteH meters (SITE_WIDTH x SITE_HEIGHT for the default one).
+RocketParams defaultRocketParams(float siteW, float siteH);
+Rocket createRocket(const RocketParams &params);
+Rocket createRocket(float siteW, float siteH);
+// The body stage 1 of params becomes once separated (World::addStage),
+// with the vehicle's engines; its design origin is (stage_x, stage_y).
+Rocket createStage(const RocketParams &params);
+
+// Touchdown speed (m / s) above which a landing is a crash, compared as
+// CRASH_SPEED * CRASH_SPEED against SweptStep::impact_len_vel. About a
+// fall from 0.3 m; the default of rocket-env's crash_speed and a
+// scenario's success_speed.
+constexpr float CRASH_SPEED = 2.5f;
+
+// Distance from the CM down to the bottom of the body with the rocket
+// upright: the CM height at touchdown.
+float getLandingHeight(const Rocket &rocket);
+
+// One headless tick: commands, booster lag, fuel burn and rigid body update.
+// Ground contact is left to the caller. Any RocketModel, Rocket being the
+// float one; the deltas are taken in S.
+template <typename S>
+void stepRocket(RocketModel<S> &rocket, const ControlInput &input,
+                const Constant<S> &dt) {
+  if (input.bottom)
+    rocket.activeBottomBooster();
+  if (input.left)
+    rocket.activeLeftBooster();
+  if (input.right)
+    rocket.activeRightBooster();
+
+  if (input.dBottomOut != 0.f)
+    rocket.bottom.controlOutput(S(input.dBottomOut));
+  if (input.dLeftOut != 0.f)
+    rocket.left.controlOutput(S(input.dLeftOut));
+  if (input.dRightOut != 0.f)
+    rocket.right.controlOutput(S(input.dRightOut));
+
+  if (input.dBottomAe != 0.f)
+    rocket.bottom.controlNozzleArea(S(input.dBottomAe));
+  if (input.dLeftAe != 0.f)
+    rocket.left.controlNozzleArea(S(input.dLeftAe));
+  if (input.dRightAe != 0.f)
+    rocket.right.controlNozzleArea(S(input.dRightAe));
+
+  rocket.updateBoosters(dt);
+  rocket.consumeFuelMass(dt);
+
+  rocket.update(dt);
+}
+
+// Render-side blend between two consecutive states: position, angle and CM
+// are interpolated, everything else comes from b.
+SimState interpolateState(const SimState &a, const SimState &b, float alpha);
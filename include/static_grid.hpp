@@ -0,0 +1,73 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+/*
+        Uniform grid broadphase over static bounds.
+
+        Built once (statics never move) into flat arrays: the items of cell c
+  are items[cell_start[c] .. cell_start[c + 1]). A query only visits the cells
+  under the area, so its cost follows the area and not the number of
+  statics. An item spanning several cells is reported once, from the cell
+  holding the top left corner of its overlap with the area, which keeps
+  queries const and free of a visited set.
+*/
+class StaticGrid {
+public:
+  void build(const std::vector<sf::FloatRect> &bounds, float cell_size = 2.f);
+
+  bool empty() const { return bounds.empty(); }
+
+  // fn(index) for every item whose bounds overlap area.
+  template <typename Fn> void query(const sf::FloatRect &area, Fn &&fn) const {
+    if (bounds.empty())
+      return;
+
+    const int x0 = column(area.left);
+    const int x1 = column(area.left + area.width);
+    const int y0 = row(area.top);
+    const int y1 = row(area.top + area.height);
+
+    for (int y = y0; y <= y1; y++) {
+      for (int x = x0; x <= x1; x++) {
+        const auto c = static_cast<std::size_t>(y) * columns + x;
+
+        for (auto k = cell_start[c]; k < cell_start[c + 1]; k++) {
+          const auto item = items[k];
+          const auto &b = bounds[item];
+
+          if (b.left > area.left + area.width || area.left > b.left + b.width ||
+              b.top > area.top + area.height || area.top > b.top + b.height)
+            continue;
+
+          if (column(std::max(b.left, area.left)) != x ||
+              row(std::max(b.top, area.top)) != y)
+            continue;
+
+          fn(item);
+        }
+      }
+    }
+  }
+
+private:
+  sf::Vector2f origin;
+  float cell = 128.f;
+  int columns = 0;
+  int rows = 0;
+
+  std::vector<sf::FloatRect> bounds;
+  std::vector<std::uint32_t> cell_start;
+  std::vector<std::uint32_t> items;
+
+  int column(float x) const {
+    return std::clamp(static_cast<int>((x - origin.x) / cell), 0, columns - 1);
+  }
+  int row(float y) const {
+    return std::clamp(static_cast<int>((y - origin.y) / cell), 0, rows - 1);
+  }
+};
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "contact.hpp"
+#include "rocket.hpp"
+
+// One column per recorded value; every column is 4 bytes per record.
+enum TelemetryColumn : std::uint32_t {
+  TM_TICK,
+  TM_POS_X,
+  TM_POS_Y,
+  TM_VEL_X,
+  TM_VEL_Y,
+  TM_ANGLE,
+  TM_ANG_VEL,
+  TM_FORCE_X,
+  TM_FORCE_Y,
+  TM_MASS,
+  TM_CM_X, // Local CM, shifts as fuel burns.
+  TM_CM_Y,
+  TM_LEFT_OUTPUT,
+  TM_LEFT_MACH,
+  TM_LEFT_PE,
+  TM_LEFT_VEXIT,
+  TM_RIGHT_OUTPUT,
+  TM_RIGHT_MACH,
+  TM_RIGHT_PE,
+  TM_RIGHT_VEXIT,
+  TM_BOTTOM_OUTPUT,
+  TM_BOTTOM_MACH,
+  TM_BOTTOM_PE,
+  TM_BOTTOM_VEXIT,
+  TM_CONTACT,        // 1 when touching anything this step.
+  TM_IMPACT_LEN_VEL, // Squared speed at first contact, 0 without impact.
+  TM_SUBSTEPS,
+  TM_COLUMN_COUNT
+};
+
+enum TelemetryType : std::uint32_t { TM_F32 = 0, TM_U32 = 1 };
+
+struct TelemetryColumnInfo {
+  const char *name;
+  TelemetryType type;
+};
+
+extern const TelemetryColumnInfo TELEMETRY_COLUMNS[TM_COLUMN_COUNT];
+
+/*
+        Per-step telemetry recorder with a columnar binary file.
+
+        record() copies one step as a row into the block being filled and does
+  nothing else: no allocation, no lock, no system call, one contiguous
+  row. A full block is handed to a writer thread while the other block
+  fills, so the physics thread only waits if the disk falls a whole block
+  behind (counted in getStalls()). The writer transposes the rows into
+  columns, so in the file each column of a block is contiguous and a reader
+  can pull one signal without touching the rest.
+
+        Binary file (little endian, 4 byte fields):
+          char[4]  "RKTL"
+          u32      version (2)
+          f32      dt, seconds per tick
+          u32      column count
+          u32      block capacity, max records per block
+          columns: column count x (char[24] name, u32 type: 0 f32, 1 u32)
+          blocks until end of file:
+            u32    record count n (1 .. capacity)
+            column count x (n x 4 bytes), in column order
+*/
+class TelemetryRecorder {
+public:
+  static constexpr std::uint32_t BLOCK_CAPACITY = 1024;
+
+  // Throws when the file cannot be created.
+  TelemetryRecorder(const std::string &path, float dt);
+  ~TelemetryRecorder();
+
+  TelemetryRecorder(const TelemetryRecorder &) = delete;
+  TelemetryRecorder &operator=(const TelemetryRecorder &) = delete;
+
+  void record(std::uint32_t tick, const Rocket &rocket,
+              const SweptStep &contact);
+
+  // Writes what is buffered and stops the writer; record() must not be
+  // called afterwards. Also done by the destructor.
+  void close();
+
+  std::uint64_t getRecords() const { return records; }
+  std::uint64_t getStalls() const { return stalls; }
+  bool failed() const { return write_failed.load(std::memory_order_relaxed); }
+
+private:
+  struct Block {
+    std::uint32_t count = 0;
+    std::uint32_t rows[BLOCK_CAPACITY][TM_COLUMN_COUNT];
+  };
+
+  std::ofstream out;
+  Block blocks[2];
+  Block *filling = &blocks[0];
+  // Writer side transpose; the padding keeps the columns off the same
+  // cache sets.
+  static constexpr std::uint32_t COLUMN_STRIDE = BLOCK_CAPACITY + 16;
+  std::uint32_t columns[TM_COLUMN_COUNT * COLUMN_STRIDE];
+
+  std::mutex mutex;
+  std::condition_variable ready;   // A block was submitted, or stop.
+  std::condition_variable drained; // The submitted block was written.
+  Block *pending = nullptr;
+  bool stop = false;
+  std::thread writer;
+
+  std::uint64_t records = 0;
+  std::uint64_t stalls = 0;
+  std::atomic<bool> write_failed{false};
+
+  void submit();
+  void writerLoop();
+  void writeBlock(const Block &block);
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct TerrainSegment {
+  sf::Vector2f a, b;
+};
+
+/*
+        Landing terrain: a ground polyline plus flat landing pads.
+
+        The ground is solid below the polyline and its x is strictly
+  increasing, so any x has one ground height and the segments under an x
+  range are found by binary search (O(1) for a heightfield with uniform
+  spacing). Query cost depends on the range asked for, not on the map size.
+
+        Binary file (little endian, 4 byte fields), meters with y down:
+          char[4]  "RKTR"
+          u32      version (2)
+          u32      kind: 0 polyline, 1 heightfield
+          u32      point count (>= 2)
+          u32      pad count
+          polyline:    point count x (f32 x, f32 y)
+          heightfield: f32 x0, f32 dx, point count x f32 y
+          pads:        pad count x (f32 left, f32 top, f32 width, f32 height)
+*/
+class Terrain {
+public:
+  Terrain() = default;
+  // Throws when points is shorter than 2 or x does not increase.
+  explicit Terrain(std::vector<sf::Vector2f> points);
+
+  static Terrain heightfield(float x0, float dx,
+                             const std::vector<float> &heights);
+  static Terrain load(const std::string &path);
+  void save(const std::string &path) const;
+
+  void addPad(const sf::FloatRect &pad) { pads.push_back(pad); }
+  const std::vector<sf::FloatRect> &getPads() const { return pads; }
+
+  const std::vector<sf::Vector2f> &getPoints() const { return points; }
+  std::size_t getSegmentCount() const {
+    return points.empty() ? 0 : points.size() - 1;
+  }
+  TerrainSegment getSegment(std::size_t i) const {
+    return {points[i], points[i + 1]};
+  }
+  bool empty() const { return points.size() < 2; }
+
+  // Segments overlapping [x_min, x_max], as the index range [first, last).
+  void segmentRange(float x_min, float x_max, std::size_t &first,
+                    std::size_t &last) const;
+  // Points with x in [x_min, x_max], as the index range [first, last).
+  void pointRange(float x_min, float x_max, std::size_t &first,
+                  std::size_t &last) const;
+
+  // Ground height at x (clamped to the ends), pads ignored.
+  float groundAt(float x) const;
+  // Highest solid top at x: ground or a pad spanning x.
+  float surfaceAt(float x) const;
+
+  float friction = 0.6f;
+  float restitution = 0.1f;
+
+private:
+  std::vector<sf::Vector2f> points;
+  std::vector<sf::FloatRect> pads;
+
+  // Uniform spacing (heightfield), 0 for a general polyline.
+  float uniform_dx = 0.f;
+
+  std::size_t lowerPoint(float x) const;
+};
+
+// The default site, siteW x siteH meters (SITE_WIDTH x SITE_HEIGHT): rolling
+// ground around the original pad and a second, higher pad to the right.
+Terrain createTerrain(float siteW, float siteH);
+
+/*
+        Static mesh of a Terrain: ground filled down to bottom in one
+  triangle strip and the pads as quads, two draw calls in total.
+*/
+class TerrainMesh : public sf::Drawable {
+public:
+  TerrainMesh(const Terrain &terrain, float bottom);
+
+private:
+  sf::VertexArray ground;
+  sf::VertexArray pads;
+
+  void draw(sf::RenderTarget &target, sf::RenderStates states) const override {
+    target.draw(ground, states);
+    target.draw(pads, states);
+  }
+};
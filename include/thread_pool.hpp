@@ -0,0 +1,114 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+        Fixed set of worker threads that run the same job together.
+
+        run(job) calls job(worker) once on every worker and returns when all
+  of them are done. The calling thread is worker 0, so a pool of size 1 spawns
+  no thread at all. Threads are created once and sleep between jobs.
+*/
+class ThreadPool {
+public:
+  explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency()) {
+    if (threads == 0)
+      threads = 1;
+
+    for (unsigned i = 1; i < threads; i++)
+      workers.emplace_back([this, i] { workerLoop(i); });
+  }
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    wake.notify_all();
+
+    for (auto &worker : workers)
+      worker.join();
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  unsigned size() const { return static_cast<unsigned>(workers.size()) + 1; }
+
+  void run(const std::function<void(unsigned)> &job) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      current = &job;
+      pending = static_cast<unsigned>(workers.size());
+      generation++;
+    }
+    wake.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+    current = nullptr;
+  }
+
+  // fn(index, worker) for every index in [0, count), load-balanced.
+  template <typename F> void parallelFor(std::size_t count, F &&fn) {
+    // Not worth waking the workers.
+    if (count <= 1 || workers.empty()) {
+      for (std::size_t i = 0; i < count; i++)
+        fn(i, 0u);
+      return;
+    }
+
+    std::atomic<std::size_t> next{0};
+
+    run([&](unsigned worker) {
+      for (;;) {
+        const auto i = next.fetch_add(1, std::memory_order_relaxed);
+        if (i >= count)
+          return;
+        fn(i, worker);
+      }
+    });
+  }
+
+private:
+  std::vector<std::thread> workers;
+
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable done;
+
+  const std::function<void(unsigned)> *current = nullptr;
+  std::uint64_t generation = 0;
+  unsigned pending = 0;
+  bool stop = false;
+
+  void workerLoop(unsigned index) {
+    std::uint64_t seen = 0;
+
+    for (;;) {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&] { return stop || generation != seen; });
+      if (stop)
+        return;
+
+      seen = generation;
+      const auto *job = current;
+      lock.unlock();
+
+      (*job)(index);
+
+      lock.lock();
+      if (--pending == 0)
+        done.notify_one();
+    }
+  }
+};
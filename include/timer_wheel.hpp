@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+
+class TimerWheel;
+
+/*
+        Intrusive timer: lives in its owner (e.g. a coroutine frame), so
+  scheduling allocates nothing. fire is called once when the deadline
+  tick comes; a node unlinks itself when destroyed.
+*/
+struct TimerNode {
+  TimerNode() = default;
+  ~TimerNode() { unlink(); }
+
+  TimerNode(const TimerNode &) = delete;
+  TimerNode &operator=(const TimerNode &) = delete;
+
+  bool isScheduled() const { return next != nullptr; }
+  void unlink();
+
+  std::uint64_t deadline = 0; // Tick.
+  void (*fire)(TimerNode &) = nullptr;
+
+private:
+  friend class TimerWheel;
+  TimerNode *prev = nullptr;
+  TimerNode *next = nullptr;
+};
+
+/*
+        Hierarchical timer wheel over integer ticks.
+
+        LEVELS wheels of SLOTS lists; level l holds the timers due within
+  SLOTS^(l + 1) ticks, in the slot of their deadline at that resolution.
+  Scheduling and cancelling are O(1) list splices. Every tick fires the
+  current level 0 slot; when level 0 wraps, the next level 1 slot is
+  spread down into level 0 (and so on up), so each timer moves at most
+  LEVELS times in its life. Timers further than SLOTS^LEVELS ticks away
+  (about 39 hours at 120 Hz) wait in an overflow list re-sorted once per
+  top level turn.
+*/
+class TimerWheel {
+public:
+  static constexpr int BITS = 6;
+  static constexpr int SLOTS = 1 << BITS;
+  static constexpr int LEVELS = 4;
+
+  TimerWheel();
+
+  TimerWheel(const TimerWheel &) = delete;
+  TimerWheel &operator=(const TimerWheel &) = delete;
+
+  std::uint64_t now() const { return current; }
+
+  // Fires node at tick deadline; the next tick when deadline is not in the
+  // future. A scheduled node is moved.
+  void schedule(TimerNode &node, std::uint64_t deadline);
+  void cancel(TimerNode &node) { node.unlink(); }
+
+  // Advances one tick and fires every timer due at it, in no particular
+  // order. fire may schedule (that node or others) again.
+  void advance();
+
+private:
+  std::uint64_t current = 0;
+  TimerNode slots[LEVELS][SLOTS]; // List heads.
+  TimerNode overflow;
+
+  void insert(TimerNode &node);
+  // Moves every node of list into its place for the current tick.
+  void redistribute(TimerNode &list);
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <SFML/Graphics/Drawable.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/Graphics/RenderTarget.hpp>
+#include <SFML/Graphics/VertexArray.hpp>
+
+#include "ring_buffer.hpp"
+#include "rocket.hpp"
+#include "simulation.hpp"
+#include "terrain.hpp"
+
+constexpr std::size_t TRAIL_CAPACITY = 1024;
+constexpr std::size_t PREDICTION_CAPACITY = 512;
+
+/*
+        Past trail and predicted ballistic path / impact point.
+
+        The trail is a ring of past CM positions drawn as one line strip.
+  The prediction is a ring of future points from a headless coast (no
+  commands) of a private Rocket, ending where it meets a pad or the ground.
+  It is updated incrementally: each frame drops the points that are now in
+  the past and extends the tail back to the full horizon; it is only rebuilt
+  from the current state when the vehicle left the predicted path (a booster
+  fired). Nothing allocates after construction.
+
+        Points are relative to the World origin, like the states they come
+  from, and are shifted when it moves; the impact point is in the terrain
+  frame.
+*/
+class TrajectoryOverlay : public sf::Drawable {
+public:
+  // terrain must outlive the overlay.
+  TrajectoryOverlay(const Rocket &prototype, const Terrain &terrain,
+                    float step_dt = 1.f / 60.f);
+
+  // time is simulation time (s) of state, origin the World::getOrigin()
+  // its pose is relative to.
+  void update(const SimState &state, sf::Vector2<double> origin,
+              double time);
+
+  bool hasImpact() const { return impact; }
+  sf::Vector2f getImpactPoint() const { return impact_point; }
+  double getTimeToImpact() const { return impact_time - now; }
+
+private:
+  struct Point {
+    sf::Vector2f pos;
+    double time;
+  };
+
+  Rocket scratch; // Sits at the last predicted point.
+  const Terrain &terrain;
+  float step_dt;
+  float landing_height;
+
+  RingBuffer<sf::Vector2f, TRAIL_CAPACITY> trail;
+  RingBuffer<Point, PREDICTION_CAPACITY> prediction;
+
+  double now = 0.;
+  sf::Vector2<double> origin;
+  bool impact = false;
+  sf::Vector2f impact_point;
+  double impact_time = 0.;
+
+  sf::VertexArray trail_vertices;
+  sf::VertexArray prediction_vertices;
+  sf::VertexArray impact_marker;
+
+  void restart(const SimState &state, double time);
+  void extend();
+  void rebuildVertices();
+
+  void draw(sf::RenderTarget &target, sf::RenderStates states) const override {
+    target.draw(trail_vertices, states);
+    target.draw(prediction_vertices, states);
+    if (impact)
+      target.draw(impact_marker, states);
+  }
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/*
+        Lock-free single producer / single consumer triple buffer.
+
+        The producer fills writeBuffer() and publish()es it; the consumer
+  calls update() and reads readBuffer(), always getting the most recent
+  published value. Neither side ever waits for the other: the three slots are
+  the one being written, the one being read and the latest published one,
+  and publish / update only swap indices with the middle slot.
+*/
+template <typename T> class TripleBuffer {
+public:
+  T &writeBuffer() { return buffers[write_index]; }
+
+  void publish() {
+    const auto previous =
+        middle.exchange(static_cast<std::uint8_t>(write_index | DIRTY),
+                        std::memory_order_acq_rel);
+    write_index = previous & INDEX_MASK;
+  }
+
+  // True when a newer value than the current read buffer was taken.
+  bool update() {
+    if (!(middle.load(std::memory_order_relaxed) & DIRTY))
+      return false;
+
+    const auto previous =
+        middle.exchange(read_index, std::memory_order_acq_rel);
+    read_index = previous & INDEX_MASK;
+    return true;
+  }
+
+  const T &readBuffer() const { return buffers[read_index]; }
+
+private:
+  static constexpr std::uint8_t DIRTY = 0x4;
+  static constexpr std::uint8_t INDEX_MASK = 0x3;
+
+  T buffers[3]{};
+  std::atomic<std::uint8_t> middle{2};
+
+  // Owned by the producer and the consumer respectively.
+  std::uint8_t write_index = 0;
+  std::uint8_t read_index = 1;
+};
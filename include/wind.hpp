@@ -0,0 +1,66 @@
+#pragma once
+
+#include <SFML/System/Vector2.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "constants.hpp"
+
+// Per run wind settings: cheap to change between runs, unlike the field.
+struct WindParams {
+  float speed = 0.f;            // Mean x speed at reference_height, m / s.
+  float reference_height = 5.f; // Above ground_y, m.
+  float shear = 0.14f;          // Power law exponent of the mean profile.
+  float ground_y = SITE_HEIGHT; // Height 0 of the profile, m (y down).
+  float gust = 0.f;             // Turbulence standard deviation, m / s.
+  float phase = 0.f;            // Seconds added to the field time.
+};
+
+/*
+        Wind as a mean profile plus turbulence.
+
+        The mean blows along x with a power law in the height above
+  ground_y: speed * (h / reference_height)^shear, 0 at and below the ground.
+
+        Turbulence is a grid of unit standard deviation (u, v) samples over
+  (x, y, t), built once: white noise smoothed by a periodic binomial filter
+  along each axis, so it is correlated over a few cells and wraps seamlessly.
+  Sizes are powers of two and indices wrap with a mask, so every position
+  and time is inside the field. Samples are trilinear in (x, y, t) and
+  scaled by WindParams::gust.
+
+        The field is immutable after construction: any number of worlds and
+  threads can sample one field.
+*/
+class WindField {
+public:
+  // cell in meters, cell_time in seconds; nx, ny and nt are rounded up to
+  // powers of two.
+  explicit WindField(std::uint64_t seed = 1, float cell = 1.667f,
+                     float cell_time = 1.f, std::uint32_t nx = 32,
+                     std::uint32_t ny = 32, std::uint32_t nt = 32);
+
+  // Wind (mean + turbulence) at n points at one time, written to u, v.
+  // Arrays are structure of arrays; the time weights are shared by the
+  // whole batch.
+  void sample(const WindParams &params, const float *x, const float *y,
+              std::size_t n, double time, float *u, float *v) const;
+  sf::Vector2f sample(const WindParams &params, sf::Vector2f pos,
+                      double time) const;
+
+  // Mean speed at a height y (m, y down).
+  static float meanSpeed(const WindParams &params, float y);
+
+  float getCell() const { return cell; }
+  float getPeriod() const { return cell_time * nt; } // Seconds.
+
+private:
+  float cell, cell_time;
+  std::uint32_t nx, ny, nt;
+  // u and v planes, index (t * ny + y) * nx + x.
+  std::vector<float> u, v;
+
+  // Field time in cells, wrapped into [0, nt).
+  float wrapTime(double time) const;
+};
@@ -0,0 +1,255 @@
+#pragma once
+
+#include <SFML/Graphics/Rect.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+#include "contact.hpp"
+#include "flight_model.hpp"
+#include "rocket.hpp"
+#include "simulation.hpp"
+#include "terrain.hpp"
+#include "thread_pool.hpp"
+#include "wind.hpp"
+
+constexpr int MAX_PAIR_CONTACTS = 16;
+
+struct PairContact {
+  sf::Vector2f point;  // World position.
+  sf::Vector2f normal; // From vehicle a to vehicle b.
+  float penetration;
+  std::uint32_t id; // Feature id, stable between steps, for warm starting.
+
+  // Solver data.
+  sf::Vector2f ra, rb; // From each CM.
+  float normal_mass, tangent_mass, bias;
+  float normal_impulse, tangent_impulse;
+};
+
+struct PairManifold {
+  std::uint32_t a, b; // Vehicle indices, a < b.
+  PairContact points[MAX_PAIR_CONTACTS];
+  int count = 0;
+
+  std::uint64_t key() const { return std::uint64_t(a) << 32 | b; }
+};
+
+// Everything a vehicle carries from one step to the next.
+struct VehicleState {
+  SimState rocket;
+  ContactManifold manifold; // Terrain warm start.
+  SweptStep contact;
+  sf::FloatRect bounds; // As of its last step, not its current pose.
+  std::uint32_t sleeping;
+  std::uint32_t mounted; // A stage not separated yet.
+  float rest_time;
+};
+
+static_assert(std::is_trivially_copyable_v<VehicleState>);
+
+/*
+        Snapshot of a World between steps. Restoring it into a world built
+  the same way (terrain, vehicle designs, parameters) continues bit for bit
+  as the original did.
+*/
+struct WorldState {
+  std::vector<VehicleState> vehicles;
+  std::vector<std::uint32_t> order;
+  std::vector<PairManifold> pairs; // Warm start of the pairs.
+  // Off float, the vehicles' FlightModels. Without them the vehicles
+  // continue from their float states, close to but not bit for bit.
+  std::vector<FlightModel> flights;
+  double time = 0.;                // Seconds stepped, for the wind.
+  sf::Vector2<double> origin;      // See World::rebase_distance.
+};
+
+struct WorldStats {
+  std::size_t awake = 0;
+  std::size_t sleeping = 0;
+  std::size_t mounted = 0;        // Stages still on their vehicle.
+  std::size_t pairs = 0;          // Broadphase overlaps tested.
+  std::size_t touching_pairs = 0; // Pairs with contacts.
+};
+
+/*
+        Many vehicles sharing one terrain.
+
+        Each vehicle keeps its own ContactSolver for the terrain (swept, warm
+  started), and those steps run in parallel. Vehicle against vehicle goes
+  through a sweep and prune broadphase on x: the vehicles stay sorted by the
+  left edge of their bounds with an insertion sort, nearly free from one step
+  to the next, and a sweep over that order yields the overlapping pairs.
+  Touching pairs get a manifold from each hull's vertices inside the other's
+  parts and are solved together with sequential impulses, warm started from
+  the pairs of the previous step.
+
+        A vehicle that has been resting on something for sleep_time goes to
+  sleep: it is not stepped or collided until it gets commands, is hit by a
+  moving vehicle or is woken explicitly. In a pair, a sleeping vehicle has
+  infinite mass, so others can come to rest against it. Nothing allocates
+  once the pair lists have grown to their working size.
+
+        The origin floats. Vehicle poses are float meters from getOrigin(),
+  a double; the terrain, its pads and the wind stay put. Far from the
+  terrain a float position steps in coarse increments (8 mm at 100 km up),
+  so a long descent loses speed to rounding every tick. With
+  rebase_distance set, step() moves the origin onto the focus vehicle (the
+  one the camera follows) whenever it strays farther than that, by whole
+  multiples of REBASE_GRID so positions shift exactly, and everything
+  stays float.
+
+        Stages are vehicles too, added up front (addStage) and kept mounted:
+  while mounted a stage is only mass on its vehicle (a drop tank or a
+  strap-on booster, outside the vehicle's hull) and is not stepped,
+  collided or counted as awake. A ControlInput::stage command separates it
+  at the start of the next step (Rocket::separate), which only moves
+  components between two existing vehicles: staging allocates nothing.
+
+        The vehicles fly in the world's Precision (FlightModel): float by
+  default; double for reference runs; fixed point so that free flight is
+  bit exact on every machine, for lockstep and replays. Contacts, pairs
+  and everything that reads a vehicle still see it as a float Rocket.
+*/
+class World {
+public:
+  // terrain must outlive the world.
+  explicit World(const Terrain &terrain,
+                 unsigned threads = std::thread::hardware_concurrency(),
+                 Precision precision = Precision::FLOAT);
+
+  // rocket's pose is taken from the current origin.
+  std::size_t addVehicle(const Rocket &rocket);
+  std::size_t size() const { return vehicles.size(); }
+  const Terrain &getTerrain() const { return terrain; }
+  Precision getPrecision() const { return precision; }
+
+  // Off float, changes to a vehicle's state from outside need sync(i).
+  Rocket &getVehicle(std::size_t i) { return vehicles[i].rocket; }
+  const Rocket &getVehicle(std::size_t i) const { return vehicles[i].rocket; }
+  void sync(std::size_t i) { vehicles[i].syncFlight(); }
+
+  /*
+        Stage stage of vehicle as a body of its own, prototype (a Rocket
+  without components, see createStage()) with its design origin at offset
+  in the vehicle's design. Part of building the world, like addVehicle:
+  a world restored from or replaying this one needs the same calls.
+  Throws when the vehicle carries no such stage.
+  */
+  std::size_t addStage(std::size_t vehicle, std::uint8_t stage,
+                       const Rocket &prototype, sf::Vector2f offset);
+  bool isMounted(std::size_t i) const { return vehicles[i].mounted; }
+
+  // Commands for the next steps; any command wakes the vehicle.
+  void setInput(std::size_t i, const ControlInput &input);
+
+  bool isSleeping(std::size_t i) const { return vehicles[i].sleeping; }
+  void wake(std::size_t i);
+
+  // Contact outcome of vehicle i in the last step (terrain and vehicles).
+  const SweptStep &getContact(std::size_t i) const {
+    return vehicles[i].contact;
+  }
+
+  const std::vector<PairManifold> &getPairs() const { return pairs; }
+
+  const sf::Vector2<double> &getOrigin() const { return origin; }
+  // Position of vehicle i in the terrain's frame.
+  sf::Vector2<double> getWorldPos(std::size_t i) const {
+    const auto &pos = vehicles[i].rocket.getPos();
+    return {origin.x + pos.x, origin.y + pos.y};
+  }
+  // Moves the origin by shift and every vehicle by -shift. shift should be
+  // whole multiples of REBASE_GRID for the move to be exact.
+  void rebase(sf::Vector2f shift);
+
+  // No allocation once state has grown to this world's size. Throws when
+  // state has another number of vehicles.
+  void saveState(WorldState &state) const;
+  void restoreState(const WorldState &state);
+  const WorldStats &getStats() const { return stats; }
+
+  void step(float dt);
+
+  // Wind for every awake vehicle, sampled once per step before any moves.
+  // A null field gives the mean profile alone; still air by default. field
+  // must outlive the world (or the next setWind).
+  void setWind(const WindField *field, const WindParams &params = {});
+  double getTime() const { return time; }
+
+  int iterations = 10;
+  int position_iterations = 4;
+  float position_correction = 0.8f;
+  float slop = 0.008f; // m
+  float friction = 0.5f;
+  float restitution = 0.2f;
+  float restitution_speed = 1.f; // m / s
+
+  float sleep_speed = 0.033f;        // m / s
+  float sleep_angular_speed = 0.02f; // rad / s
+  float sleep_time = 0.5f;           // s
+
+  static constexpr float REBASE_GRID = 16.f; // m
+  float rebase_distance = 0.f; // m; 0 keeps the origin where it is.
+  std::size_t focus = 0;       // The vehicle the origin follows.
+
+private:
+  struct Vehicle {
+    Vehicle(const Rocket &rocket, Precision precision);
+
+    Rocket rocket;
+    ContactSolver contacts;
+    FlightModel flight;
+    ControlInput input;
+    SweptStep contact;
+
+    sf::FloatRect bounds;
+    bool sleeping = false;
+    bool touching = false; // Touches another vehicle this step.
+    float rest_time = 0.f;
+
+    // Stages (addStage): what separates from which vehicle, and where.
+    bool mounted = false;
+    std::uint32_t parent = 0;
+    std::uint8_t stage = 0;
+    sf::Vector2f offset;
+
+    void syncFlight() { flight.sync(rocket); }
+  };
+
+  const Terrain &terrain;
+  Precision precision;
+  ThreadPool pool;
+  std::vector<Vehicle> vehicles;
+
+  std::vector<std::uint32_t> order; // Sorted by bounds.left.
+  std::vector<std::uint32_t> active;
+  std::vector<std::uint32_t> coupled; // Awake vehicles in a pair.
+  std::vector<PairManifold> pairs;
+  std::vector<PairManifold> previous;
+
+  WorldStats stats;
+  sf::Vector2<double> origin;
+
+  const WindField *wind_field = nullptr;
+  WindParams wind_params;
+  bool windy = false;
+  double time = 0.;
+  // Batch of awake vehicles for WindField::sample, sized by addVehicle.
+  std::vector<std::uint32_t> wind_vehicles;
+  std::vector<float> wind_x, wind_y, wind_u, wind_v;
+
+  void sampleWind();
+  void followFocus();
+
+  void separateStage(std::uint32_t parent);
+  void stepVehicle(Vehicle &vehicle, float dt);
+  void findPairs();
+  bool collidePair(std::uint32_t a, std::uint32_t b, PairManifold &out) const;
+  void preparePair(PairManifold &pair);
+  void solvePair(PairManifold &pair);
+  void correctPair(PairManifold &pair);
+  bool isMoving(const Vehicle &vehicle) const;
+  void updateSleep(Vehicle &vehicle, float dt);
+};
@@ -1,130 +1,357 @@
+#include "include/autopilot.hpp"
+#include "include/fleet_renderer.hpp"
+#include "include/hud.hpp"
+#include "include/live_telemetry.hpp"
+#include "include/mission.hpp"
+#include "include/profiler.hpp"
+#include "include/replay.hpp"
 #include "include/rocket.hpp"
+#include "include/scenario.hpp"
+#include "include/simulation.hpp"
+#include "include/telemetry.hpp"
+#include "include/terrain.hpp"
+#include "include/trajectory_overlay.hpp"
+#include "include/triple_buffer.hpp"
+#include "include/world.hpp"
 
 #include <SFML/Graphics.hpp>
 #include <SFML/Window/Event.hpp>
-
-inline float dot(const sf::Vector2f &a, const sf::Vector2f &b) {
-
-  return a.x * b.x + a.y * b.y;
-}
-inline float cross(const sf::Vector2f &a, const sf::Vector2f &b) {
-  return a.x * b.y - a.y * b.x;
-}
-
-inline sf::Vector2f cross(float w, const sf::Vector2f &r) {
-  return sf::Vector2f(-w * r.y, w * r.x);
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+
+// Physics runs at a fixed rate on its own thread, independent of drawing.
+const int PHYSICS_HZ = 120;
+
+using SteadyClock = std::chrono::steady_clock;
+
+ControlInput readKeyboard(float dt) {
+  ControlInput input;
+
+  input.bottom = sf::Keyboard::isKeyPressed(sf::Keyboard::Space);
+  input.left = sf::Keyboard::isKeyPressed(sf::Keyboard::A);
+  input.right = sf::Keyboard::isKeyPressed(sf::Keyboard::D);
+
+  const float dOut = 10.0f * dt;
+  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up))
+    input.dBottomOut += dOut;
+  if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down))
+    input.dBottomOut -= dOut;
+
+  if (sf::Keyboard::isKeyPressed(sf::Keyboard::K))
+    input.dLeftOut += dOut;
+  if (sf::Keyboard::isKeyPressed(sf::Keyboard::J))
+    input.dLeftOut -= dOut;
+
+  if (sf::Keyboard::isKeyPressed(sf::Keyboard::P))
+    input.dRightOut += dOut;
+  if (sf::Keyboard::isKeyPressed(sf::Keyboard::O))
+    input.dRightOut -= dOut;
+
+  return input;
 }
 
-void resolveGroundContact(Rocket &rocket, const sf::RectangleShape &platform) {
-  if (!rocket.getBounds().intersects(platform.getGlobalBounds()))
-    return;
-
-  const float mass = rocket.getMass();
-  const float I = rocket.getInertia();
-  if (mass <= 1e-6f || I <= 1e-6f)
-    return;
-
-  const sf::Vector2f n(0.f, -1.f);
-  const sf::Vector2f t(1.f, 0.f);
-
-  const sf::Vector2f v = rocket.getVel();
-  float w = rocket.getAngularVel();
-  const sf::Vector2f cm = rocket.getCmWorld();
-  const sf::FloatRect rb = rocket.getBounds();
-  const sf::FloatRect pb = platform.getGlobalBounds();
-
-  const sf::Vector2f contact(rb.left + rb.width * 0.5f, rb.top + rb.height);
-  const sf::Vector2f r = contact - cm;
-  const sf::Vector2f v_contact = v + cross(w, r);
-
-  const float vn = dot(v_contact, n);
-  const float vt = dot(v_contact, t);
-
-  if (vn >= 0.f)
-    return;
-
-  float e = 0.15f;
-  if (std::abs(vn) < 1.0f)
-    e = 0.f;
-
-  const float rCrossN = cross(r, n);
-  const float denomN = (1.f / mass) + (rCrossN * rCrossN) / I;
-  float jn = -(1.f + e) * vn / denomN;
-
-  const float frictionCoeff = 0.5f;
-  const float rCrossT = cross(r, t);
-  const float denomT = (1.f / mass) + (rCrossT * rCrossT) / I;
+// What the physics thread hands to the render thread each tick.
+struct FrameSnapshot {
+  SimState previous_state;
+  SimState state;
+  sf::Vector2<double> origin; // World::getOrigin() of both states.
+  std::uint64_t tick = 0;
+  SteadyClock::time_point published;
+
+  bool autopilot_enabled = false;
+  AutopilotStats autopilot;
+
+  // Last time the main engine command went from off to on: when the key was
+  // sampled and when the step that applied its thrust finished.
+  SteadyClock::time_point input_sampled;
+  SteadyClock::time_point thrust_applied;
+
+  // Speed of the last impact hard enough to destroy the vehicle (m / s),
+  // 0 when there was none.
+  float crash_speed = 0.f;
+};
+
+struct PhysicsShared {
+  TripleBuffer<FrameSnapshot> frames;
+  std::atomic<bool> running{true};
+  std::atomic<bool> autopilot_requested{false};
+};
+
+void physicsLoop(PhysicsShared &shared, const Rocket &prototype,
+                 const Terrain &terrain, const AutopilotConfig &autopilotConfig,
+                 TelemetryRecorder *telemetry, const WindField *wind,
+                 const WindParams &windParams, float rebaseDistance,
+                 Precision precision, MissionScript script,
+                 const char *recordPath, bool publishLive) {
+  World world(terrain, 1, precision);
+  const auto player = world.addVehicle(prototype);
+  world.setWind(wind, windParams);
+  world.rebase_distance = rebaseDistance;
+  Rocket &rocket = world.getVehicle(player);
+
+  // A mission script flies the player in place of the keyboard.
+  MissionSequencer sequencer(world, 1.f / PHYSICS_HZ);
+  const auto mission = script ? sequencer.start(player, script) : 0;
+
+  // Commands and keyframes for flight-replay; see replay.hpp. A file that
+  // cannot be created only costs the recording, not the flight.
+  std::unique_ptr<FlightRecorder> flight;
+  if (recordPath) {
+    try {
+      flight = std::make_unique<FlightRecorder>(recordPath, world,
+                                                1.f / PHYSICS_HZ);
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << "\n";
+    }
+  }
+  // For telemetry-reader and other live dashboards. Creating the ring
+  // replaces the one of any other publishing simulator, hence opt-in.
+  std::unique_ptr<LiveTelemetryWriter> live;
+  if (publishLive) {
+    try {
+      live = std::make_unique<LiveTelemetryWriter>();
+    } catch (const std::exception &e) {
+      std::cerr << e.what() << "\n";
+    }
+  }
 
-  float jt = -vt / denomT;
-  float maxJt = jn * frictionCoeff;
-  jt = std::max(-maxJt, std::min(maxJt, jt));
+  Autopilot autopilot(rocket, autopilotConfig);
+  bool autopilotEnabled = false;
+
+  const float dt = 1.f / PHYSICS_HZ;
+  const auto period = std::chrono::duration_cast<SteadyClock::duration>(
+      std::chrono::duration<double>(dt));
+
+  std::uint64_t tick = 0;
+  bool lastBottom = false;
+  SteadyClock::time_point inputSampled, thrustApplied;
+  float crashSpeed = 0.f;
+  SimState lastState = rocket.getState();
+  auto lastOrigin = world.getOrigin();
+  auto next = SteadyClock::now();
+
+  while (shared.running.load(std::memory_order_relaxed)) {
+    const bool requested = shared.autopilot_requested.load();
+    if (requested != autopilotEnabled) {
+      autopilotEnabled = requested;
+      autopilot.reset();
+    }
 
-  const sf::Vector2f impulse = (jn * n) + (jt * t);
+    const auto sampled = SteadyClock::now();
+    if (script)
+      sequencer.tick();
+    const auto input =
+        autopilotEnabled ? autopilot.tick(rocket, dt, world.getOrigin())
+        : script         ? sequencer.getInput(mission)
+                         : readKeyboard(dt);
+    world.setInput(player, input);
+    if (flight)
+      flight->command(player, input);
+    world.step(dt);
+    if (flight)
+      flight->endTick(world);
+    const auto &contact = world.getContact(player);
+
+    if (input.bottom && !lastBottom) {
+      inputSampled = sampled;
+      thrustApplied = SteadyClock::now();
+    }
+    lastBottom = input.bottom;
+
+    if (contact.touched && contact.impact_len_vel > CRASH_SPEED * CRASH_SPEED)
+      crashSpeed = std::sqrt(contact.impact_len_vel);
+
+    if (telemetry)
+      telemetry->record(static_cast<std::uint32_t>(tick + 1), rocket, contact);
+    if (live)
+      live->publish(tick + 1, world);
+
+    // A rebase moved the frame under the last state: carry it over so the
+    // render thread interpolates between two states of the same frame.
+    const auto origin = world.getOrigin();
+    if (origin != lastOrigin) {
+      lastState.pos.x += static_cast<float>(lastOrigin.x - origin.x);
+      lastState.pos.y += static_cast<float>(lastOrigin.y - origin.y);
+      lastOrigin = origin;
+    }
 
-  rocket.applyVel(impulse / mass);
-  rocket.applyAngVel(cross(r, impulse) / I);
+    auto &frame = shared.frames.writeBuffer();
+    frame.previous_state = lastState;
+    rocket.saveState(frame.state);
+    frame.origin = origin;
+    lastState = frame.state;
+    frame.tick = ++tick;
+    frame.published = SteadyClock::now();
+    frame.autopilot_enabled = autopilotEnabled;
+    frame.autopilot = autopilot.getStats();
+    frame.input_sampled = inputSampled;
+    frame.thrust_applied = thrustApplied;
+    frame.crash_speed = crashSpeed;
+    shared.frames.publish();
+
+    next += period;
+    const auto now = SteadyClock::now();
+    if (now - next > std::chrono::milliseconds(250))
+      next = now; // Fell far behind (debugger, suspend): don't spiral.
+    std::this_thread::sleep_until(next);
+  }
+}
 
-  const float angularThreshold = 0.1f;
-  if (std::abs(rocket.getAngularVel()) < angularThreshold) {
-    rocket.setAngVel(0.f);
-  } else {
-    rocket.applyAngVel(-rocket.getAngularVel() * 0.1f);
+// Autopilot and timing lines under the rocket telemetry.
+struct AppHud {
+  int autopilot_mode, candidates, tick, overruns, best_cost;
+  int physics_rate, render_rate, input_to_thrust, input_to_display;
+  int impact, crash;
+
+  explicit AppHud(Hud &hud) {
+    hud.addHeader("");
+    hud.addHeader("--- AUTOPILOT (MPC) ---");
+    autopilot_mode = hud.addField("Mode (M):");
+    candidates = hud.addField("Candidates:");
+    tick = hud.addField("Tick:");
+    overruns = hud.addField("Overruns:");
+    best_cost = hud.addField("Best cost:");
+
+    hud.addHeader("");
+    hud.addHeader("--- TIMING ---");
+    physics_rate = hud.addField("Physics:");
+    render_rate = hud.addField("Render:");
+    input_to_thrust = hud.addField("Input->thrust:");
+    input_to_display = hud.addField("Input->display:");
+
+    hud.addHeader("");
+    impact = hud.addField("Impact in:");
+    crash = hud.addField("Crash:");
   }
 
-  const float penetration = (rb.top + rb.height) - pb.top;
-  if (penetration > 0.f) {
-    const float slop = 0.1f;
-    const float beta = 0.3f;
-    rocket.applyPos(n * (std::max(penetration - slop, 0.f) * beta));
+  void update(Hud &hud, const FrameSnapshot &frame,
+              const TrajectoryOverlay &trajectory, float inputToDisplayMs,
+              float fps) const {
+    using ms = std::chrono::duration<float, std::milli>;
+    const auto &ap = frame.autopilot;
+
+    hud.set(autopilot_mode,
+            HudWriter() << (frame.autopilot_enabled ? "ON" : "OFF"));
+    hud.set(candidates, HudWriter() << ap.candidates << " / tick");
+    hud.set(tick, HudWriter() << ap.tick_us << " us (max " << ap.max_tick_us
+                              << ")");
+    hud.set(overruns, HudWriter() << ap.overruns << " / " << ap.ticks);
+    hud.set(best_cost, HudWriter() << ap.best_cost);
+
+    hud.set(physics_rate, HudWriter() << PHYSICS_HZ << " Hz");
+    hud.set(render_rate,
+            HudWriter() << static_cast<int>(fps + 0.5f) << " FPS");
+    hud.set(input_to_thrust,
+            HudWriter()
+                << ms(frame.thrust_applied - frame.input_sampled).count()
+                << " ms");
+    hud.set(input_to_display, HudWriter() << inputToDisplayMs << " ms");
+
+    if (trajectory.hasImpact())
+      hud.set(impact, HudWriter() << trajectory.getTimeToImpact() << " s at x "
+                                  << trajectory.getImpactPoint().x);
+    else
+      hud.set(impact, HudWriter() << "-");
+
+    if (frame.crash_speed > 0.f)
+      hud.set(crash, HudWriter() << frame.crash_speed << " m/s");
+    else
+      hud.set(crash, HudWriter() << "-");
+  }
+};
+
+int main(int argc, char **argv) {
+  // The simulation is in meters; the window shows the default site at PPM
+  // and follows the vehicle.
+  const float width = SITE_WIDTH;
+  const float height = SITE_HEIGHT;
+
+  // [TERRAIN] [--scenario FILE] [--mission NAME] [--telemetry FILE]
+  // [--record FILE] [--live]: see terrain.hpp and scenario.hpp for the
+  // formats, mission_scripts.cpp for the missions. Only the vehicle, wind,
+  // rebase_distance and precision of a scenario are used here. --live
+  // publishes to LIVE_TELEMETRY_NAME.
+  const char *terrainPath = nullptr;
+  const char *scenarioPath = nullptr;
+  const char *telemetryPath = nullptr;
+  const char *recordPath = nullptr;
+  bool publishLive = false;
+  MissionScript mission = nullptr;
+  for (int i = 1; i < argc; i++) {
+    if (!std::strcmp(argv[i], "--scenario") && i + 1 < argc)
+      scenarioPath = argv[++i];
+    else if (!std::strcmp(argv[i], "--mission") && i + 1 < argc) {
+      try {
+        mission = findMission(argv[++i]);
+      } catch (const std::runtime_error &e) {
+        std::fprintf(stderr, "%s\nmissions:", e.what());
+        for (std::size_t m = 0; m < MISSION_COUNT; m++)
+          std::fprintf(stderr, " %s", MISSIONS[m].name);
+        std::fprintf(stderr, "\n");
+        return 2;
+      }
+    } else if (!std::strcmp(argv[i], "--telemetry") && i + 1 < argc)
+      telemetryPath = argv[++i];
+    else if (!std::strcmp(argv[i], "--record") && i + 1 < argc)
+      recordPath = argv[++i];
+    else if (!std::strcmp(argv[i], "--live"))
+      publishLive = true;
+    else
+      terrainPath = argv[i];
   }
-}
-auto createRocket(float screenW, float screenH) {
-
-  Rocket rocket(/*rocket_width*/ 40, /*body_height*/ 140, /*nose_height*/ 60);
-
-  rocket.setBody(sf::Color(220, 220, 220));
-  rocket.setNose(sf::Color(200, 80, 80));
-  rocket.setSideThrusters(/*y*/ 50, /*w*/ 10, /*h*/ 25,
-                          sf::Color(240, 200, 60));
-  rocket.setBottomThrusters(/*x*/ 15, /*w*/ 10, /*h*/ 25,
-                            sf::Color(240, 200, 60));
-
-  rocket.configureSideBooster(
-      /*gamma*/ 1.22f,
-      /*minSideAe*/ 0.00001f,
-      /*minSideAt*/ 0.0002f,
-      /*maxSideAe*/ 0.00008f,
-      /*maxSideAt*/ 0.0008f,
-      /*minBottomAe*/ 0.00001f,
-      /*minBottomAt*/ 0.0002f,
-      /*maxBottomAe*/ 0.0005f,
-      /*maxBottomAt*/ 0.0004f);
-
-  rocket.setBoosterFuel(/*T0*/ 3200.0, /*M*/ 22.0);
-
-  rocket.setBoosterOutputs(0.f, 0.f, 0.f);
-
-  rocket.addComponent({/*m*/ 100.f, /*r*/ {20.f, 70.f}, /*I_local*/ 0.f});
-  rocket.addComponent({/*m*/ 100.f, /*r*/ {20.f, -20.f}, /*I_local*/ 0.f});
-  rocket.addComponent({/*m*/ 80.f, /*r*/ {20.f, 110.f}, /*I_local*/ 0.f});
-  rocket.setInitialPosition(screenW * 0.5f, screenH * 0.6f);
-  return rocket;
-}
 
-int main() {
-  const float width = 1000;
-  const float height = 1000;
-  sf::RenderWindow window(sf::VideoMode({static_cast<unsigned int>(width),
-                                         static_cast<unsigned int>(height)}),
-                          "Rocket Simulator");
+  sf::RenderWindow window(
+      sf::VideoMode({static_cast<unsigned int>(std::lround(width * PPM)),
+                     static_cast<unsigned int>(std::lround(height * PPM))}),
+      "Rocket Simulator");
   window.setFramerateLimit(120);
-  auto rocket = createRocket(width, height);
-
-  sf::RectangleShape platform({300.f, 20.f});
-  platform.setFillColor(sf::Color(100, 100, 100));
-  platform.setPosition({300.f, 900.f});
 
-  sf::Clock clock;
+  ScenarioFile scenario;
+  scenario.base = defaultScenario(width, height);
+  if (scenarioPath)
+    scenario = ScenarioFile::load(scenarioPath, width, height);
+  auto rocket = createRocket(scenario.base.rocket);
+  const auto wind = scenario.windField();
+
+  const Terrain terrain =
+      terrainPath ? Terrain::load(terrainPath) : createTerrain(width, height);
+  if (terrain.getPads().empty())
+    throw std::runtime_error("Terrain has no landing pad");
+  // Deep enough for the camera to look below the lowest point of the site.
+  const TerrainMesh terrainMesh(terrain, 2.f * height);
+
+  // The autopilot lands on the first pad.
+  const auto &pad = terrain.getPads().front();
+  AutopilotConfig autopilotConfig;
+  autopilotConfig.target_x = pad.left + pad.width / 2;
+  autopilotConfig.ground_y = pad.top;
+
+  // Per-step record, only when asked for.
+  std::unique_ptr<TelemetryRecorder> telemetry;
+  if (telemetryPath)
+    telemetry =
+        std::make_unique<TelemetryRecorder>(telemetryPath, 1.f / PHYSICS_HZ);
+
+  PhysicsShared shared;
+  // Seed the read side so the first frames have something to show.
+  auto &seed = shared.frames.writeBuffer();
+  rocket.saveState(seed.state);
+  seed.previous_state = seed.state;
+  shared.frames.publish();
+
+  std::thread physics(physicsLoop, std::ref(shared), rocket,
+                      std::cref(terrain), std::cref(autopilotConfig),
+                      telemetry.get(), wind.get(),
+                      std::cref(scenario.base.wind),
+                      scenario.base.rebase_distance, scenario.base.precision,
+                      mission, recordPath, publishLive);
 
   sf::Font font;
 
@@ -132,67 +359,108 @@ int main() {
                          "JetBrainsMono-Regular.ttf")) {
   }
 
-  sf::Text hudText;
-  hudText.setFont(font);
-  hudText.setCharacterSize(14);
-  hudText.setFillColor(sf::Color::White);
-  hudText.setPosition(10, 10);
+  Hud hud(font, 14, {10.f, 10.f});
+  RocketHud rocketHud(hud);
+  AppHud appHud(hud);
+
+  // F3: per-phase timings, refreshed twice a second.
+  Hud profileText(font, 14, {560.f, 10.f}, 200.f);
+  ProfileHud profileHud(profileText);
+  bool showProfile = false;
+  sf::Clock profileClock;
+
+  // One rocket is a single chunk: draw it on this thread, spawn no workers.
+  ThreadPool renderPool(1);
+  FleetRenderer fleet(rocket, renderPool);
+  TrajectoryOverlay trajectory(rocket, terrain, 1.f / PHYSICS_HZ);
+
+  // Frames are drawn between the last two physics states, one tick behind
+  // real time.
+  FrameSnapshot current = shared.frames.readBuffer();
+  SteadyClock::time_point lastInputShown;
+  float inputToDisplayMs = 0.f;
+  float fps = 0.f;
+  sf::Clock frameClock;
 
   while (window.isOpen()) {
     sf::Event event;
     while (window.pollEvent(event)) {
       if (event.type == sf::Event::Closed)
         window.close();
-    }
-
-    float dt = clock.restart().asSeconds();
-
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space))
-      rocket.activeBottomBooster();
 
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::A))
-      rocket.activeLeftBooster();
+      // M toggles the autopilot.
+      if (event.type == sf::Event::KeyPressed &&
+          event.key.code == sf::Keyboard::M) {
+        shared.autopilot_requested = !shared.autopilot_requested.load();
+      }
 
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::D))
-      rocket.activeRightBooster();
-
-    const float dOut = 10.0f * dt;
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Up))
-      rocket.controlBottomOutput(+dOut);
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Down))
-      rocket.controlBottomOutput(-dOut);
-
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::K))
-      rocket.controlLeftOutput(+dOut);
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::J))
-      rocket.controlLeftOutput(-dOut);
-
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::P))
-      rocket.controlRightOutput(+dOut);
-    if (sf::Keyboard::isKeyPressed(sf::Keyboard::O))
-      rocket.controlRightOutput(-dOut);
-
-    rocket.updateBoosters(dt);
-    rocket.consumeFuelMass(dt);
+      if (event.type == sf::Event::KeyPressed &&
+          event.key.code == sf::Keyboard::F3) {
+        showProfile = !showProfile;
+      }
+    }
 
-    rocket.update(dt);
+    if (shared.frames.update()) {
+      current = shared.frames.readBuffer();
+      trajectory.update(current.state, current.origin,
+                        static_cast<double>(current.tick) / PHYSICS_HZ);
+    }
 
-    if (rocket.getBounds().intersects(platform.getGlobalBounds())) {
-      const auto vel = rocket.getLenVel();
-      if (vel > 80.)
-        std::cout << "Explodiu\n";
+    const float sinceTick =
+        std::chrono::duration<float>(SteadyClock::now() - current.published)
+            .count();
+    const float alpha = std::clamp(sinceTick * PHYSICS_HZ, 0.f, 1.f);
+    const auto drawn =
+        interpolateState(current.previous_state, current.state, alpha);
+
+    // The render boundary: a view in meters centred on the vehicle, in
+    // the frame of the World origin. The terrain is in its own frame.
+    const sf::View worldView(drawn.pos, {width, height});
+    sf::RenderStates terrainStates;
+    terrainStates.transform.translate(static_cast<float>(-current.origin.x),
+                                      static_cast<float>(-current.origin.y));
+    fleet.update(&drawn, 1, worldView, window.getSize());
+
+    {
+      PROFILE_SCOPE(PROFILE_HUD);
+      rocketHud.update(drawn, current.origin);
+      appHud.update(hud, current, trajectory, inputToDisplayMs, fps);
+      hud.endFrame();
+
+      if (showProfile && profileClock.getElapsedTime().asSeconds() >= 0.5f) {
+        profileClock.restart();
+        profileHud.update();
+      }
+    }
 
-      resolveGroundContact(rocket, platform);
+    {
+      PROFILE_SCOPE(PROFILE_DRAW);
+      window.clear();
+      window.setView(worldView);
+      window.draw(terrainMesh, terrainStates);
+      window.draw(trajectory);
+      window.draw(fleet);
+      window.setView(window.getDefaultView());
+      window.draw(hud);
+      if (showProfile)
+        window.draw(profileText);
+      window.display();
     }
 
-    window.clear();
-    window.draw(rocket);
-    window.draw(platform);
+    if (current.input_sampled != lastInputShown) {
+      lastInputShown = current.input_sampled;
+      inputToDisplayMs = std::chrono::duration<float, std::milli>(
+                             SteadyClock::now() - current.input_sampled)
+                             .count();
+    }
 
-    hudText.setString(rocket.getStatus());
-    window.draw(hudText);
-    window.display();
+    const float frameTime = frameClock.restart().asSeconds();
+    if (frameTime > 0.f)
+      fps += (1.f / frameTime - fps) * 0.05f;
   }
 
+  shared.running = false;
+  physics.join();
+
   return 0;
 }
@@ -0,0 +1,229 @@
+#include "../include/autopilot.hpp"
+#include "../include/profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+Autopilot::Autopilot(const Rocket &prototype, const AutopilotConfig &config)
+    : config(config), pool(config.threads) {
+  workers.reserve(pool.size());
+  for (unsigned i = 0; i < pool.size(); i++) {
+    workers.push_back({prototype, std::mt19937(1234u + i), {}, 0.f});
+  }
+
+  landing_height = getLandingHeight(prototype);
+
+  reset();
+}
+
+void Autopilot::reset() {
+  for (auto &segment : best.segments)
+    segment = {false, false, false, 0.f};
+  plan_time = 0.f;
+
+  stats = {};
+}
+
+ControlInput Autopilot::tick(const Rocket &rocket, float dt,
+                             sf::Vector2<double> origin) {
+  PROFILE_SCOPE(PROFILE_AUTOPILOT);
+  const auto begin = Clock::now();
+  // Leave a little room for the reduction and the thread hand-off.
+  const auto deadline = begin + config.budget * 9 / 10;
+
+  target_x = static_cast<float>(config.target_x - origin.x);
+  ground_y = static_cast<float>(config.ground_y - origin.y);
+
+  const SimState start = rocket.getState();
+  const Plan previous = best;
+
+  std::atomic<int> next{0};
+  std::atomic<int> finished{0};
+
+  pool.run([&](unsigned w) {
+    auto &worker = workers[w];
+    worker.best_cost = std::numeric_limits<float>::infinity();
+
+    for (;;) {
+      const int i = next.fetch_add(1, std::memory_order_relaxed);
+      if (i >= config.max_candidates)
+        return;
+      // The warm start is always evaluated, the rest only while in budget.
+      if (i > 0 && Clock::now() >= deadline)
+        return;
+
+      Plan plan;
+      if (i == 0)
+        plan = previous;
+      else if (i % 2 == 1)
+        plan = mutatePlan(previous, worker.rng);
+      else
+        plan = randomPlan(worker.rng);
+
+      const auto cost = rollout(worker.rocket, start, plan,
+                                i == 0 ? Clock::time_point::max() : deadline);
+      if (!std::isfinite(cost))
+        continue;
+
+      finished.fetch_add(1, std::memory_order_relaxed);
+      if (cost < worker.best_cost) {
+        worker.best_cost = cost;
+        worker.best_plan = plan;
+      }
+    }
+  });
+
+  float best_cost = std::numeric_limits<float>::infinity();
+  for (const auto &worker : workers) {
+    if (worker.best_cost < best_cost) {
+      best_cost = worker.best_cost;
+      best = worker.best_plan;
+    }
+  }
+
+  const float tick_us =
+      std::chrono::duration<float, std::micro>(Clock::now() - begin).count();
+
+  stats.candidates = finished.load();
+  stats.tick_us = tick_us;
+  stats.best_cost = best_cost;
+  stats.ticks++;
+  stats.mean_tick_us += (tick_us - stats.mean_tick_us) / stats.ticks;
+  stats.max_tick_us = std::max(stats.max_tick_us, tick_us);
+  if (tick_us > config.budget.count())
+    stats.overruns++;
+
+  const auto input = toInput(best.segments[0], rocket, dt);
+  shiftPlan(dt);
+
+  return input;
+}
+
+// Receding horizon: drop the segments that are already in the past so the
+// next tick warm starts from the remainder of this plan.
+void Autopilot::shiftPlan(float dt) {
+  plan_time += dt;
+
+  const auto duration = segmentDuration();
+  while (plan_time >= duration) {
+    plan_time -= duration;
+    std::copy(best.segments + 1, best.segments + AUTOPILOT_SEGMENTS,
+              best.segments);
+  }
+}
+
+float Autopilot::rollout(Rocket &rocket, const SimState &start,
+                         const Plan &plan, Clock::time_point deadline) const {
+  rocket.restoreState(start);
+
+  const float h = config.step_dt;
+  const float ground = ground_y - landing_height;
+  const float duration = segmentDuration();
+  float cost = 0.f;
+
+  for (int k = 0; k < config.horizon_steps; k++) {
+    if ((k & 15) == 0 && Clock::now() >= deadline)
+      return std::numeric_limits<float>::infinity();
+
+    // Plans are aligned with the real clock, which is plan_time into the
+    // first segment.
+    const auto index =
+        std::min(static_cast<int>((plan_time + k * h) / duration),
+                 AUTOPILOT_SEGMENTS - 1);
+    stepRocket(rocket, toInput(plan.segments[index], rocket, h), h);
+
+    const auto height = ground - rocket.getPos().y;
+    if (height <= 0.f)
+      return cost + touchdownCost(rocket);
+
+    // Keep the vehicle upright on the way down.
+    const auto angle = rocket.getAngle();
+    cost += h * 0.0556f * angle * angle;
+  }
+
+  return cost + terminalCost(rocket, ground - rocket.getPos().y);
+}
+
+float Autopilot::touchdownCost(const Rocket &rocket) const {
+  const auto &vel = rocket.getVel();
+  const auto &pos = rocket.getPos();
+  const auto angle = rocket.getAngle();
+  const auto angVel = rocket.getAngularVel();
+
+  const auto speed_sqr = vel.x * vel.x + vel.y * vel.y;
+  const auto dx = pos.x - target_x;
+
+  float cost = speed_sqr + 0.05f * dx * dx + 0.556f * angle * angle +
+               0.0556f * angVel * angVel;
+
+  if (speed_sqr > config.safe_speed * config.safe_speed)
+    cost += 28.f;
+
+  return cost;
+}
+
+float Autopilot::terminalCost(const Rocket &rocket, float height) const {
+  const auto &vel = rocket.getVel();
+  const auto &pos = rocket.getPos();
+  const auto angle = rocket.getAngle();
+  const auto angVel = rocket.getAngularVel();
+
+  // Descent rate that shrinks with height, like a suicide burn profile.
+  const auto vy_target =
+      std::min(config.safe_speed * 0.5f + 0.5f * height, 3.333f);
+  const auto dvy = vel.y - vy_target;
+  const auto dx = pos.x - target_x;
+
+  return dvy * dvy + vel.x * vel.x + 0.05f * dx * dx + 0.05f * height * height +
+         0.556f * angle * angle + 0.0556f * angVel * angVel;
+}
+
+Plan Autopilot::randomPlan(std::mt19937 &rng) const {
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  std::uniform_real_distribution<float> throttle(0.f, config.max_throttle);
+
+  Plan plan;
+  for (auto &segment : plan.segments) {
+    segment.bottom = unit(rng) < 0.5f;
+    const auto side = unit(rng);
+    segment.left = side < 0.15f;
+    segment.right = side > 0.85f;
+    segment.throttle = throttle(rng);
+  }
+
+  return plan;
+}
+
+Plan Autopilot::mutatePlan(const Plan &plan, std::mt19937 &rng) const {
+  std::uniform_real_distribution<float> unit(0.f, 1.f);
+  std::normal_distribution<float> noise(0.f, config.max_throttle * 0.1f);
+
+  Plan mutated = plan;
+  for (auto &segment : mutated.segments) {
+    if (unit(rng) < 0.2f)
+      segment.bottom = !segment.bottom;
+    if (unit(rng) < 0.1f)
+      segment.left = !segment.left;
+    if (unit(rng) < 0.1f)
+      segment.right = !segment.right;
+
+    segment.throttle =
+        std::clamp(segment.throttle + noise(rng), 0.f, config.max_throttle);
+  }
+
+  return mutated;
+}
+
+ControlInput Autopilot::toInput(const PlanSegment &segment,
+                                const Rocket &rocket, float dt) const {
+  const auto max_delta = config.max_throttle_rate * dt;
+  const auto error =
+      segment.throttle - rocket.getBottomBooster().target_output;
+
+  ControlInput input;
+  input.bottom = segment.bottom;
+  input.left = segment.left;
+  input.right = segment.right;
+  input.dBottomOut = std::clamp(error, -max_delta, max_delta);
+  return input;
+}
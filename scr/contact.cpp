@@ -0,0 +1,699 @@
+#include "../include/contact.hpp"
+#include "../include/profiler.hpp"
+#include "../include/simulation.hpp"
+
+#include <SFML/Graphics/Transform.hpp>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+sf::Vector2f rotate(const sf::Vector2f &v, float c, float s) {
+  return {c * v.x - s * v.y, s * v.x + c * v.y};
+}
+
+// Inverse rotation.
+sf::Vector2f unrotate(const sf::Vector2f &v, float c, float s) {
+  return {c * v.x + s * v.y, -s * v.x + c * v.y};
+}
+
+// Fraction of the segment a -> b where it enters the box [min, max], above 1
+// when it misses (slab test).
+float segmentEntry(const sf::Vector2f &a, const sf::Vector2f &b,
+                   const sf::Vector2f &min, const sf::Vector2f &max) {
+  float enter = 0.f, exit = 1.f;
+
+  const float from[2] = {a.x, a.y};
+  const float delta[2] = {b.x - a.x, b.y - a.y};
+  const float lo[2] = {min.x, min.y};
+  const float hi[2] = {max.x, max.y};
+
+  for (int axis = 0; axis < 2; axis++) {
+    if (std::abs(delta[axis]) < 1e-9f) {
+      if (from[axis] <= lo[axis] || from[axis] >= hi[axis])
+        return 2.f;
+      continue;
+    }
+
+    float t0 = (lo[axis] - from[axis]) / delta[axis];
+    float t1 = (hi[axis] - from[axis]) / delta[axis];
+    if (t0 > t1)
+      std::swap(t0, t1);
+
+    enter = std::max(enter, t0);
+    exit = std::min(exit, t1);
+    if (enter > exit)
+      return 2.f;
+  }
+
+  return enter;
+}
+
+bool inside(const sf::Vector2f &p, const sf::Vector2f &min,
+            const sf::Vector2f &max) {
+  return p.x > min.x && p.x < max.x && p.y > min.y && p.y < max.y;
+}
+
+// Same as Rocket::getTransform() for a saved pose.
+sf::Transform poseTransform(const SimState &state) {
+  return designToWorld(state.pos, std::cos(state.angle),
+                       std::sin(state.angle), state.rocket_prop.r_cm);
+}
+
+// Splits the per tick output deltas of a command over a fraction of the tick.
+ControlInput scaleInput(ControlInput input, float fraction) {
+  input.dBottomOut *= fraction;
+  input.dLeftOut *= fraction;
+  input.dRightOut *= fraction;
+  input.dBottomAe *= fraction;
+  input.dLeftAe *= fraction;
+  input.dRightAe *= fraction;
+  return input;
+}
+
+} // namespace
+
+ContactSolver::ContactSolver(const Rocket &prototype) {
+  const auto g = prototype.getGeometry();
+  const float w = g.rocket_width;
+  const float h = g.body_height;
+
+  parts.push_back({{0.f, 0.f}, {w, h}});
+  parts.push_back({g.left_thruster, g.left_thruster + g.side_thruster_size});
+  parts.push_back({g.right_thruster, g.right_thruster + g.side_thruster_size});
+  parts.push_back(
+      {g.bottom_thruster, g.bottom_thruster + g.bottom_thruster_size});
+
+  for (const auto &part : parts) {
+    hull.push_back(part.min);
+    hull.push_back({part.max.x, part.min.y});
+    hull.push_back(part.max);
+    hull.push_back({part.min.x, part.max.y});
+  }
+  // The nose base sits on the body corners, only its tip is new.
+  hull.push_back({w / 2.f, -g.nose_height});
+
+  const auto cm = prototype.getCm();
+  for (const auto &v : hull)
+    hull_radius = std::max(hull_radius, std::sqrt(dot(v - cm, v - cm)));
+}
+
+sf::FloatRect ContactSolver::hullBounds(const sf::Transform &transform) const {
+  const auto first = transform.transformPoint(hull[0]);
+  sf::Vector2f min = first, max = first;
+
+  for (const auto &v : hull) {
+    const auto w = transform.transformPoint(v);
+    min = {std::min(min.x, w.x), std::min(min.y, w.y)};
+    max = {std::max(max.x, w.x), std::max(max.y, w.y)};
+  }
+  return {min, max - min};
+}
+
+const StaticGrid &ContactSolver::broadphase() const {
+  if (grid_dirty) {
+    std::vector<sf::FloatRect> bounds(statics.size());
+    for (std::size_t i = 0; i < statics.size(); i++) {
+      const auto &box = statics[i];
+      const float c = std::abs(std::cos(box.angle));
+      const float s = std::abs(std::sin(box.angle));
+      const sf::Vector2f extent = {c * box.half.x + s * box.half.y,
+                                   s * box.half.x + c * box.half.y};
+      bounds[i] = {box.center - extent, extent * 2.f};
+    }
+
+    grid.build(bounds);
+    grid_dirty = false;
+  }
+  return grid;
+}
+
+void ContactSolver::setTerrain(const Terrain &terrain) {
+  this->terrain = &terrain;
+  for (const auto &pad : terrain.getPads())
+    addStatic(StaticBox::fromRect(pad));
+}
+
+void ContactSolver::collide(const Rocket &rocket,
+                            ContactManifold &out) const {
+  out.count = 0;
+
+  const sf::Transform transform = toStatics(rocket.getTransform());
+  const sf::Transform inverse = transform.getInverse();
+  const auto area = hullBounds(transform);
+
+  broadphase().query(area, [&](std::uint32_t b) {
+    collideBox(b, transform, inverse, out);
+  });
+
+  if (terrain && !terrain->empty())
+    collideTerrain(transform, inverse, area, out);
+
+  for (int i = 0; i < out.count; i++)
+    out.points[i].point -= origin;
+}
+
+sf::Transform ContactSolver::toStatics(const sf::Transform &pose) const {
+  sf::Transform transform;
+  transform.translate(origin.x, origin.y);
+  return transform * pose;
+}
+
+void ContactSolver::collideBox(std::uint32_t b, const sf::Transform &transform,
+                               const sf::Transform &inverse,
+                               ContactManifold &out) const {
+  const auto &box = statics[b];
+  const float c = std::cos(box.angle);
+  const float s = std::sin(box.angle);
+
+  // Hull vertices inside the box: push out along the shallowest box axis.
+  for (std::uint32_t v = 0; v < hull.size(); v++) {
+    if (out.count == MAX_CONTACTS)
+      return;
+
+    const auto world = transform.transformPoint(hull[v]);
+    const auto local = unrotate(world - box.center, c, s);
+
+    const float px = box.half.x - std::abs(local.x);
+    const float py = box.half.y - std::abs(local.y);
+    if (px <= 0.f || py <= 0.f)
+      continue;
+
+    sf::Vector2f normal;
+    float penetration;
+    if (py <= px) {
+      normal = {0.f, local.y < 0.f ? -1.f : 1.f};
+      penetration = py;
+    } else {
+      normal = {local.x < 0.f ? -1.f : 1.f, 0.f};
+      penetration = px;
+    }
+
+    auto &contact = out.points[out.count++];
+    contact = {};
+    contact.point = world;
+    contact.normal = rotate(normal, c, s);
+    contact.penetration = penetration;
+    contact.id = FEATURE_BOX_VERTEX | b << 8 | v;
+    contact.friction = box.friction;
+    contact.restitution = box.restitution;
+  }
+
+  // Box corners inside a hull part (landing on a pad edge).
+  for (std::uint32_t k = 0; k < 4; k++) {
+    const sf::Vector2f corner_local = {(k & 1) ? box.half.x : -box.half.x,
+                                       (k & 2) ? box.half.y : -box.half.y};
+    const auto world = box.center + rotate(corner_local, c, s);
+
+    float depth;
+    sf::Vector2f normal;
+    const int p = pointInParts(world, transform, inverse, depth, normal);
+    if (p < 0 || out.count == MAX_CONTACTS)
+      continue;
+
+    auto &contact = out.points[out.count++];
+    contact = {};
+    contact.point = world;
+    contact.normal = normal;
+    contact.penetration = depth;
+    contact.id = FEATURE_BOX_CORNER | b << 8 | k << 4 | p;
+    contact.friction = box.friction;
+    contact.restitution = box.restitution;
+  }
+}
+
+void ContactSolver::collideTerrain(const sf::Transform &transform,
+                                   const sf::Transform &inverse,
+                                   const sf::FloatRect &area,
+                                   ContactManifold &out) const {
+  const auto &points = terrain->getPoints();
+
+  // Hull vertices below the ground, pushed out along the segment normal.
+  // The ground ends at the first and last point.
+  for (std::uint32_t v = 0; v < hull.size(); v++) {
+    if (out.count == MAX_CONTACTS)
+      return;
+
+    const auto world = transform.transformPoint(hull[v]);
+    if (world.x < points.front().x || world.x > points.back().x)
+      continue;
+
+    std::size_t first, last;
+    terrain->segmentRange(world.x, world.x, first, last);
+    const auto segment = terrain->getSegment(first);
+    const auto d = segment.b - segment.a;
+    const float len = std::sqrt(dot(d, d));
+
+    const float ground = segment.a.y + d.y * (world.x - segment.a.x) / d.x;
+    if (world.y <= ground)
+      continue;
+
+    auto &contact = out.points[out.count++];
+    contact = {};
+    contact.point = world;
+    contact.normal = sf::Vector2f(d.y, -d.x) / len;
+    contact.penetration = (world.y - ground) * d.x / len;
+    contact.id = FEATURE_TERRAIN_VERTEX | v;
+    contact.friction = terrain->friction;
+    contact.restitution = terrain->restitution;
+  }
+
+  // Ground points inside a hull part (a ridge under the body). A dense
+  // heightfield puts many of them in one part, so only the deepest counts.
+  float deepest[MAX_HULL_PARTS] = {};
+  sf::Vector2f deepest_normal[MAX_HULL_PARTS];
+  sf::Vector2f deepest_point[MAX_HULL_PARTS];
+
+  std::size_t first, last;
+  terrain->pointRange(area.left, area.left + area.width, first, last);
+  for (auto i = first; i < last; i++) {
+    if (points[i].y < area.top || points[i].y > area.top + area.height)
+      continue;
+
+    float depth;
+    sf::Vector2f normal;
+    const int p = pointInParts(points[i], transform, inverse, depth, normal);
+    if (p >= 0 && depth > deepest[p]) {
+      deepest[p] = depth;
+      deepest_normal[p] = normal;
+      deepest_point[p] = points[i];
+    }
+  }
+
+  for (std::uint32_t p = 0; p < parts.size(); p++) {
+    if (deepest[p] <= 0.f || out.count == MAX_CONTACTS)
+      continue;
+
+    auto &contact = out.points[out.count++];
+    contact = {};
+    contact.point = deepest_point[p];
+    contact.normal = deepest_normal[p];
+    contact.penetration = deepest[p];
+    contact.id = FEATURE_TERRAIN_POINT | p;
+    contact.friction = terrain->friction;
+    contact.restitution = terrain->restitution;
+  }
+}
+
+int ContactSolver::pointInParts(const sf::Vector2f &world,
+                                const sf::Transform &transform,
+                                const sf::Transform &inverse, float &depth,
+                                sf::Vector2f &normal) const {
+  // Pushed out along the shallowest face of the part, reversed, so the
+  // normal points from the static point to the rocket.
+  const auto design = inverse.transformPoint(world);
+
+  for (std::size_t p = 0; p < parts.size(); p++) {
+    const auto &part = parts[p];
+    if (!inside(design, part.min, part.max))
+      continue;
+
+    const float d[4] = {design.x - part.min.x, part.max.x - design.x,
+                        design.y - part.min.y, part.max.y - design.y};
+    const sf::Vector2f faces[4] = {
+        {-1.f, 0.f}, {1.f, 0.f}, {0.f, -1.f}, {0.f, 1.f}};
+    const int f = static_cast<int>(std::min_element(d, d + 4) - d);
+
+    depth = d[f];
+    normal = transform.transformPoint({0.f, 0.f}) -
+             transform.transformPoint(faces[f]);
+    return static_cast<int>(p);
+  }
+
+  return -1;
+}
+
+void ContactSolver::prepare(const Rocket &rocket, float) {
+  const float inv_mass = 1.f / rocket.getMass();
+  const float inv_I = 1.f / rocket.getInertia();
+  const auto cm = rocket.getPos();
+  const auto &v = rocket.getVel();
+  const float w = rocket.getAngularVel();
+
+  for (int i = 0; i < manifold.count; i++) {
+    auto &c = manifold.points[i];
+    const sf::Vector2f t(-c.normal.y, c.normal.x);
+
+    c.r = c.point - cm;
+
+    const float rn = cross(c.r, c.normal);
+    const float rt = cross(c.r, t);
+    c.normal_mass = 1.f / (inv_mass + rn * rn * inv_I);
+    c.tangent_mass = 1.f / (inv_mass + rt * rt * inv_I);
+
+    // Bounce only on real impacts.
+    c.bias = 0.f;
+    const float vn = dot(v + cross(w, c.r), c.normal);
+    if (vn < -restitution_speed)
+      c.bias = -c.restitution * vn;
+  }
+
+  // Pair contacts sharing a normal (a flat base on a pad) so they are
+  // solved together; one at a time, the first one hit tips the rocket.
+  for (int i = 0; i < manifold.count; i++)
+    partner[i] = -1;
+
+  for (int i = 0; i < manifold.count; i++) {
+    if (partner[i] >= 0)
+      continue;
+
+    for (int j = i + 1; j < manifold.count; j++) {
+      if (partner[j] >= 0 ||
+          dot(manifold.points[i].normal, manifold.points[j].normal) < 0.999f)
+        continue;
+
+      // Nearly coincident points make the block singular.
+      const auto d = manifold.points[i].r - manifold.points[j].r;
+      if (dot(d, d) < 2.5e-4f)
+        continue;
+
+      partner[i] = j;
+      partner[j] = i;
+      break;
+    }
+  }
+}
+
+void ContactSolver::solveNormalPair(Rocket &rocket, ContactPoint &c1,
+                                    ContactPoint &c2) const {
+  // Block solve of both non-penetration constraints as a 2x2 LCP, trying
+  // each active set in turn (both, only c1, only c2, none).
+  const float inv_mass = 1.f / rocket.getMass();
+  const float inv_I = 1.f / rocket.getInertia();
+  const auto &n = c1.normal;
+
+  const float rn1 = cross(c1.r, n);
+  const float rn2 = cross(c2.r, n);
+  const float k11 = inv_mass + inv_I * rn1 * rn1;
+  const float k22 = inv_mass + inv_I * rn2 * rn2;
+  const float k12 = inv_mass + inv_I * rn1 * rn2;
+  const float det = k11 * k22 - k12 * k12;
+
+  const auto &v = rocket.getVel();
+  const float w = rocket.getAngularVel();
+  const float vn1 = dot(v + cross(w, c1.r), n);
+  const float vn2 = dot(v + cross(w, c2.r), n);
+
+  const float a1 = c1.normal_impulse;
+  const float a2 = c2.normal_impulse;
+  const float b1 = vn1 - c1.bias - (k11 * a1 + k12 * a2);
+  const float b2 = vn2 - c2.bias - (k12 * a1 + k22 * a2);
+
+  float x1 = 0.f, x2 = 0.f;
+  if (det > 1e-3f * k11 * k11 && (x1 = (-k22 * b1 + k12 * b2) / det) >= 0.f &&
+      (x2 = (k12 * b1 - k11 * b2) / det) >= 0.f) {
+  } else if ((x1 = -b1 / k11) >= 0.f && k12 * x1 + b2 >= 0.f) {
+    x2 = 0.f;
+  } else if ((x2 = -b2 / k22) >= 0.f && k12 * x2 + b1 >= 0.f) {
+    x1 = 0.f;
+  } else {
+    x1 = x2 = 0.f;
+  }
+
+  c1.normal_impulse = x1;
+  c2.normal_impulse = x2;
+  applyImpulse(rocket, c1, n * (x1 - a1));
+  applyImpulse(rocket, c2, n * (x2 - a2));
+}
+
+void ContactSolver::applyImpulse(Rocket &rocket, const ContactPoint &c,
+                                 const sf::Vector2f &impulse) const {
+  rocket.applyVel(impulse / rocket.getMass());
+  rocket.applyAngVel(cross(c.r, impulse) / rocket.getInertia());
+}
+
+void ContactSolver::warmStart(Rocket &rocket) {
+  for (int i = 0; i < manifold.count; i++) {
+    auto &c = manifold.points[i];
+
+    for (int j = 0; j < previous.count; j++) {
+      if (previous.points[j].id != c.id)
+        continue;
+
+      c.normal_impulse = previous.points[j].normal_impulse;
+      c.tangent_impulse = previous.points[j].tangent_impulse;
+
+      const sf::Vector2f t(-c.normal.y, c.normal.x);
+      applyImpulse(rocket, c, c.normal * c.normal_impulse +
+                                  t * c.tangent_impulse);
+      break;
+    }
+  }
+}
+
+bool ContactSolver::solve(Rocket &rocket, float dt) {
+  PROFILE_SCOPE(PROFILE_CONTACTS);
+  previous = manifold;
+  collide(rocket, manifold);
+
+  if (manifold.count == 0)
+    return false;
+
+  if (rocket.getMass() <= 1e-6f || rocket.getInertia() <= 1e-6f)
+    return true;
+
+  prepare(rocket, dt);
+  warmStart(rocket);
+
+  relax(rocket, iterations);
+
+  correctPositions(rocket);
+
+  return true;
+}
+
+void ContactSolver::relax(Rocket &rocket, int count) {
+  for (int it = 0; it < count; it++) {
+    // Friction first, bounded by the normal impulse of the last iteration.
+    for (int i = 0; i < manifold.count; i++) {
+      auto &c = manifold.points[i];
+      const sf::Vector2f t(-c.normal.y, c.normal.x);
+
+      const auto dv = rocket.getVel() + cross(rocket.getAngularVel(), c.r);
+      const float vt = dot(dv, t);
+      float dPt = -c.tangent_mass * vt;
+
+      const float maxPt = c.friction * c.normal_impulse;
+      const float Pt = std::clamp(c.tangent_impulse + dPt, -maxPt, maxPt);
+      dPt = Pt - c.tangent_impulse;
+      c.tangent_impulse = Pt;
+      applyImpulse(rocket, c, t * dPt);
+    }
+
+    // Normal: accumulated impulse never pulls.
+    for (int i = 0; i < manifold.count; i++) {
+      if (partner[i] >= 0) {
+        if (partner[i] > i)
+          solveNormalPair(rocket, manifold.points[i],
+                          manifold.points[partner[i]]);
+        continue;
+      }
+
+      auto &c = manifold.points[i];
+      const auto dv = rocket.getVel() + cross(rocket.getAngularVel(), c.r);
+      const float vn = dot(dv, c.normal);
+      float dPn = c.normal_mass * (-vn + c.bias);
+
+      const float Pn = std::max(c.normal_impulse + dPn, 0.f);
+      dPn = Pn - c.normal_impulse;
+      c.normal_impulse = Pn;
+      applyImpulse(rocket, c, c.normal * dPn);
+    }
+  }
+}
+
+void ContactSolver::correctPositions(Rocket &rocket) const {
+  // Translation only: contacts sharing a normal then get the same
+  // correction whatever the order, so symmetric resting stays symmetric.
+  sf::Vector2f dPos = {0.f, 0.f};
+
+  for (int it = 0; it < position_iterations; it++) {
+    for (int i = 0; i < manifold.count; i++) {
+      const auto &c = manifold.points[i];
+
+      const float C = c.penetration - dot(dPos, c.normal) - slop;
+      if (C > 0.f)
+        dPos += c.normal * (position_correction * C);
+    }
+  }
+
+  rocket.applyPos(dPos);
+}
+
+float ContactSolver::timeOfImpact(const SimState &start, const Rocket &rocket,
+                                  float *contact_travel) const {
+  PROFILE_SCOPE(PROFILE_SWEEP);
+  // Features move on straight lines between the two poses, which holds for
+  // the small rotations of one tick.
+  const sf::Transform from = toStatics(poseTransform(start));
+  const sf::Transform to = toStatics(rocket.getTransform());
+  const sf::Transform from_inverse = from.getInverse();
+  const sf::Transform to_inverse = to.getInverse();
+
+  // Swept hull bounds, for the broadphase.
+  const auto a_bounds = hullBounds(from);
+  const auto b_bounds = hullBounds(to);
+  const sf::Vector2f area_min = {std::min(a_bounds.left, b_bounds.left),
+                                 std::min(a_bounds.top, b_bounds.top)};
+  const sf::Vector2f area_max = {
+      std::max(a_bounds.left + a_bounds.width, b_bounds.left + b_bounds.width),
+      std::max(a_bounds.top + a_bounds.height,
+               b_bounds.top + b_bounds.height)};
+  const sf::FloatRect area(area_min, area_max - area_min);
+
+  float toi = 2.f;
+  float travel = 0.f;
+
+  const auto distance = [](const sf::Vector2f &a, const sf::Vector2f &b) {
+    return std::sqrt(dot(b - a, b - a));
+  };
+
+  // A static point (box corner, ground point) against the hull parts.
+  const auto sweepPoint = [&](const sf::Vector2f &world) {
+    const auto a = from_inverse.transformPoint(world);
+    const auto b = to_inverse.transformPoint(world);
+
+    for (const auto &part : parts) {
+      if (inside(a, part.min, part.max)) {
+        travel = std::max(travel, distance(a, b));
+        continue;
+      }
+
+      toi = std::min(toi, segmentEntry(a, b, part.min, part.max));
+    }
+  };
+
+  broadphase().query(area, [&](std::uint32_t i) {
+    const auto &box = statics[i];
+    const float c = std::cos(box.angle);
+    const float s = std::sin(box.angle);
+
+    for (const auto &v : hull) {
+      const auto a = unrotate(from.transformPoint(v) - box.center, c, s);
+      const auto b = unrotate(to.transformPoint(v) - box.center, c, s);
+      if (inside(a, -box.half, box.half)) {
+        travel = std::max(travel, distance(a, b));
+        continue;
+      }
+
+      toi = std::min(toi, segmentEntry(a, b, -box.half, box.half));
+    }
+
+    for (std::uint32_t k = 0; k < 4; k++) {
+      const sf::Vector2f corner_local = {(k & 1) ? box.half.x : -box.half.x,
+                                         (k & 2) ? box.half.y : -box.half.y};
+      sweepPoint(box.center + rotate(corner_local, c, s));
+    }
+  });
+
+  if (terrain && !terrain->empty()) {
+    const auto &points = terrain->getPoints();
+
+    // Hull vertex paths against the ground segments they span.
+    for (const auto &v : hull) {
+      const auto a = from.transformPoint(v);
+      const auto b = to.transformPoint(v);
+
+      if (a.x >= points.front().x && a.x <= points.back().x &&
+          a.y > terrain->groundAt(a.x)) {
+        travel = std::max(travel, distance(a, b));
+        continue;
+      }
+
+      const auto d = b - a;
+      std::size_t first, last;
+      terrain->segmentRange(std::min(a.x, b.x), std::max(a.x, b.x), first,
+                            last);
+      for (auto i = first; i < last; i++) {
+        const auto segment = terrain->getSegment(i);
+        const auto e = segment.b - segment.a;
+        const float denom = cross(d, e);
+        if (std::abs(denom) < 1e-9f)
+          continue;
+
+        const auto w = segment.a - a;
+        const float t = cross(w, e) / denom;
+        const float u = cross(w, d) / denom;
+        if (t >= 0.f && t <= 1.f && u >= 0.f && u <= 1.f)
+          toi = std::min(toi, t);
+      }
+    }
+
+    std::size_t first, last;
+    terrain->pointRange(area.left, area.left + area.width, first, last);
+    for (auto i = first; i < last; i++)
+      if (points[i].y >= area.top && points[i].y <= area.top + area.height)
+        sweepPoint(points[i]);
+  }
+
+  if (contact_travel)
+    *contact_travel = travel;
+  return toi;
+}
+
+SweptStep ContactSolver::step(Rocket &rocket, const ControlInput &input,
+                              float dt) {
+  SweptStep result;
+
+  const auto resolve = [&](float h) {
+    result.substeps++;
+
+    const auto len_vel = rocket.getLenVel();
+    if (solve(rocket, h) && !result.touched) {
+      result.touched = true;
+      result.impact_len_vel = len_vel;
+    }
+  };
+  const auto advance = [&](float h) {
+    stepRocket(rocket, scaleInput(input, h / dt), h);
+    resolve(h);
+  };
+
+  float remaining = dt;
+  while (remaining > 0.f && result.substeps < max_substeps) {
+    rocket.saveState(start);
+    stepRocket(rocket, scaleInput(input, remaining / dt), remaining);
+
+    // Resting contacts also need sub-steps when a coarse step moves them
+    // further than the solver can push back (past the middle of a thin pad
+    // the push out direction flips).
+    float travel;
+    const float toi = timeOfImpact(start, rocket, &travel);
+    if (toi > 1.f && travel <= substep_travel) {
+      // Nothing hit: keep the step, only resting contacts to solve.
+      resolve(remaining);
+      return result;
+    }
+
+    // Fastest hull point, to size the step into a new contact.
+    const float speed = std::sqrt(rocket.getLenVel()) +
+                        std::abs(rocket.getAngularVel()) * hull_radius;
+
+    rocket.restoreState(start);
+
+    // Touching features may only move the allowed travel, a bound that holds
+    // whether their motion comes from speed or from gravity.
+    float h = travel > substep_travel ? remaining * substep_travel / travel
+                                      : remaining;
+
+    if (toi <= 1.f && toi * remaining < h) {
+      // Hit: replay straight to the impact, then a step short enough for
+      // the fastest hull point to only just enter the contact.
+      if (toi > 0.f) {
+        advance(toi * remaining);
+        remaining -= toi * remaining;
+      }
+      h = std::min(h, substep_travel / std::max(speed, 0.01f));
+    }
+
+    h = std::min(h, remaining);
+    advance(h);
+    remaining -= h;
+  }
+
+  // Sub-step budget spent: finish the tick in one go.
+  if (remaining > 0.f)
+    advance(remaining);
+
+  return result;
+}
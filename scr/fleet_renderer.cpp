@@ -0,0 +1,157 @@
+#include "../include/fleet_renderer.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr std::size_t CHUNK = 256;
+
+struct Pose {
+  float c, s;
+  sf::Vector2f pos, cm;
+
+  sf::Vector2f apply(const sf::Vector2f &p) const {
+    const float dx = p.x - cm.x;
+    const float dy = p.y - cm.y;
+    return {pos.x + c * dx - s * dy, pos.y + s * dx + c * dy};
+  }
+};
+
+Pose getPose(const SimState &state) {
+  return {std::cos(state.angle), std::sin(state.angle), state.pos,
+          state.rocket_prop.r_cm};
+}
+
+} // namespace
+
+FleetRenderer::FleetRenderer(const Rocket &prototype, ThreadPool &pool)
+    : pool(pool) {
+  const auto g = prototype.getGeometry();
+  const auto c = prototype.getColors();
+
+  const float w = g.rocket_width;
+  const float h = g.body_height;
+  const float n = g.nose_height;
+
+  // Same parts and placement as Rocket::draw().
+  addRect({0.f, 0.f}, {w, h}, c.body);
+  addTriangle({0.f, 0.f}, {w, 0.f}, {w / 2.f, -n}, c.nose);
+  addRect(g.left_thruster, g.side_thruster_size, c.thrusters);
+  addRect(g.right_thruster, g.side_thruster_size, c.thrusters);
+  addRect(g.bottom_thruster, g.bottom_thruster_size, c.thrusters);
+
+  nose_tip = {w / 2.f, -n};
+  bottom_center = {w / 2.f, h + g.bottom_thruster_size.y};
+  nose_color = c.nose;
+  body_color = c.body;
+  height = bottom_center.y - nose_tip.y;
+
+  // Any CM lies inside the design, so the diagonal bounds every vertex.
+  float left = 0.f, top = 0.f, right = 0.f, bottom = 0.f;
+  for (const auto &p : local) {
+    left = std::min(left, p.x);
+    right = std::max(right, p.x);
+    top = std::min(top, p.y);
+    bottom = std::max(bottom, p.y);
+  }
+  radius = std::hypot(right - left, bottom - top);
+}
+
+void FleetRenderer::addRect(sf::Vector2f pos, sf::Vector2f size,
+                            const sf::Color &color) {
+  const sf::Vector2f a = pos;
+  const sf::Vector2f b = {pos.x + size.x, pos.y};
+  const sf::Vector2f c = pos + size;
+  const sf::Vector2f d = {pos.x, pos.y + size.y};
+
+  addTriangle(a, b, c, color);
+  addTriangle(a, c, d, color);
+}
+
+void FleetRenderer::addTriangle(sf::Vector2f a, sf::Vector2f b,
+                                sf::Vector2f c, const sf::Color &color) {
+  local.insert(local.end(), {a, b, c});
+  colors.insert(colors.end(), {color, color, color});
+}
+
+void FleetRenderer::update(const SimState *states, std::size_t count,
+                           const sf::View &view,
+                           const sf::Vector2u &target_size) {
+  const float pixels_per_unit = target_size.y / view.getSize().y;
+  const float on_screen = height * pixels_per_unit;
+
+  sf::PrimitiveType type = sf::Triangles;
+  std::size_t per_rocket = local.size();
+  lod = Lod::Full;
+  if (on_screen < lod_point_px) {
+    lod = Lod::Point;
+    type = sf::Points;
+    per_rocket = 1;
+  } else if (on_screen < lod_line_px) {
+    lod = Lod::Line;
+    type = sf::Lines;
+    per_rocket = 2;
+  }
+
+  const auto center = view.getCenter();
+  const auto half = view.getSize() / 2.f;
+  const float min_x = center.x - half.x - radius;
+  const float max_x = center.x + half.x + radius;
+  const float min_y = center.y - half.y - radius;
+  const float max_y = center.y + half.y + radius;
+
+  // Pass 1: cull each chunk in parallel and compact its visible indices.
+  const std::size_t chunks = (count + CHUNK - 1) / CHUNK;
+  chunk_counts.resize(chunks);
+  chunk_offsets.resize(chunks);
+  visible_index.resize(count);
+
+  pool.parallelFor(chunks, [&](std::size_t chunk, unsigned) {
+    const std::size_t begin = chunk * CHUNK;
+    const std::size_t end = std::min(count, begin + CHUNK);
+
+    std::size_t n = begin;
+    for (std::size_t i = begin; i < end; i++) {
+      const auto &p = states[i].pos;
+      if (p.x >= min_x && p.x <= max_x && p.y >= min_y && p.y <= max_y)
+        visible_index[n++] = static_cast<std::uint32_t>(i);
+    }
+    chunk_counts[chunk] = n - begin;
+  });
+
+  visible = 0;
+  for (std::size_t chunk = 0; chunk < chunks; chunk++) {
+    chunk_offsets[chunk] = visible;
+    visible += chunk_counts[chunk];
+  }
+
+  vertices.setPrimitiveType(type);
+  vertices.resize(visible * per_rocket);
+
+  // Pass 2: transform the visible rockets straight into the vertex array.
+  pool.parallelFor(chunks, [&](std::size_t chunk, unsigned) {
+    const std::size_t begin = chunk * CHUNK;
+    std::size_t out = chunk_offsets[chunk] * per_rocket;
+
+    for (std::size_t k = begin; k < begin + chunk_counts[chunk]; k++) {
+      const auto pose = getPose(states[visible_index[k]]);
+
+      switch (lod) {
+      case Lod::Full:
+        for (std::size_t v = 0; v < local.size(); v++) {
+          vertices[out] = sf::Vertex(pose.apply(local[v]), colors[v]);
+          out++;
+        }
+        break;
+      case Lod::Line:
+        vertices[out++] = sf::Vertex(pose.apply(nose_tip), nose_color);
+        vertices[out++] = sf::Vertex(pose.apply(bottom_center), body_color);
+        break;
+      case Lod::Point:
+        vertices[out++] = sf::Vertex(pose.pos, body_color);
+        break;
+      }
+    }
+  });
+}
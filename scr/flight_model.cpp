@@ -0,0 +1,88 @@
+#include "../include/flight_model.hpp"
+
+FlightModel::FlightModel(Precision precision, const Rocket &rocket) {
+  if (precision == Precision::DOUBLE)
+    model.emplace<RocketModel<double>>(rocket);
+  else if (precision == Precision::FIXED)
+    model.emplace<RocketModel<Fixed>>(rocket);
+}
+
+Precision FlightModel::getPrecision() const {
+  if (std::holds_alternative<RocketModel<double>>(model))
+    return Precision::DOUBLE;
+  if (std::holds_alternative<RocketModel<Fixed>>(model))
+    return Precision::FIXED;
+  return Precision::FLOAT;
+}
+
+void FlightModel::sync(const Rocket &rocket) {
+  std::visit(
+      [&](auto &model) {
+        using Model = std::decay_t<decltype(model)>;
+        if constexpr (!std::is_same_v<Model, std::monostate>)
+          model = Model(rocket);
+      },
+      model);
+}
+
+void FlightModel::shift(sf::Vector2f shift) {
+  std::visit(
+      [&](auto &model) {
+        using Model = std::decay_t<decltype(model)>;
+        if constexpr (!std::is_same_v<Model, std::monostate>) {
+          using S = std::decay_t<decltype(model.mass)>;
+          model.pos.x -= S(shift.x);
+          model.pos.y -= S(shift.y);
+        }
+      },
+      model);
+}
+
+SweptStep FlightModel::step(ContactSolver &contacts, Rocket &rocket,
+                            const ControlInput &input, float dt) {
+  return std::visit(
+      [&](auto &model) {
+        using Model = std::decay_t<decltype(model)>;
+        if constexpr (std::is_same_v<Model, std::monostate>)
+          return contacts.step(rocket, input, dt);
+        else
+          return fly(model, contacts, rocket, input, dt);
+      },
+      model);
+}
+
+template <typename S>
+SweptStep FlightModel::fly(RocketModel<S> &model, ContactSolver &contacts,
+                           Rocket &rocket, const ControlInput &input,
+                           float dt) {
+  const auto wind = rocket.getWind();
+  model.wind = {Constant<S>(wind.x), Constant<S>(wind.y)};
+
+  SimState start, mirror;
+  rocket.saveState(start);
+  stepRocket(model, input, Constant<S>(dt));
+  model.saveState(mirror);
+  rocket.restoreState(mirror);
+
+  // As ContactSolver::step() for a tick that hits nothing.
+  float travel;
+  if (contacts.timeOfImpact(start, rocket, &travel) > 1.f &&
+      travel <= contacts.substep_travel) {
+    SweptStep result;
+    result.substeps = 1;
+
+    const auto len_vel = rocket.getLenVel();
+    if (contacts.solve(rocket, dt)) {
+      result.touched = true;
+      result.impact_len_vel = len_vel;
+      model = RocketModel<S>(rocket);
+    }
+    return result;
+  }
+
+  // Into a contact: the tick again, sub-stepped in float.
+  rocket.restoreState(start);
+  const auto result = contacts.step(rocket, input, dt);
+  model = RocketModel<S>(rocket);
+  return result;
+}
@@ -0,0 +1,120 @@
+#include "../include/hud.hpp"
+
+Hud::Hud(const sf::Font &font, unsigned int character_size,
+         sf::Vector2f origin, float value_column)
+    : font(font), character_size(character_size), origin(origin),
+      value_column(value_column), line_height(character_size * 1.2f) {}
+
+sf::Text Hud::makeText(const char *text, float x) const {
+  sf::Text t;
+  t.setFont(font);
+  t.setCharacterSize(character_size);
+  t.setFillColor(sf::Color::White);
+  t.setPosition(origin.x + x, origin.y + lines.size() * line_height);
+  t.setString(text);
+  return t;
+}
+
+void Hud::addHeader(const char *text) {
+  lines.push_back({makeText(text, 0.f), {}, {}, false});
+}
+
+int Hud::addField(const char *label) {
+  lines.push_back(
+      {makeText(label, 0.f), makeText("", value_column), {}, true});
+  return static_cast<int>(lines.size()) - 1;
+}
+
+void Hud::set(int field, const HudWriter &value) {
+  auto &line = lines[field];
+  if (line.shown == value)
+    return;
+
+  line.shown = value;
+  line.value.setString(value.c_str());
+  updates++;
+}
+
+void Hud::draw(sf::RenderTarget &target, sf::RenderStates states) const {
+  for (const auto &line : lines) {
+    target.draw(line.label, states);
+    if (line.has_value)
+      target.draw(line.value, states);
+  }
+}
+
+RocketHud::RocketHud(Hud &hud) : hud(hud) {
+  hud.addHeader("===== ROCKET TELEMETRY =====");
+  position = hud.addField("Position:");
+  velocity = hud.addField("Velocity:");
+  angle = hud.addField("Angle:");
+  force = hud.addField("Net Force:");
+
+  hud.addHeader("");
+  hud.addHeader("--- MASS & BALANCE ---");
+  total_mass = hud.addField("Total Mass:");
+  fuel_mass = hud.addField("Fuel Mass:");
+  cm = hud.addField("CM Pos:");
+
+  hud.addHeader("");
+  hud.addHeader("--- ENGINE OUTPUT (kg/s) ---");
+  main_output = hud.addField("Main (Bottom):");
+  left_output = hud.addField("Left RCS:");
+  right_output = hud.addField("Right RCS:");
+}
+
+void RocketHud::update(const SimState &state,
+                       const sf::Vector2<double> &origin) {
+  hud.set(position, HudWriter() << "(" << origin.x + state.pos.x << ", "
+                                << origin.y + state.pos.y << ") m");
+  hud.set(velocity, HudWriter() << "(" << state.vel.x << ", " << state.vel.y
+                                << ") m/s");
+  hud.set(angle, HudWriter() << state.angle * RADIANS_TO_DEGREES << " deg");
+  hud.set(force, HudWriter() << "(" << state.force.x << ", " << state.force.y
+                             << ") N");
+
+  hud.set(total_mass, HudWriter() << state.rocket_prop.m << " kg");
+  float fuel = 0.f;
+  for (std::uint32_t i = 0; i < state.component_count; i++)
+    if (state.components[i].feeds)
+      fuel += state.components[i].m;
+  hud.set(fuel_mass, HudWriter() << fuel << " kg");
+  hud.set(cm, HudWriter() << "(" << state.rocket_prop.r_cm.x << ", "
+                          << state.rocket_prop.r_cm.y << ")");
+
+  hud.set(main_output, HudWriter() << state.bottom.curr_output << " (Target: "
+                                   << state.bottom.target_output << ")");
+  hud.set(left_output, HudWriter() << state.left.curr_output << " (Target: "
+                                   << state.left.target_output << ")");
+  hud.set(right_output, HudWriter() << state.right.curr_output << " (Target: "
+                                    << state.right.target_output << ")");
+}
+
+ProfileHud::ProfileHud(Hud &hud) : hud(hud) {
+  hud.addHeader("--- PROFILE (p50 / p99 / max us) ---");
+  for (int i = 0; i < PROFILE_METRIC_COUNT; i++)
+    fields[i] = hud.addField(PROFILE_METRICS[i].name);
+}
+
+void ProfileHud::update() {
+  const auto now = Profiler::snapshot();
+
+  for (int i = 0; i < PROFILE_METRIC_COUNT; i++) {
+    const auto window = now.metrics[i].since(last.metrics[i]);
+    if (window.count == 0) {
+      hud.set(fields[i], HudWriter() << "-");
+      continue;
+    }
+
+    if (PROFILE_METRICS[i].is_time)
+      hud.set(fields[i], HudWriter() << window.quantile(0.5) / 1000. << " / "
+                                     << window.quantile(0.99) / 1000. << " / "
+                                     << window.max / 1000.);
+    else
+      hud.set(fields[i], HudWriter() << window.quantile(0.5) << " / "
+                                     << window.quantile(0.99) << " / "
+                                     << window.max);
+  }
+
+  last = now;
+}
@@ -0,0 +1,235 @@
+#include "../include/live_telemetry.hpp"
+
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+const char RING_MAGIC[8] = {'R', 'K', 'T', 'R', 'I', 'N', 'G', '\0'};
+const std::uint32_t RING_VERSION = 2;
+const std::size_t SAMPLE_WORDS = sizeof(LiveSample) / sizeof(std::uint64_t);
+
+struct RingHeader {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t sample_size;
+  std::uint32_t capacity;
+  std::uint32_t slot_size;
+  std::uint64_t pid;
+  alignas(64) std::atomic<std::uint64_t> head;
+};
+
+struct alignas(64) RingSlot {
+  std::atomic<std::uint64_t> seq;
+  std::uint64_t words[SAMPLE_WORDS];
+};
+
+static_assert(sizeof(RingHeader) == 128);
+static_assert(offsetof(RingHeader, head) == 64);
+static_assert(sizeof(RingSlot) == 128);
+static_assert(sizeof(LiveSample) % sizeof(std::uint64_t) == 0);
+
+RingHeader &header(void *memory) { return *static_cast<RingHeader *>(memory); }
+
+RingSlot &slot(void *memory, std::uint64_t i) {
+  return reinterpret_cast<RingSlot *>(static_cast<char *>(memory) +
+                                      sizeof(RingHeader))[i];
+}
+
+// The sample words are shared with readers mid-copy: atomic, but relaxed,
+// the slot seq orders them.
+void storeWords(RingSlot &s, const LiveSample &sample) {
+  std::uint64_t words[SAMPLE_WORDS];
+  std::memcpy(words, &sample, sizeof(sample));
+  for (std::size_t i = 0; i < SAMPLE_WORDS; i++)
+    std::atomic_ref<std::uint64_t>(s.words[i])
+        .store(words[i], std::memory_order_relaxed);
+}
+
+void loadWords(RingSlot &s, LiveSample &sample) {
+  std::uint64_t words[SAMPLE_WORDS];
+  for (std::size_t i = 0; i < SAMPLE_WORDS; i++)
+    words[i] = std::atomic_ref<std::uint64_t>(s.words[i])
+                   .load(std::memory_order_relaxed);
+  std::memcpy(&sample, words, sizeof(sample));
+}
+
+} // namespace
+
+LiveTelemetryWriter::LiveTelemetryWriter(const std::string &name,
+                                         std::uint32_t capacity)
+    : name(name) {
+  if (capacity == 0 || (capacity & (capacity - 1)) != 0)
+    throw std::runtime_error("Telemetry ring capacity must be a power of 2");
+
+  // A fresh object: readers of a previous run keep their old mapping.
+  shm_unlink(name.c_str());
+  const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+  if (fd < 0)
+    throw std::runtime_error("Cannot create shared memory " + name);
+
+  size = sizeof(RingHeader) + capacity * sizeof(RingSlot);
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    close(fd);
+    shm_unlink(name.c_str());
+    throw std::runtime_error("Cannot size shared memory " + name);
+  }
+
+  memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    memory = nullptr;
+    shm_unlink(name.c_str());
+    throw std::runtime_error("Cannot map shared memory " + name);
+  }
+
+  // ftruncate zero-fills: every seq is 0, which matches no sample.
+  auto &h = header(memory);
+  h.version = RING_VERSION;
+  h.sample_size = sizeof(LiveSample);
+  h.capacity = capacity;
+  h.slot_size = sizeof(RingSlot);
+  h.pid = static_cast<std::uint64_t>(getpid());
+  h.head.store(0, std::memory_order_relaxed);
+  mask = capacity - 1;
+
+  std::atomic_thread_fence(std::memory_order_release);
+  std::memcpy(h.magic, RING_MAGIC, sizeof(RING_MAGIC));
+}
+
+LiveTelemetryWriter::~LiveTelemetryWriter() {
+  if (memory)
+    munmap(memory, size);
+  shm_unlink(name.c_str());
+}
+
+void LiveTelemetryWriter::publish(const LiveSample &sample) {
+  auto &s = slot(memory, head & mask);
+
+  s.seq.store(2 * head + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  storeWords(s, sample);
+  s.seq.store(2 * head + 2, std::memory_order_release);
+
+  header(memory).head.store(++head, std::memory_order_release);
+}
+
+void LiveTelemetryWriter::publish(std::uint64_t tick, std::uint32_t vehicle,
+                                  const Rocket &rocket,
+                                  const SweptStep &contact, bool sleeping) {
+  LiveSample sample{};
+  sample.tick = tick;
+  sample.vehicle = vehicle;
+  sample.flags = (contact.touched ? LIVE_CONTACT : 0u) |
+                 (sleeping ? LIVE_SLEEPING : 0u);
+  sample.pos[0] = rocket.getPos().x;
+  sample.pos[1] = rocket.getPos().y;
+  sample.vel[0] = rocket.getVel().x;
+  sample.vel[1] = rocket.getVel().y;
+  sample.angle = rocket.getAngle();
+  sample.ang_vel = rocket.getAngularVel();
+  sample.force[0] = rocket.getForce().x;
+  sample.force[1] = rocket.getForce().y;
+  sample.mass = rocket.getMass();
+  sample.fuel_mass = rocket.getFuelMass();
+  sample.cm[0] = rocket.getCm().x;
+  sample.cm[1] = rocket.getCm().y;
+
+  const RocketBooster *boosters[3] = {&rocket.getBottomBooster(),
+                                      &rocket.getLeftBooster(),
+                                      &rocket.getRightBooster()};
+  for (int i = 0; i < 3; i++) {
+    sample.output[i] = boosters[i]->curr_output;
+    sample.target[i] = boosters[i]->target_output;
+  }
+
+  sample.impact_len_vel = contact.touched ? contact.impact_len_vel : 0.f;
+  sample.substeps = static_cast<std::uint32_t>(contact.substeps);
+
+  publish(sample);
+}
+
+void LiveTelemetryWriter::publish(std::uint64_t tick, const World &world) {
+  for (std::size_t i = 0; i < world.size(); i++)
+    publish(tick, static_cast<std::uint32_t>(i), world.getVehicle(i),
+            world.getContact(i), world.isSleeping(i));
+}
+
+LiveTelemetryReader::LiveTelemetryReader(const std::string &name) {
+  // Read only: a reader cannot disturb the producer or other readers.
+  const int fd = shm_open(name.c_str(), O_RDONLY, 0);
+  if (fd < 0)
+    throw std::runtime_error("No telemetry ring " + name);
+
+  struct stat info;
+  if (fstat(fd, &info) != 0 ||
+      static_cast<std::size_t>(info.st_size) < sizeof(RingHeader)) {
+    close(fd);
+    throw std::runtime_error("Telemetry ring " + name + " is not ready");
+  }
+
+  size = static_cast<std::size_t>(info.st_size);
+  memory = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    memory = nullptr;
+    throw std::runtime_error("Cannot map telemetry ring " + name);
+  }
+
+  const auto &h = header(memory);
+  if (std::memcmp(h.magic, RING_MAGIC, sizeof(RING_MAGIC)) != 0 ||
+      h.version != RING_VERSION || h.sample_size != sizeof(LiveSample) ||
+      h.slot_size != sizeof(RingSlot) ||
+      size < sizeof(RingHeader) + std::size_t(h.capacity) * sizeof(RingSlot)) {
+    munmap(memory, size);
+    memory = nullptr;
+    throw std::runtime_error("Telemetry ring " + name + " has another layout");
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+
+  mask = h.capacity - 1;
+}
+
+LiveTelemetryReader::~LiveTelemetryReader() {
+  if (memory)
+    munmap(memory, size);
+}
+
+bool LiveTelemetryReader::next(LiveSample &sample) {
+  const auto capacity = std::uint64_t(mask) + 1;
+
+  for (;;) {
+    const auto head = header(memory).head.load(std::memory_order_acquire);
+    if (cursor >= head)
+      return false;
+
+    if (head - cursor > capacity) {
+      dropped += head - capacity - cursor;
+      cursor = head - capacity;
+    }
+
+    auto &s = slot(memory, cursor & mask);
+    const auto expected = 2 * cursor + 2;
+
+    if (s.seq.load(std::memory_order_acquire) == expected) {
+      loadWords(s, sample);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (s.seq.load(std::memory_order_relaxed) == expected) {
+        cursor++;
+        return true;
+      }
+    }
+
+    // Overwritten under us: the producer is a lap ahead.
+    dropped++;
+    cursor++;
+  }
+}
+
+void LiveTelemetryReader::skipToLatest() {
+  cursor = header(memory).head.load(std::memory_order_acquire);
+}
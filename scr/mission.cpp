@@ -0,0 +1,172 @@
+#include "../include/mission.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+const float NONE = std::numeric_limits<float>::quiet_NaN();
+
+const RocketBooster &booster(const Rocket &rocket, int engine) {
+  switch (engine) {
+  case 1:
+    return rocket.getLeftBooster();
+  case 2:
+    return rocket.getRightBooster();
+  default:
+    return rocket.getBottomBooster();
+  }
+}
+
+} // namespace
+
+std::coroutine_handle<> Mission::FinalAwaiter::await_suspend(
+    std::coroutine_handle<promise_type> handle) noexcept {
+  auto &promise = handle.promise();
+  if (promise.continuation)
+    return promise.continuation;
+
+  promise.control.finished = true;
+  promise.control.commanded(); // Cuts its engines on the next gather.
+  return std::noop_coroutine();
+}
+
+void Mission::promise_type::unhandled_exception() {
+  if (continuation) {
+    error = std::current_exception();
+    return;
+  }
+  auto &sequencer = control.sequencer;
+  if (!sequencer.error)
+    sequencer.error = std::current_exception();
+}
+
+MissionControl::MissionControl(MissionSequencer &sequencer, const World &world,
+                               std::size_t vehicle)
+    : sequencer(sequencer), world(world), vehicle(vehicle),
+      start_tick(sequencer.wheel.now()), output{NONE, NONE, NONE},
+      nozzle_area{NONE, NONE, NONE} {}
+
+double MissionControl::time() const {
+  return double(sequencer.wheel.now() - start_tick) * sequencer.dt;
+}
+
+float MissionControl::altitude() const {
+  const auto pos = world.getWorldPos(vehicle);
+  return static_cast<float>(
+      world.getTerrain().surfaceAt(static_cast<float>(pos.x)) - pos.y);
+}
+
+void MissionControl::fire(Engine engine, bool on) {
+  firing[int(engine)] = on;
+  commanded();
+}
+
+void MissionControl::throttle(Engine engine, float output) {
+  this->output[int(engine)] = std::max(output, 0.f);
+  commanded();
+}
+
+void MissionControl::nozzleArea(Engine engine, float area) {
+  nozzle_area[int(engine)] = area;
+  commanded();
+}
+
+MissionWait MissionControl::wait(float seconds) {
+  return {*this, ticksFor(seconds)};
+}
+
+std::uint64_t MissionControl::ticksFor(float seconds) const {
+  // Tolerant of the rounding in seconds = n * dt.
+  const float ticks = std::ceil(seconds / sequencer.dt - 1e-3f);
+  return ticks > 0.f ? std::uint64_t(ticks) : 0;
+}
+
+void MissionControl::schedule(TimerNode &node, std::uint64_t ticks) {
+  sequencer.wheel.schedule(node, sequencer.wheel.now() + ticks);
+}
+
+void MissionControl::commanded() {
+  if (listed)
+    return;
+  listed = true;
+  sequencer.commanding.push_back(this);
+}
+
+bool MissionControl::gather() {
+  if (finished)
+    firing[0] = firing[1] = firing[2] = false;
+
+  input = {};
+  input.bottom = firing[0];
+  input.left = firing[1];
+  input.right = firing[2];
+
+  // Targets become deltas against the booster as it is now.
+  const auto &rocket = this->rocket();
+  float *dOut[3] = {&input.dBottomOut, &input.dLeftOut, &input.dRightOut};
+  float *dAe[3] = {&input.dBottomAe, &input.dLeftAe, &input.dRightAe};
+  bool any = firing[0] || firing[1] || firing[2];
+  for (int i = 0; i < 3; i++) {
+    const auto &b = booster(rocket, i);
+    if (!std::isnan(output[i])) {
+      *dOut[i] = output[i] - b.target_output;
+      output[i] = NONE;
+    }
+    if (!std::isnan(nozzle_area[i])) {
+      *dAe[i] = nozzle_area[i] - b.curr_Ae;
+      nozzle_area[i] = NONE;
+    }
+    any = any || *dOut[i] != 0.f || *dAe[i] != 0.f;
+  }
+  return any;
+}
+
+MissionSequencer::MissionSequencer(const World &world, float dt)
+    : world(world), dt(dt) {
+  if (!(dt > 0.f))
+    throw std::runtime_error("MissionSequencer: dt must be positive");
+}
+
+std::size_t MissionSequencer::start(std::size_t vehicle,
+                                    MissionScript script) {
+  if (vehicle >= world.size())
+    throw std::runtime_error("MissionSequencer: no vehicle " +
+                             std::to_string(vehicle));
+
+  auto &entry =
+      *missions.emplace_back(std::make_unique<Entry>(*this, world, vehicle));
+  entry.script = script(entry.control);
+  // Its first commands go out with the next tick.
+  entry.script.handle.resume();
+  rethrow();
+  return missions.size() - 1;
+}
+
+void MissionSequencer::tick() {
+  wheel.advance();
+  gather();
+  rethrow();
+}
+
+void MissionSequencer::gather() {
+  gathered.clear();
+  for (auto *control : commanding) {
+    if (control->gather())
+      gathered.push_back(control);
+    else
+      control->listed = false;
+  }
+  std::swap(commanding, gathered);
+}
+
+void MissionSequencer::rethrow() {
+  if (error)
+    std::rethrow_exception(std::exchange(error, nullptr));
+}
+
+void MissionSequencer::apply(World &world) const {
+  for (const auto *control : commanding)
+    world.setInput(control->vehicle, control->input);
+}
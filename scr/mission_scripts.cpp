@@ -0,0 +1,77 @@
+#include "../include/mission.hpp"
+
+#include <initializer_list>
+#include <stdexcept>
+
+namespace {
+
+// Holds the rocket upright with short side engine pulses.
+void trim(MissionControl &mc) {
+  const float angle = mc.rocket().getAngle();
+  mc.fire(Engine::LEFT, angle < -0.03f);
+  mc.fire(Engine::RIGHT, angle > 0.03f);
+}
+
+// Descends under the main engine, firing it whenever the vehicle falls
+// faster than the speed allowed at its height, until it is down.
+Mission land(MissionControl &mc, float ground) {
+  while (!mc.touching() || mc.speed() > 0.033f) {
+    const float height = mc.altitude() - ground;
+    mc.fire(Engine::MAIN, -mc.verticalSpeed() > 0.05f + 0.3f * height);
+    trim(mc);
+    co_await mc.wait(1.f / 120.f);
+  }
+}
+
+// Up 2.5 m on a fixed throttle, coast to apogee, land.
+Mission hop(MissionControl &mc) {
+  const float ground = mc.altitude();
+  const float nozzle = mc.rocket().getBottomBooster().curr_Ae;
+
+  mc.throttle(Engine::MAIN, 3.f);
+  mc.throttle(Engine::LEFT, 0.3f);
+  mc.throttle(Engine::RIGHT, 0.3f);
+  mc.fire(Engine::MAIN, true);
+  co_await mc.until([ground](const MissionControl &mc) {
+    return mc.altitude() > ground + 2.5f || mc.fuel() <= 0.f;
+  });
+
+  mc.fire(Engine::MAIN, false);
+  co_await mc.until(
+      [](const MissionControl &mc) { return mc.verticalSpeed() <= 0.f; });
+
+  // Widest nozzle for the landing burn.
+  mc.nozzleArea(Engine::MAIN, mc.rocket().getBottomBooster().maxAe);
+  co_await land(mc, ground);
+
+  // Engines burn at their target output even when not firing.
+  for (const auto engine : {Engine::MAIN, Engine::LEFT, Engine::RIGHT}) {
+    mc.fire(engine, false);
+    mc.throttle(engine, 0.f);
+  }
+  mc.nozzleArea(Engine::MAIN, nozzle);
+}
+
+// Two hops, a second apart on the ground.
+Mission hops(MissionControl &mc) {
+  for (int i = 0; i < 2; i++) {
+    co_await hop(mc);
+    co_await mc.wait(1.f);
+  }
+}
+
+} // namespace
+
+const NamedMission MISSIONS[] = {
+    {"hop", hop},
+    {"hops", hops},
+};
+
+const std::size_t MISSION_COUNT = sizeof(MISSIONS) / sizeof(MISSIONS[0]);
+
+MissionScript findMission(const std::string &name) {
+  for (const auto &mission : MISSIONS)
+    if (name == mission.name)
+      return mission.script;
+  throw std::runtime_error("Unknown mission: " + name);
+}
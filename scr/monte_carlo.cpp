@@ -0,0 +1,270 @@
+#include "../include/monte_carlo.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+// Samples per chunk and chunks per batch: a batch is folded in order
+// before the next one starts.
+const std::uint64_t CHUNK = 256;
+const std::uint64_t CHUNKS_PER_BATCH = 64;
+
+const std::size_t HISTOGRAM_BINS = 40;
+
+std::uint64_t splitmix64(std::uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+} // namespace
+
+const char *const MONTE_CARLO_METRICS[MC_METRIC_COUNT] = {
+    "x_error", "impact_speed", "final_angle", "fuel_used", "rest_time"};
+
+void RunningStats::add(double x) {
+  if (count == 0) {
+    min = max = x;
+  } else {
+    min = std::min(min, x);
+    max = std::max(max, x);
+  }
+
+  count++;
+  const double delta = x - mean;
+  mean += delta / count;
+  m2 += delta * (x - mean);
+}
+
+void RunningStats::merge(const RunningStats &other) {
+  if (other.count == 0)
+    return;
+  if (count == 0) {
+    *this = other;
+    return;
+  }
+
+  const double total = double(count + other.count);
+  const double delta = other.mean - mean;
+  mean += delta * other.count / total;
+  m2 += other.m2 + delta * delta * (double(count) * other.count / total);
+  count += other.count;
+  min = std::min(min, other.min);
+  max = std::max(max, other.max);
+}
+
+double RunningStats::stddev() const { return std::sqrt(variance()); }
+
+int QuantileSketch::bucketOf(double magnitude) {
+  const int bucket = static_cast<int>(
+      std::ceil(std::log(magnitude / MIN_VALUE) / std::log(GAMMA)));
+  return std::clamp(bucket, 0, BUCKETS - 1);
+}
+
+// Middle of (GAMMA^(b-1), GAMMA^b] * MIN_VALUE, within 1% of anything in it.
+double QuantileSketch::bucketValue(int bucket) {
+  return MIN_VALUE * std::pow(GAMMA, bucket) * 2. / (1. + GAMMA);
+}
+
+void QuantileSketch::add(double x) {
+  if (std::isnan(x))
+    return;
+
+  count++;
+  if (std::abs(x) < MIN_VALUE)
+    zero++;
+  else if (x > 0.)
+    positive[bucketOf(x)]++;
+  else
+    negative[bucketOf(-x)]++;
+}
+
+void QuantileSketch::merge(const QuantileSketch &other) {
+  for (int b = 0; b < BUCKETS; b++) {
+    negative[b] += other.negative[b];
+    positive[b] += other.positive[b];
+  }
+  zero += other.zero;
+  count += other.count;
+}
+
+double QuantileSketch::quantile(double q) const {
+  if (count == 0)
+    return 0.;
+
+  const auto rank =
+      static_cast<std::uint64_t>(std::clamp(q, 0., 1.) * (count - 1)) + 1;
+  std::uint64_t seen = 0;
+
+  // Ascending values: negatives from the largest magnitude, 0, positives.
+  for (int b = BUCKETS - 1; b >= 0; b--) {
+    seen += negative[b];
+    if (seen >= rank)
+      return -bucketValue(b);
+  }
+  seen += zero;
+  if (seen >= rank)
+    return 0.;
+  for (int b = 0; b < BUCKETS; b++) {
+    seen += positive[b];
+    if (seen >= rank)
+      return bucketValue(b);
+  }
+  return bucketValue(BUCKETS - 1);
+}
+
+Histogram2D::Histogram2D(double x_min, double x_max, std::size_t nx,
+                         double y_min, double y_max, std::size_t ny)
+    : x_min(x_min), y_min(y_min), dx((x_max - x_min) / nx),
+      dy((y_max - y_min) / ny), nx(nx), ny(ny), counts(nx * ny) {
+  if (nx == 0 || ny == 0 || !(dx > 0.) || !(dy > 0.))
+    throw std::runtime_error("Histogram2D needs a non empty range");
+}
+
+void Histogram2D::add(double x, double y) {
+  const double fx = (x - x_min) / dx;
+  const double fy = (y - y_min) / dy;
+  // Also false for NaN.
+  if (!(fx >= 0. && fx < nx && fy >= 0. && fy < ny)) {
+    outside++;
+    return;
+  }
+  counts[static_cast<std::size_t>(fy) * nx + static_cast<std::size_t>(fx)]++;
+}
+
+void Histogram2D::merge(const Histogram2D &other) {
+  if (other.nx != nx || other.ny != ny)
+    throw std::runtime_error("Histogram2D merge of different grids");
+
+  for (std::size_t i = 0; i < counts.size(); i++)
+    counts[i] += other.counts[i];
+  outside += other.outside;
+}
+
+MonteCarloReport::MonteCarloReport(const MonteCarloConfig &config)
+    : touchdown(-config.histogram_x, config.histogram_x, HISTOGRAM_BINS, 0.,
+                config.histogram_speed, HISTOGRAM_BINS) {}
+
+void MonteCarloReport::successInterval(double &low, double &high) const {
+  if (samples == 0) {
+    low = 0.;
+    high = 1.;
+    return;
+  }
+
+  const double z = 1.96;
+  const double n = double(samples);
+  const double p = successRate();
+  const double centre = (p + z * z / (2. * n)) / (1. + z * z / n);
+  const double half =
+      z * std::sqrt(p * (1. - p) / n + z * z / (4. * n * n)) / (1. + z * z / n);
+  low = std::max(0., centre - half);
+  high = std::min(1., centre + half);
+}
+
+MonteCarlo::MonteCarlo(const ScenarioFile &file, const Terrain &terrain,
+                       const WindField *wind)
+    : file(file), terrain(terrain), wind(wind),
+      target_x(file.monte_carlo.target_x) {
+  if (target_x < 0.f) {
+    if (terrain.getPads().empty())
+      throw std::runtime_error("Monte Carlo needs target_x or a pad");
+    const auto &pad = terrain.getPads().front();
+    target_x = pad.left + pad.width / 2.f;
+  }
+}
+
+Scenario MonteCarlo::sample(std::uint64_t i) const {
+  Scenario scenario = file.base;
+  std::mt19937_64 rng(splitmix64(file.sweep.seed ^ splitmix64(i)));
+
+  for (const auto &d : file.monte_carlo.dispersions) {
+    float &value = SCENARIO_PARAMS[d.param].field(scenario);
+    if (d.kind == DispersionKind::NORMAL)
+      value += std::normal_distribution<float>(0.f, d.spread)(rng);
+    else
+      value += std::uniform_real_distribution<float>(-d.spread, d.spread)(rng);
+  }
+
+  return scenario;
+}
+
+bool MonteCarlo::isSuccess(const ScenarioResult &result) const {
+  const auto &config = file.monte_carlo;
+  return result.rest_time >= 0.f && result.on_pad > 0.f &&
+         result.impact_speed <= config.success_speed &&
+         std::abs(result.final_angle) <= config.success_angle;
+}
+
+MonteCarloReport
+MonteCarlo::run(std::uint64_t count, ThreadPool &pool,
+                const std::function<void(std::uint64_t)> &progress) const {
+  const auto &config = file.monte_carlo;
+
+  // Counts per worker; moments per chunk of the current batch only.
+  std::vector<MonteCarloReport> workers(pool.size(), MonteCarloReport(config));
+  std::vector<std::array<RunningStats, MC_METRIC_COUNT>> chunk_moments(
+      CHUNKS_PER_BATCH);
+  MonteCarloReport total(config);
+
+  const std::uint64_t chunks = (count + CHUNK - 1) / CHUNK;
+  for (std::uint64_t first = 0; first < chunks; first += CHUNKS_PER_BATCH) {
+    const auto batch = std::min(CHUNKS_PER_BATCH, chunks - first);
+
+    pool.parallelFor(batch, [&](std::size_t c, unsigned worker) {
+      auto &report = workers[worker];
+      auto &moments = chunk_moments[c];
+      moments = {};
+
+      const auto begin = (first + c) * CHUNK;
+      const auto end = std::min(count, begin + CHUNK);
+      for (auto i = begin; i < end; i++) {
+        report.samples++;
+
+        ScenarioResult result;
+        try {
+          result = runScenario(sample(i), terrain, wind);
+        } catch (const std::exception &) {
+          report.failed++;
+          continue;
+        }
+
+        const double values[MC_METRIC_COUNT] = {
+            result.final_x - target_x, result.impact_speed,
+            result.final_angle, result.fuel_used, result.rest_time};
+        for (int m = 0; m < MC_METRIC_COUNT; m++) {
+          if (m == MC_REST_TIME && result.rest_time < 0.f)
+            continue;
+          moments[m].add(values[m]);
+          report.sketches[m].add(values[m]);
+        }
+
+        if (isSuccess(result))
+          report.successes++;
+        report.touchdown.add(values[MC_X_ERROR], result.impact_speed);
+      }
+    });
+
+    for (std::uint64_t c = 0; c < batch; c++)
+      for (int m = 0; m < MC_METRIC_COUNT; m++)
+        total.moments[m].merge(chunk_moments[c][m]);
+
+    if (progress)
+      progress(std::min(count, (first + batch) * CHUNK));
+  }
+
+  for (const auto &report : workers) {
+    total.samples += report.samples;
+    total.successes += report.successes;
+    total.failed += report.failed;
+    for (int m = 0; m < MC_METRIC_COUNT; m++)
+      total.sketches[m].merge(report.sketches[m]);
+    total.touchdown.merge(report.touchdown);
+  }
+
+  return total;
+}
@@ -0,0 +1,135 @@
+#include "../include/profiler.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// One thread's histograms. Only the owner writes; snapshot() reads.
+struct ThreadBlock {
+  struct Metric {
+    std::atomic<std::uint64_t> buckets[ProfileHistogram::BUCKETS];
+    std::atomic<std::uint64_t> count, total, max;
+  };
+  Metric metrics[PROFILE_METRIC_COUNT] = {};
+};
+
+std::mutex registry_mutex;
+std::vector<std::shared_ptr<ThreadBlock>> registry;
+
+ThreadBlock &threadBlock() {
+  thread_local std::shared_ptr<ThreadBlock> block = [] {
+    auto made = std::make_shared<ThreadBlock>();
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    registry.push_back(made);
+    return made;
+  }();
+  return *block;
+}
+
+// Single writer: a load and a store, no read-modify-write.
+void bump(std::atomic<std::uint64_t> &counter, std::uint64_t by) {
+  counter.store(counter.load(std::memory_order_relaxed) + by,
+                std::memory_order_relaxed);
+}
+
+} // namespace
+
+const ProfileMetricInfo PROFILE_METRICS[PROFILE_METRIC_COUNT] = {
+    {"world_step", true}, {"boosters", true},
+    {"mach", true},       {"fuel", true},
+    {"integrate", true},  {"sweep", true},
+    {"contacts", true},   {"pairs", true},
+    {"autopilot", true},  {"hud", true},
+    {"draw", true},       {"newton_iterations", false}};
+
+int ProfileHistogram::bucketOf(std::uint64_t value) {
+  if (value < 16)
+    return static_cast<int>(value);
+
+  const int exponent = std::bit_width(value) - 1; // >= 4
+  const int mantissa = static_cast<int>(value >> (exponent - 3)) & 7;
+  return std::min(16 + (exponent - 4) * 8 + mantissa, BUCKETS - 1);
+}
+
+std::uint64_t ProfileHistogram::bucketTop(int bucket) {
+  if (bucket < 16)
+    return static_cast<std::uint64_t>(bucket);
+
+  const int exponent = (bucket - 16) / 8 + 4;
+  const std::uint64_t mantissa = (bucket - 16) % 8;
+  return ((9 + mantissa) << (exponent - 3)) - 1;
+}
+
+std::uint64_t ProfileHistogram::quantile(double q) const {
+  if (count == 0)
+    return 0;
+
+  const auto rank = static_cast<std::uint64_t>(q * (count - 1)) + 1;
+  std::uint64_t seen = 0;
+  for (int b = 0; b < BUCKETS; b++) {
+    seen += buckets[b];
+    if (seen >= rank)
+      return std::min(bucketTop(b), max);
+  }
+  return max;
+}
+
+ProfileHistogram
+ProfileHistogram::since(const ProfileHistogram &earlier) const {
+  ProfileHistogram window;
+  for (int b = 0; b < BUCKETS; b++)
+    window.buckets[b] = buckets[b] - earlier.buckets[b];
+  window.count = count - earlier.count;
+  window.total = total - earlier.total;
+  window.max = max;
+  return window;
+}
+
+void Profiler::record(ProfileMetric metric, std::uint64_t value) {
+  auto &m = threadBlock().metrics[metric];
+
+  bump(m.buckets[ProfileHistogram::bucketOf(value)], 1);
+  bump(m.count, 1);
+  bump(m.total, value);
+  if (value > m.max.load(std::memory_order_relaxed))
+    m.max.store(value, std::memory_order_relaxed);
+}
+
+ProfileSnapshot Profiler::snapshot() {
+  ProfileSnapshot snapshot;
+
+  std::lock_guard<std::mutex> lock(registry_mutex);
+  for (const auto &block : registry) {
+    for (int i = 0; i < PROFILE_METRIC_COUNT; i++) {
+      const auto &m = block->metrics[i];
+      auto &h = snapshot.metrics[i];
+
+      for (int b = 0; b < ProfileHistogram::BUCKETS; b++)
+        h.buckets[b] += m.buckets[b].load(std::memory_order_relaxed);
+      h.count += m.count.load(std::memory_order_relaxed);
+      h.total += m.total.load(std::memory_order_relaxed);
+      h.max = std::max(h.max, m.max.load(std::memory_order_relaxed));
+    }
+  }
+
+  return snapshot;
+}
+
+void Profiler::writeJson(std::ostream &out, const ProfileSnapshot &snapshot) {
+  out << "{\n";
+  for (int i = 0; i < PROFILE_METRIC_COUNT; i++) {
+    const auto &info = PROFILE_METRICS[i];
+    const auto &h = snapshot.metrics[i];
+
+    out << "  \"" << info.name << "\": {\"unit\": \""
+        << (info.is_time ? "ns" : "count") << "\", \"count\": " << h.count
+        << ", \"mean\": " << h.mean() << ", \"p50\": " << h.quantile(0.5)
+        << ", \"p99\": " << h.quantile(0.99) << ", \"max\": " << h.max << "}"
+        << (i + 1 < PROFILE_METRIC_COUNT ? "," : "") << "\n";
+  }
+  out << "}\n";
+}
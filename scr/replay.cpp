@@ -0,0 +1,331 @@
+#include "../include/replay.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char REPLAY_MAGIC[4] = {'R', 'K', 'R', 'P'};
+const std::uint32_t REPLAY_VERSION = 7;
+const std::uint8_t RECORD_TICK = 0;
+const std::uint8_t RECORD_KEYFRAME = 1;
+
+const std::uint8_t MASK_BOTTOM = 1 << 0;
+const std::uint8_t MASK_LEFT = 1 << 1;
+const std::uint8_t MASK_RIGHT = 1 << 2;
+const std::uint8_t MASK_D_BOTTOM = 1 << 3;
+const std::uint8_t MASK_D_LEFT = 1 << 4;
+const std::uint8_t MASK_D_RIGHT = 1 << 5;
+const std::uint8_t MASK_NOZZLE = 1 << 6; // A nozzle mask byte follows.
+const std::uint8_t MASK_STAGE = 1 << 7;  // A stage byte follows.
+
+template <typename T> void writeValue(std::ofstream &out, T value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T>
+void writeArray(std::ofstream &out, const std::vector<T> &values) {
+  out.write(reinterpret_cast<const char *>(values.data()),
+            values.size() * sizeof(T));
+}
+
+// Bounds checked reads from the loaded log.
+class Cursor {
+public:
+  Cursor(const std::vector<char> &data, std::size_t offset = 0)
+      : data(data), offset(offset) {}
+
+  bool has(std::size_t bytes) const { return data.size() - offset >= bytes; }
+  std::size_t getOffset() const { return offset; }
+  void skip(std::size_t bytes) { offset += bytes; }
+
+  template <typename T> T read() {
+    T value;
+    std::memcpy(&value, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return value;
+  }
+
+  template <typename T> void read(T *out, std::size_t count) {
+    std::memcpy(static_cast<void *>(out), data.data() + offset,
+                count * sizeof(T));
+    offset += count * sizeof(T);
+  }
+
+private:
+  const std::vector<char> &data;
+  std::size_t offset;
+};
+
+} // namespace
+
+FlightRecorder::FlightRecorder(const std::string &path, const World &world,
+                               float dt, std::uint32_t keyframe_interval)
+    : out(path, std::ios::binary),
+      keyframe_interval(std::max(keyframe_interval, 1u)),
+      inputs(world.size()) {
+  if (!out)
+    throw std::runtime_error("Cannot write flight log " + path);
+
+  out.write(REPLAY_MAGIC, 4);
+  writeValue(out, REPLAY_VERSION);
+  writeValue(out, dt);
+  writeValue(out, this->keyframe_interval);
+  writeValue(out, static_cast<std::uint32_t>(world.size()));
+  writeValue(out, static_cast<std::uint32_t>(sizeof(VehicleState)));
+  writeValue(out, static_cast<std::uint32_t>(sizeof(PairManifold)));
+  writeValue(out, static_cast<std::uint32_t>(world.getPrecision()));
+  writeValue(out, static_cast<std::uint32_t>(sizeof(FlightModel)));
+
+  writeKeyframe(world);
+}
+
+void FlightRecorder::command(std::size_t vehicle, const ControlInput &input) {
+  inputs[vehicle] = input;
+}
+
+void FlightRecorder::endTick(const World &world) {
+  writeValue(out, RECORD_TICK);
+
+  for (auto &input : inputs) {
+    std::uint8_t mask = 0;
+    if (input.bottom)
+      mask |= MASK_BOTTOM;
+    if (input.left)
+      mask |= MASK_LEFT;
+    if (input.right)
+      mask |= MASK_RIGHT;
+    if (input.dBottomOut != 0.f)
+      mask |= MASK_D_BOTTOM;
+    if (input.dLeftOut != 0.f)
+      mask |= MASK_D_LEFT;
+    if (input.dRightOut != 0.f)
+      mask |= MASK_D_RIGHT;
+
+    const float areas[3] = {input.dBottomAe, input.dLeftAe, input.dRightAe};
+    std::uint8_t nozzle = 0;
+    for (int k = 0; k < 3; k++)
+      if (areas[k] != 0.f)
+        nozzle |= 1 << k;
+    if (nozzle)
+      mask |= MASK_NOZZLE;
+    if (input.stage != 0)
+      mask |= MASK_STAGE;
+
+    writeValue(out, mask);
+    if (mask & MASK_D_BOTTOM)
+      writeValue(out, input.dBottomOut);
+    if (mask & MASK_D_LEFT)
+      writeValue(out, input.dLeftOut);
+    if (mask & MASK_D_RIGHT)
+      writeValue(out, input.dRightOut);
+    if (nozzle) {
+      writeValue(out, nozzle);
+      for (int k = 0; k < 3; k++)
+        if (nozzle & (1 << k))
+          writeValue(out, areas[k]);
+    }
+    if (input.stage != 0)
+      writeValue(out, input.stage);
+
+    input = {};
+  }
+
+  if (++tick % keyframe_interval == 0)
+    writeKeyframe(world);
+}
+
+void FlightRecorder::writeKeyframe(const World &world) {
+  world.saveState(state);
+
+  writeValue(out, RECORD_KEYFRAME);
+  writeValue(out, tick);
+  writeValue(out, state.time);
+  writeValue(out, state.origin.x);
+  writeValue(out, state.origin.y);
+  writeValue(out, static_cast<std::uint32_t>(state.pairs.size()));
+  writeArray(out, state.order);
+  writeArray(out, state.vehicles);
+  writeArray(out, state.pairs);
+  writeArray(out, state.flights);
+}
+
+FlightReplay::FlightReplay(const std::string &path) {
+  std::ifstream in(path, std::ios::binary | std::ios::ate);
+  if (!in)
+    throw std::runtime_error("Cannot open flight log " + path);
+  data.resize(static_cast<std::size_t>(in.tellg()));
+  in.seekg(0);
+  in.read(data.data(), static_cast<std::streamsize>(data.size()));
+
+  Cursor cursor(data);
+  const std::size_t header = 4 + 8 * sizeof(std::uint32_t);
+  if (!cursor.has(header) || std::memcmp(data.data(), REPLAY_MAGIC, 4) != 0)
+    throw std::runtime_error("Not a flight log: " + path);
+  cursor.skip(4);
+
+  if (cursor.read<std::uint32_t>() != REPLAY_VERSION)
+    throw std::runtime_error("Unsupported flight log version");
+  dt = cursor.read<float>();
+  cursor.skip(sizeof(std::uint32_t)); // Keyframe interval, implied below.
+  vehicle_count = cursor.read<std::uint32_t>();
+  if (cursor.read<std::uint32_t>() != sizeof(VehicleState) ||
+      cursor.read<std::uint32_t>() != sizeof(PairManifold))
+    throw std::runtime_error("Flight log written by another build");
+  const auto recorded = cursor.read<std::uint32_t>();
+  if (recorded > static_cast<std::uint32_t>(Precision::FIXED) ||
+      cursor.read<std::uint32_t>() != sizeof(FlightModel))
+    throw std::runtime_error("Flight log written by another build");
+  precision = static_cast<Precision>(recorded);
+  const std::uint32_t flights =
+      precision != Precision::FLOAT ? vehicle_count : 0;
+
+  // Index the records; a torn last record ends the log.
+  while (cursor.has(1)) {
+    const auto kind = cursor.read<std::uint8_t>();
+
+    if (kind == RECORD_TICK) {
+      const auto first = inputs.size();
+      bool complete = true;
+
+      for (std::uint32_t v = 0; v < vehicle_count; v++) {
+        if (!cursor.has(1)) {
+          complete = false;
+          break;
+        }
+        const auto mask = cursor.read<std::uint8_t>();
+        const auto floats = ((mask & MASK_D_BOTTOM) != 0) +
+                            ((mask & MASK_D_LEFT) != 0) +
+                            ((mask & MASK_D_RIGHT) != 0);
+        if (!cursor.has(floats * sizeof(float))) {
+          complete = false;
+          break;
+        }
+
+        ControlInput input;
+        input.bottom = mask & MASK_BOTTOM;
+        input.left = mask & MASK_LEFT;
+        input.right = mask & MASK_RIGHT;
+        if (mask & MASK_D_BOTTOM)
+          input.dBottomOut = cursor.read<float>();
+        if (mask & MASK_D_LEFT)
+          input.dLeftOut = cursor.read<float>();
+        if (mask & MASK_D_RIGHT)
+          input.dRightOut = cursor.read<float>();
+
+        if (mask & MASK_NOZZLE) {
+          if (!cursor.has(1)) {
+            complete = false;
+            break;
+          }
+          const auto nozzle = cursor.read<std::uint8_t>();
+          float *areas[3] = {&input.dBottomAe, &input.dLeftAe,
+                             &input.dRightAe};
+          const auto count = ((nozzle & 1) != 0) + ((nozzle & 2) != 0) +
+                             ((nozzle & 4) != 0);
+          if (!cursor.has(count * sizeof(float))) {
+            complete = false;
+            break;
+          }
+          for (int k = 0; k < 3; k++)
+            if (nozzle & (1 << k))
+              *areas[k] = cursor.read<float>();
+        }
+
+        if (mask & MASK_STAGE) {
+          if (!cursor.has(1)) {
+            complete = false;
+            break;
+          }
+          input.stage = cursor.read<std::uint8_t>();
+        }
+        inputs.push_back(input);
+      }
+
+      if (!complete) {
+        inputs.resize(first);
+        break;
+      }
+      ticks++;
+    } else if (kind == RECORD_KEYFRAME) {
+      if (!cursor.has(sizeof(std::uint64_t) + 3 * sizeof(double) +
+                      sizeof(std::uint32_t)))
+        break;
+
+      Keyframe keyframe;
+      keyframe.tick = cursor.read<std::uint64_t>();
+      keyframe.time = cursor.read<double>();
+      keyframe.origin.x = cursor.read<double>();
+      keyframe.origin.y = cursor.read<double>();
+      keyframe.pair_count = cursor.read<std::uint32_t>();
+      keyframe.offset = cursor.getOffset();
+
+      const auto size = vehicle_count * (sizeof(std::uint32_t) +
+                                         sizeof(VehicleState)) +
+                        keyframe.pair_count * sizeof(PairManifold) +
+                        flights * sizeof(FlightModel);
+      if (!cursor.has(size) || keyframe.tick != ticks)
+        break;
+      cursor.skip(size);
+      keyframes.push_back(keyframe);
+    } else {
+      throw std::runtime_error("Corrupt flight log record");
+    }
+  }
+
+  if (keyframes.empty())
+    throw std::runtime_error("Flight log has no keyframe");
+}
+
+void FlightReplay::seek(World &world, std::uint64_t target) {
+  if (world.getPrecision() != precision)
+    throw std::runtime_error(std::string("Flight log of a ") +
+                             precisionName(precision) + " world");
+  target = std::min(target, ticks);
+
+  // Keep stepping when the target is ahead within the current interval.
+  const auto found = std::upper_bound(
+      keyframes.begin(), keyframes.end(), target,
+      [](std::uint64_t t, const Keyframe &k) { return t < k.tick; });
+  const auto &keyframe = *(found - 1);
+
+  if (!restored || target < tick || keyframe.tick > tick) {
+    loadKeyframe(keyframe);
+    world.restoreState(state);
+    tick = keyframe.tick;
+    restored = true;
+  }
+
+  while (tick < target)
+    step(world);
+}
+
+bool FlightReplay::step(World &world) {
+  if (!restored)
+    seek(world, 0);
+  if (tick >= ticks)
+    return false;
+
+  for (std::uint32_t v = 0; v < vehicle_count; v++)
+    world.setInput(v, inputs[tick * vehicle_count + v]);
+  world.step(dt);
+  tick++;
+  return true;
+}
+
+void FlightReplay::loadKeyframe(const Keyframe &keyframe) {
+  Cursor cursor(data, keyframe.offset);
+
+  state.order.resize(vehicle_count);
+  state.vehicles.resize(vehicle_count);
+  state.pairs.resize(keyframe.pair_count);
+  state.flights.resize(precision != Precision::FLOAT ? vehicle_count : 0);
+  state.time = keyframe.time;
+  state.origin = keyframe.origin;
+
+  cursor.read(state.order.data(), vehicle_count);
+  cursor.read(state.vehicles.data(), vehicle_count);
+  cursor.read(state.pairs.data(), keyframe.pair_count);
+  cursor.read(state.flights.data(), state.flights.size());
+}
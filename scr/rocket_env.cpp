@@ -0,0 +1,347 @@
+#include "../include/rocket_env.h"
+#include "../include/contact.hpp"
+#include "../include/flight_model.hpp"
+#include "../include/scenario.hpp"
+#include "../include/simulation.hpp"
+#include "../include/terrain.hpp"
+#include "../include/thread_pool.hpp"
+#include "../include/wind.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Vehicles per pool task: enough work to hide the hand-off.
+const std::size_t CHUNK = 16;
+
+// Meters above the terrain that still count as flying.
+const float CEILING = 50.f;
+
+const float REST_SPEED = 0.033f;        // m / s.
+const float REST_ANGULAR_SPEED = 0.05f; // rad / s.
+const float REST_TIME = 0.5f;           // Seconds still before it landed.
+
+const float LANDING_REWARD = 100.f;
+const float OFF_PAD_REWARD = 20.f;
+const float CRASH_REWARD = -100.f;
+const float FUEL_COST = 0.1f; // Per kg.
+
+thread_local std::string last_error;
+
+std::uint64_t splitmix64(std::uint64_t x) {
+  x += 0x9e3779b97f4a7c15ull;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+int fail(const char *what) {
+  last_error = what;
+  return -1;
+}
+
+} // namespace
+
+struct RocketEnv {
+  struct Vehicle {
+    Vehicle(const Rocket &prototype, Precision precision)
+        : rocket(prototype), contacts(prototype),
+          flight(precision, prototype) {}
+
+    Rocket rocket;
+    ContactSolver contacts;
+    FlightModel flight; // The scenario's precision.
+    std::uint64_t seed = 0;
+    std::uint64_t episode = 0;
+    float time = 0.f;
+    float rest_time = 0.f;
+    float potential = 0.f;
+    float wind_phase = 0.f;
+  };
+
+  RocketEnvConfig config;
+  Terrain terrain;
+  std::unique_ptr<WindField> wind;
+  WindParams wind_params;
+  SimState start;
+  float target_x, target_y, pad_left, pad_right, min_x, max_x;
+
+  ThreadPool pool;
+  std::vector<Vehicle> vehicles;
+
+  RocketEnv(const RocketEnvConfig &config, const Scenario &scenario,
+            Terrain terrain, std::unique_ptr<WindField> wind)
+      : config(config), terrain(std::move(terrain)), wind(std::move(wind)),
+        wind_params(scenario.wind), pool(config.threads) {
+    const auto &pad = this->terrain.getPads().front();
+    target_x = pad.left + pad.width / 2.f;
+    target_y = pad.top;
+    pad_left = pad.left;
+    pad_right = pad.left + pad.width;
+    min_x = this->terrain.getPoints().front().x;
+    max_x = this->terrain.getPoints().back().x;
+
+    const Rocket prototype = createRocket(scenario.rocket);
+    start = prototype.getState();
+
+    vehicles.reserve(config.count);
+    for (std::uint32_t i = 0; i < config.count; i++) {
+      vehicles.emplace_back(prototype, scenario.precision);
+      vehicles.back().contacts.setTerrain(this->terrain);
+    }
+  }
+
+  // Shaping: closer, slower and more upright is better.
+  float potential(const Rocket &rocket) const {
+    const auto &pos = rocket.getPos();
+    const auto &vel = rocket.getVel();
+    const float distance =
+        std::abs(pos.x - target_x) + std::abs(target_y - pos.y);
+    return -0.6f * distance -
+           0.6f * std::sqrt(vel.x * vel.x + vel.y * vel.y) -
+           std::abs(rocket.getAngle());
+  }
+
+  void reset(Vehicle &vehicle) {
+    std::mt19937_64 rng(
+        splitmix64(vehicle.seed ^ splitmix64(vehicle.episode)));
+    std::uniform_real_distribution<float> unit(-1.f, 1.f);
+
+    SimState state = start;
+    state.pos.x = target_x + unit(rng) * config.start_x_range;
+    state.pos.y = target_y - config.start_height -
+                  unit(rng) * config.start_height_range;
+    state.pos_prev = state.pos;
+    state.vel.x = unit(rng) * config.start_speed_range;
+    state.vel.y = unit(rng) * config.start_speed_range;
+    state.angle = unit(rng) * config.start_angle_range;
+    state.angVel = 0.f;
+    state.wind = {0.f, 0.f};
+
+    vehicle.rocket.restoreState(state);
+    vehicle.flight.sync(vehicle.rocket);
+    vehicle.contacts.setManifold({});
+    vehicle.time = 0.f;
+    vehicle.rest_time = 0.f;
+    vehicle.potential = potential(vehicle.rocket);
+    vehicle.wind_phase =
+        wind ? (unit(rng) + 1.f) / 2.f * wind->getPeriod() : 0.f;
+  }
+
+  void observe(const Vehicle &vehicle, float *obs) const {
+    const auto &rocket = vehicle.rocket;
+    obs[0] = rocket.getPos().x - target_x;
+    obs[1] = target_y - rocket.getPos().y;
+    obs[2] = rocket.getVel().x;
+    obs[3] = rocket.getVel().y;
+    obs[4] = rocket.getAngle();
+    obs[5] = rocket.getAngularVel();
+    obs[6] = rocket.getFuelMass();
+    obs[7] = rocket.getBottomBooster().curr_output;
+    obs[8] = rocket.getLeftBooster().curr_output;
+    obs[9] = rocket.getRightBooster().curr_output;
+    obs[10] = vehicle.contacts.getManifold().count > 0 ? 1.f : 0.f;
+  }
+
+  void applyWind(Vehicle &vehicle) const {
+    if (!wind && wind_params.speed == 0.f)
+      return;
+
+    WindParams params = wind_params;
+    params.phase += vehicle.wind_phase;
+    const auto &pos = vehicle.rocket.getPos();
+    vehicle.rocket.setWind(
+        wind ? wind->sample(params, pos, vehicle.time)
+             : sf::Vector2f{WindField::meanSpeed(params, pos.y), 0.f});
+  }
+
+  // One rocket_env_step of one vehicle; resets it when the episode ends.
+  void step(Vehicle &vehicle, const float *action, float *obs, float *reward,
+            std::uint8_t *done) {
+    auto &rocket = vehicle.rocket;
+    const float fuel = rocket.getFuelMass();
+
+    float throttle[ROCKET_ENV_ACTION_SIZE];
+    for (int k = 0; k < ROCKET_ENV_ACTION_SIZE; k++)
+      // Also maps NaN to 0.
+      throttle[k] = action[k] > 0.f ? std::min(action[k], 1.f) : 0.f;
+
+    ControlInput input;
+    input.bottom = throttle[0] > 0.f;
+    input.left = throttle[1] > 0.f;
+    input.right = throttle[2] > 0.f;
+    input.dBottomOut = throttle[0] * config.max_main_output -
+                       rocket.getBottomBooster().target_output;
+    input.dLeftOut = throttle[1] * config.max_side_output -
+                     rocket.getLeftBooster().target_output;
+    input.dRightOut = throttle[2] * config.max_side_output -
+                      rocket.getRightBooster().target_output;
+
+    float r = 0.f;
+    std::uint8_t ended = 0;
+    for (std::uint32_t k = 0; k < config.action_repeat && !ended; k++) {
+      applyWind(vehicle);
+      const auto contact =
+          vehicle.flight.step(vehicle.contacts, rocket, input, config.dt);
+      // The targets are set; only the firing flags repeat.
+      input.dBottomOut = input.dLeftOut = input.dRightOut = 0.f;
+      vehicle.time += config.dt;
+
+      const auto &pos = rocket.getPos();
+      if (contact.impact_len_vel > config.crash_speed * config.crash_speed ||
+          pos.x < min_x || pos.x > max_x || pos.y < target_y - CEILING ||
+          !std::isfinite(pos.x) || !std::isfinite(pos.y)) {
+        r += CRASH_REWARD;
+        ended = ROCKET_ENV_TERMINATED;
+        break;
+      }
+
+      const bool resting =
+          vehicle.contacts.getManifold().count > 0 &&
+          rocket.getLenVel() < REST_SPEED * REST_SPEED &&
+          std::abs(rocket.getAngularVel()) < REST_ANGULAR_SPEED;
+      vehicle.rest_time = resting ? vehicle.rest_time + config.dt : 0.f;
+      if (vehicle.rest_time >= REST_TIME) {
+        if (std::abs(rocket.getAngle()) > config.landing_angle)
+          r += CRASH_REWARD;
+        else if (pos.x >= pad_left && pos.x <= pad_right)
+          r += LANDING_REWARD;
+        else
+          r += OFF_PAD_REWARD;
+        ended = ROCKET_ENV_TERMINATED;
+      } else if (vehicle.time >= config.max_time) {
+        ended = ROCKET_ENV_TRUNCATED;
+      }
+    }
+
+    const float potential_now = potential(rocket);
+    r += potential_now - vehicle.potential;
+    r -= FUEL_COST * (fuel - rocket.getFuelMass());
+    vehicle.potential = potential_now;
+
+    *reward = r;
+    *done = ended;
+    if (ended) {
+      vehicle.episode++;
+      reset(vehicle);
+    }
+    observe(vehicle, obs);
+  }
+
+  template <typename F> void forEachChunk(F &&fn) {
+    const std::size_t chunks = (vehicles.size() + CHUNK - 1) / CHUNK;
+    pool.parallelFor(chunks, [&](std::size_t c, unsigned) {
+      const auto end = std::min(vehicles.size(), (c + 1) * CHUNK);
+      for (auto i = c * CHUNK; i < end; i++)
+        fn(i);
+    });
+  }
+};
+
+extern "C" {
+
+int rocket_env_abi_version(void) { return ROCKET_ENV_ABI_VERSION; }
+
+void rocket_env_default_config(RocketEnvConfig *config) {
+  if (!config)
+    return;
+
+  *config = {};
+  config->count = 1;
+  config->threads = 0;
+  config->dt = 1.f / 120.f;
+  config->action_repeat = 4;
+  config->max_time = 30.f;
+  config->max_main_output = 10.f;
+  config->max_side_output = 1.f;
+  config->start_height = 8.333f;
+  config->start_height_range = 2.5f;
+  config->start_x_range = 5.f;
+  config->start_speed_range = 0.6667f;
+  config->start_angle_range = 0.2f;
+  config->crash_speed = CRASH_SPEED;
+  config->landing_angle = 0.2f;
+}
+
+RocketEnv *rocket_env_create(const RocketEnvConfig *config) {
+  if (!config) {
+    fail("rocket_env_create: config is NULL");
+    return nullptr;
+  }
+  if (config->count == 0 || !(config->dt > 0.f) ||
+      config->action_repeat == 0 || !(config->max_time > 0.f)) {
+    fail("rocket_env_create: count, dt, action_repeat and max_time must be "
+         "positive");
+    return nullptr;
+  }
+
+  try {
+    ScenarioFile scenario;
+    scenario.base = defaultScenario(SITE_WIDTH, SITE_HEIGHT);
+    if (config->scenario)
+      scenario = ScenarioFile::load(config->scenario, SITE_WIDTH, SITE_HEIGHT);
+
+    Terrain terrain = config->terrain ? Terrain::load(config->terrain)
+                                      : createTerrain(SITE_WIDTH, SITE_HEIGHT);
+    if (terrain.getPads().empty())
+      throw std::runtime_error("Terrain has no landing pad");
+
+    RocketEnvConfig resolved = *config;
+    if (resolved.threads == 0)
+      resolved.threads = std::max(1u, std::thread::hardware_concurrency());
+
+    auto *env = new RocketEnv(resolved, scenario.base, std::move(terrain),
+                              scenario.windField());
+    for (std::uint32_t i = 0; i < env->config.count; i++)
+      env->vehicles[i].seed = i;
+    for (auto &vehicle : env->vehicles)
+      env->reset(vehicle);
+    return env;
+  } catch (const std::exception &e) {
+    fail(e.what());
+    return nullptr;
+  }
+}
+
+void rocket_env_destroy(RocketEnv *env) { delete env; }
+
+uint32_t rocket_env_count(const RocketEnv *env) {
+  return env ? env->config.count : 0;
+}
+
+int rocket_env_reset(RocketEnv *env, const uint64_t *seeds, float *obs) {
+  if (!env || !obs)
+    return fail("rocket_env_reset: env and obs must not be NULL");
+
+  env->forEachChunk([&](std::size_t i) {
+    auto &vehicle = env->vehicles[i];
+    vehicle.seed = seeds ? seeds[i] : i;
+    vehicle.episode = 0;
+    env->reset(vehicle);
+    env->observe(vehicle, obs + i * ROCKET_ENV_OBS_SIZE);
+  });
+  return 0;
+}
+
+int rocket_env_step(RocketEnv *env, const float *actions, float *obs,
+                    float *rewards, uint8_t *dones) {
+  if (!env || !actions || !obs || !rewards || !dones)
+    return fail("rocket_env_step: arguments must not be NULL");
+
+  env->forEachChunk([&](std::size_t i) {
+    env->step(env->vehicles[i], actions + i * ROCKET_ENV_ACTION_SIZE,
+              obs + i * ROCKET_ENV_OBS_SIZE, rewards + i, dones + i);
+  });
+  return 0;
+}
+
+const char *rocket_env_last_error(void) { return last_error.c_str(); }
+
+} // extern "C"
@@ -0,0 +1,436 @@
+#include "../include/scenario.hpp"
+#include "../include/world.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+const char SWEEP_MAGIC[4] = {'R', 'K', 'S', 'W'};
+const std::uint32_t SWEEP_VERSION = 1;
+const float SCENARIO_DT = 1.f / 120.f;
+
+template <typename T> void writeValue(std::ofstream &out, T value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+#define SCENARIO_PARAM(name, field)                                            \
+  { name, [](Scenario &s) -> float & { return s.field; } }
+
+} // namespace
+
+const ScenarioParam SCENARIO_PARAMS[] = {
+    SCENARIO_PARAM("rocket_width", rocket.rocket_width),
+    SCENARIO_PARAM("body_height", rocket.body_height),
+    SCENARIO_PARAM("nose_height", rocket.nose_height),
+    SCENARIO_PARAM("side_thruster_y", rocket.side_thruster_y),
+    SCENARIO_PARAM("side_thruster_w", rocket.side_thruster_w),
+    SCENARIO_PARAM("side_thruster_h", rocket.side_thruster_h),
+    SCENARIO_PARAM("bottom_thruster_x", rocket.bottom_thruster_x),
+    SCENARIO_PARAM("bottom_thruster_w", rocket.bottom_thruster_w),
+    SCENARIO_PARAM("bottom_thruster_h", rocket.bottom_thruster_h),
+    SCENARIO_PARAM("gamma", rocket.gamma),
+    SCENARIO_PARAM("side_min_ae", rocket.side_min_ae),
+    SCENARIO_PARAM("side_min_at", rocket.side_min_at),
+    SCENARIO_PARAM("side_max_ae", rocket.side_max_ae),
+    SCENARIO_PARAM("side_max_at", rocket.side_max_at),
+    SCENARIO_PARAM("bottom_min_ae", rocket.bottom_min_ae),
+    SCENARIO_PARAM("bottom_min_at", rocket.bottom_min_at),
+    SCENARIO_PARAM("bottom_max_ae", rocket.bottom_max_ae),
+    SCENARIO_PARAM("bottom_max_at", rocket.bottom_max_at),
+    SCENARIO_PARAM("fuel_t0", rocket.fuel_t0),
+    SCENARIO_PARAM("fuel_molar_mass", rocket.fuel_molar_mass),
+    SCENARIO_PARAM("booster_delay", rocket.booster_delay),
+    SCENARIO_PARAM("body_mass", rocket.body_mass),
+    SCENARIO_PARAM("body_x", rocket.body_x),
+    SCENARIO_PARAM("body_y", rocket.body_y),
+    SCENARIO_PARAM("nose_mass", rocket.nose_mass),
+    SCENARIO_PARAM("nose_x", rocket.nose_x),
+    SCENARIO_PARAM("nose_y", rocket.nose_y),
+    SCENARIO_PARAM("tank_mass", rocket.tank_mass),
+    SCENARIO_PARAM("tank_x", rocket.tank_x),
+    SCENARIO_PARAM("tank_y", rocket.tank_y),
+    SCENARIO_PARAM("stage_fuel", rocket.stage_fuel),
+    SCENARIO_PARAM("stage_dry_mass", rocket.stage_dry_mass),
+    SCENARIO_PARAM("stage_x", rocket.stage_x),
+    SCENARIO_PARAM("stage_y", rocket.stage_y),
+    SCENARIO_PARAM("stage_width", rocket.stage_width),
+    SCENARIO_PARAM("stage_height", rocket.stage_height),
+    SCENARIO_PARAM("start_x", rocket.start_x),
+    SCENARIO_PARAM("start_y", rocket.start_y),
+    SCENARIO_PARAM("start_vx", rocket.start_vx),
+    SCENARIO_PARAM("start_vy", rocket.start_vy),
+    SCENARIO_PARAM("start_angle", rocket.start_angle),
+    SCENARIO_PARAM("throttle", throttle),
+    SCENARIO_PARAM("burn_time", burn_time),
+    SCENARIO_PARAM("duration", duration),
+    SCENARIO_PARAM("stage_time", stage_time),
+    SCENARIO_PARAM("rebase_distance", rebase_distance),
+    SCENARIO_PARAM("wind_speed", wind.speed),
+    SCENARIO_PARAM("wind_reference_height", wind.reference_height),
+    SCENARIO_PARAM("wind_shear", wind.shear),
+    SCENARIO_PARAM("wind_ground_y", wind.ground_y),
+    SCENARIO_PARAM("wind_gust", wind.gust),
+    SCENARIO_PARAM("wind_phase", wind.phase)};
+
+const std::size_t SCENARIO_PARAM_COUNT =
+    sizeof(SCENARIO_PARAMS) / sizeof(SCENARIO_PARAMS[0]);
+
+const char *const SCENARIO_METRICS[SCENARIO_METRIC_COUNT] = {
+    "max_height", "max_speed",   "impact_speed",
+    "fuel_used",  "final_x",     "final_y",
+    "final_angle", "rest_time",  "on_pad"};
+
+static_assert(sizeof(ScenarioResult) == SCENARIO_METRIC_COUNT * sizeof(float),
+              "ScenarioResult is written as SCENARIO_METRICS floats");
+
+Scenario defaultScenario(float siteW, float siteH) {
+  Scenario scenario;
+  scenario.rocket = defaultRocketParams(siteW, siteH);
+  scenario.wind.ground_y = siteH;
+  return scenario;
+}
+
+std::size_t findScenarioParam(const std::string &name) {
+  for (std::size_t i = 0; i < SCENARIO_PARAM_COUNT; i++)
+    if (name == SCENARIO_PARAMS[i].name)
+      return i;
+  throw std::runtime_error("Unknown scenario parameter " + name);
+}
+
+std::size_t Sweep::size() const {
+  switch (kind) {
+  case SweepKind::CARTESIAN: {
+    std::size_t runs = 1;
+    for (const auto &axis : axes)
+      runs *= axis.count;
+    return runs;
+  }
+  case SweepKind::LATIN_HYPERCUBE:
+    return samples;
+  default:
+    return 1;
+  }
+}
+
+std::vector<float> Sweep::expand() const {
+  const std::size_t runs = size();
+  const std::size_t dims = axes.size();
+  std::vector<float> design(runs * dims);
+
+  if (kind == SweepKind::CARTESIAN) {
+    // Mixed radix: the last axis changes fastest.
+    for (std::size_t i = 0; i < runs; i++) {
+      std::size_t rest = i;
+      for (std::size_t d = dims; d-- > 0;) {
+        const auto &axis = axes[d];
+        const std::size_t k = rest % axis.count;
+        rest /= axis.count;
+
+        const float t =
+            axis.count > 1 ? static_cast<float>(k) / (axis.count - 1) : 0.f;
+        design[i * dims + d] = axis.from + (axis.to - axis.from) * t;
+      }
+    }
+  } else if (kind == SweepKind::LATIN_HYPERCUBE) {
+    // Each axis is cut in runs strata and every stratum is used once, at
+    // a random point inside it.
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> jitter(0.f, 1.f);
+    std::vector<std::size_t> strata(runs);
+
+    for (std::size_t d = 0; d < dims; d++) {
+      std::iota(strata.begin(), strata.end(), 0);
+      std::shuffle(strata.begin(), strata.end(), rng);
+
+      const auto &axis = axes[d];
+      for (std::size_t i = 0; i < runs; i++) {
+        const float t = (strata[i] + jitter(rng)) / runs;
+        design[i * dims + d] = axis.from + (axis.to - axis.from) * t;
+      }
+    }
+  }
+
+  return design;
+}
+
+ScenarioFile ScenarioFile::load(const std::string &path, float siteW,
+                                float siteH) {
+  std::ifstream in(path);
+  if (!in)
+    throw std::runtime_error("Cannot open scenario file " + path);
+
+  std::stringstream text;
+  text << in.rdbuf();
+  return parse(text.str(), siteW, siteH);
+}
+
+ScenarioFile ScenarioFile::parse(const std::string &text, float siteW,
+                                 float siteH) {
+  ScenarioFile file;
+  file.base = defaultScenario(siteW, siteH);
+
+  std::istringstream lines(text);
+  std::string line;
+  int number = 0;
+
+  while (std::getline(lines, line)) {
+    number++;
+    line = line.substr(0, line.find('#'));
+    for (auto &c : line)
+      if (c == '=')
+        c = ' ';
+
+    std::istringstream words(line);
+    std::string key;
+    if (!(words >> key))
+      continue;
+
+    const auto fail = [&](const std::string &what) {
+      return std::runtime_error("Scenario line " + std::to_string(number) +
+                                ": " + what);
+    };
+
+    if (key == "sweep") {
+      std::string kind;
+      words >> kind;
+      if (kind == "cartesian")
+        file.sweep.kind = SweepKind::CARTESIAN;
+      else if (kind == "lhs" && words >> file.sweep.samples &&
+               file.sweep.samples > 0)
+        file.sweep.kind = SweepKind::LATIN_HYPERCUBE;
+      else
+        throw fail("expected 'sweep cartesian' or 'sweep lhs SAMPLES'");
+    } else if (key == "seed") {
+      if (!(words >> file.sweep.seed))
+        throw fail("expected 'seed N'");
+    } else if (key == "wind_seed") {
+      if (!(words >> file.wind_seed))
+        throw fail("expected 'wind_seed N'");
+    } else if (key == "precision") {
+      std::string name;
+      if (!(words >> name))
+        throw fail("expected 'precision float|double|fixed'");
+      try {
+        file.base.precision = parsePrecision(name);
+      } catch (const std::runtime_error &e) {
+        throw fail(e.what());
+      }
+    } else if (key == "vary") {
+      std::string name;
+      SweepAxis axis{};
+      if (!(words >> name >> axis.from >> axis.to))
+        throw fail("expected 'vary NAME FROM TO [COUNT]'");
+      if (!(words >> axis.count))
+        axis.count = 2;
+      if (axis.count == 0)
+        throw fail("an axis needs at least one point");
+
+      axis.param = findScenarioParam(name);
+      file.sweep.axes.push_back(axis);
+    } else if (key == "monte_carlo") {
+      if (!(words >> file.monte_carlo.samples))
+        throw fail("expected 'monte_carlo SAMPLES'");
+    } else if (key == "disperse") {
+      std::string name, kind;
+      Dispersion dispersion{};
+      if (!(words >> name >> kind >> dispersion.spread))
+        throw fail("expected 'disperse NAME normal|uniform SPREAD'");
+      if (kind == "normal")
+        dispersion.kind = DispersionKind::NORMAL;
+      else if (kind == "uniform")
+        dispersion.kind = DispersionKind::UNIFORM;
+      else
+        throw fail("unknown dispersion '" + kind + "'");
+
+      dispersion.param = findScenarioParam(name);
+      file.monte_carlo.dispersions.push_back(dispersion);
+    } else {
+      float value;
+      if (!(words >> value))
+        throw fail("expected 'NAME = VALUE'");
+
+      auto &mc = file.monte_carlo;
+      if (key == "success_speed")
+        mc.success_speed = value;
+      else if (key == "success_angle")
+        mc.success_angle = value;
+      else if (key == "target_x")
+        mc.target_x = value;
+      else if (key == "histogram_x")
+        mc.histogram_x = value;
+      else if (key == "histogram_speed")
+        mc.histogram_speed = value;
+      else
+        SCENARIO_PARAMS[findScenarioParam(key)].field(file.base) = value;
+    }
+  }
+
+  if (file.sweep.kind != SweepKind::NONE && file.sweep.axes.empty())
+    throw std::runtime_error("Scenario sweep has no 'vary' axis");
+
+  return file;
+}
+
+Scenario ScenarioFile::at(const float *values) const {
+  Scenario scenario = base;
+  for (std::size_t d = 0; d < sweep.axes.size(); d++)
+    SCENARIO_PARAMS[sweep.axes[d].param].field(scenario) = values[d];
+  return scenario;
+}
+
+std::unique_ptr<WindField> ScenarioFile::windField() const {
+  const auto gust = findScenarioParam("wind_gust");
+  bool gusty = base.wind.gust != 0.f;
+  for (const auto &axis : sweep.axes)
+    gusty |= axis.param == gust;
+  for (const auto &dispersion : monte_carlo.dispersions)
+    gusty |= dispersion.param == gust;
+
+  return gusty ? std::make_unique<WindField>(wind_seed) : nullptr;
+}
+
+ScenarioResult runScenario(const Scenario &scenario, const Terrain &terrain,
+                           const WindField *wind) {
+  World world(terrain, 1, scenario.precision);
+  world.addVehicle(createRocket(scenario.rocket));
+  const auto &params = scenario.rocket;
+  const bool staged = params.stage_dry_mass > 0.f;
+  if (staged)
+    world.addStage(0, 1, createStage(params),
+                   {params.stage_x, params.stage_y});
+  world.setWind(wind, scenario.wind);
+  world.rebase_distance = scenario.rebase_distance;
+  const Rocket &rocket = world.getVehicle(0);
+
+  ScenarioResult result{};
+  result.rest_time = -1.f;
+  const double start_y = world.getWorldPos(0).y;
+  const float start_fuel = rocket.getFuelMass();
+
+  const auto ticks = static_cast<long>(scenario.duration / SCENARIO_DT);
+  for (long t = 0; t < ticks; t++) {
+    const bool burning = t * SCENARIO_DT < scenario.burn_time;
+
+    ControlInput input;
+    input.bottom = burning;
+    input.dBottomOut = (burning ? scenario.throttle : 0.f) -
+                       rocket.getBottomBooster().target_output;
+    if (staged && scenario.stage_time >= 0.f && world.isMounted(1) &&
+        t * SCENARIO_DT >= scenario.stage_time)
+      input.stage = 1;
+    world.setInput(0, input);
+    world.step(SCENARIO_DT);
+
+    const auto &contact = world.getContact(0);
+    if (contact.touched)
+      result.impact_speed = std::max(result.impact_speed,
+                                     std::sqrt(contact.impact_len_vel));
+
+    const double height = start_y - world.getWorldPos(0).y;
+    result.max_height =
+        std::max(result.max_height, static_cast<float>(height));
+    result.max_speed =
+        std::max(result.max_speed, std::sqrt(rocket.getLenVel()));
+
+    if (!burning && world.isSleeping(0)) {
+      result.rest_time = (t + 1) * SCENARIO_DT;
+      break;
+    }
+  }
+
+  // What a separated stage took away was not burned.
+  const float dropped =
+      staged && !world.isMounted(1) ? world.getVehicle(1).getFuelMass() : 0.f;
+  result.fuel_used = start_fuel - rocket.getFuelMass() - dropped;
+  const auto end = world.getWorldPos(0);
+  result.final_x = static_cast<float>(end.x);
+  result.final_y = static_cast<float>(end.y);
+  result.final_angle = rocket.getAngle();
+  for (const auto &pad : terrain.getPads())
+    if (result.final_x >= pad.left && result.final_x <= pad.left + pad.width)
+      result.on_pad = 1.f;
+
+  return result;
+}
+
+SweepWriter::SweepWriter(const std::string &path, const Sweep &sweep)
+    : out(path, std::ios::binary), params(sweep.axes.size()) {
+  if (!out)
+    throw std::runtime_error("Cannot write sweep file " + path);
+
+  csv = path.size() >= 4 && path.compare(path.size() - 4, 4, ".csv") == 0;
+
+  std::vector<const char *> names;
+  for (const auto &axis : sweep.axes)
+    names.push_back(SCENARIO_PARAMS[axis.param].name);
+  names.insert(names.end(), SCENARIO_METRICS,
+               SCENARIO_METRICS + SCENARIO_METRIC_COUNT);
+
+  if (csv) {
+    out << "run,status";
+    for (const auto *name : names)
+      out << ',' << name;
+    out << '\n';
+  } else {
+    out.write(SWEEP_MAGIC, 4);
+    writeValue(out, SWEEP_VERSION);
+    writeValue(out, static_cast<std::uint32_t>(params));
+    writeValue(out, static_cast<std::uint32_t>(SCENARIO_METRIC_COUNT));
+    for (const auto *name : names) {
+      const auto len = static_cast<std::uint8_t>(std::strlen(name));
+      writeValue(out, len);
+      out.write(name, len);
+    }
+  }
+}
+
+SweepWriter::~SweepWriter() { close(); }
+
+void SweepWriter::write(std::uint32_t run, const float *values,
+                        const ScenarioResult *result) {
+  float metrics[SCENARIO_METRIC_COUNT];
+  if (result)
+    std::memcpy(metrics, result, sizeof(metrics));
+  else
+    std::fill(metrics, metrics + SCENARIO_METRIC_COUNT,
+              std::numeric_limits<float>::quiet_NaN());
+  const std::uint32_t status = result ? 0 : 1;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!out.is_open())
+    return;
+
+  if (csv) {
+    out << run << ',' << status;
+    for (std::size_t i = 0; i < params; i++)
+      out << ',' << values[i];
+    for (const float metric : metrics)
+      out << ',' << metric;
+    out << '\n';
+  } else {
+    writeValue(out, run);
+    writeValue(out, status);
+    out.write(reinterpret_cast<const char *>(values), params * sizeof(float));
+    out.write(reinterpret_cast<const char *>(metrics), sizeof(metrics));
+  }
+
+  if (!out)
+    write_failed = true;
+}
+
+void SweepWriter::close() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!out.is_open())
+    return;
+
+  out.close();
+  if (!out)
+    write_failed = true;
+}
@@ -0,0 +1,146 @@
+#include "../include/simulation.hpp"
+
+#include <stdexcept>
+
+RocketParams defaultRocketParams(float siteW, float siteH) {
+  RocketParams p;
+
+  p.rocket_width = 0.6667f;
+  p.body_height = 2.333f;
+  p.nose_height = 1.f;
+  p.side_thruster_y = 0.8333f;
+  p.side_thruster_w = 0.1667f;
+  p.side_thruster_h = 0.4167f;
+  p.bottom_thruster_x = 0.25f;
+  p.bottom_thruster_w = 0.1667f;
+  p.bottom_thruster_h = 0.4167f;
+
+  p.gamma = 1.22f;
+  p.side_min_ae = 0.00001f;
+  p.side_min_at = 0.0002f;
+  p.side_max_ae = 0.00008f;
+  p.side_max_at = 0.0008f;
+  p.bottom_min_ae = 0.00001f;
+  p.bottom_min_at = 0.0002f;
+  p.bottom_max_ae = 0.0005f;
+  p.bottom_max_at = 0.0004f;
+  p.fuel_t0 = 3200.f;
+  p.fuel_molar_mass = 22.f;
+  p.booster_delay = 0.6f;
+
+  p.body_mass = 100.f;
+  p.body_x = 0.3333f;
+  p.body_y = 1.167f;
+  p.nose_mass = 100.f;
+  p.nose_x = 0.3333f;
+  p.nose_y = -0.3333f;
+  p.tank_mass = 80.f;
+  p.tank_x = 0.3333f;
+  p.tank_y = 1.833f;
+
+  p.stage_fuel = 0.f;
+  p.stage_dry_mass = 0.f;
+  // Under the main engine.
+  p.stage_x = 0.f;
+  p.stage_y = 2.75f;
+  p.stage_width = 0.6667f;
+  p.stage_height = 1.f;
+
+  p.start_x = siteW * 0.5f;
+  p.start_y = siteH * 0.6f;
+  p.start_vx = 0.f;
+  p.start_vy = 0.f;
+  p.start_angle = 0.f;
+  return p;
+}
+
+namespace {
+
+bool hasStage(const RocketParams &p) {
+  if (p.stage_dry_mass <= 0.f && p.stage_fuel > 0.f)
+    throw std::runtime_error("A stage with fuel needs dry mass");
+  return p.stage_dry_mass > 0.f;
+}
+
+void configureBoosters(Rocket &rocket, const RocketParams &p) {
+  rocket.configureSideBooster(p.gamma, p.side_min_ae, p.side_min_at,
+                              p.side_max_ae, p.side_max_at, p.bottom_min_ae,
+                              p.bottom_min_at, p.bottom_max_ae,
+                              p.bottom_max_at);
+
+  rocket.setBoosterFuel(p.fuel_t0, p.fuel_molar_mass);
+  rocket.setBoosterDelay(p.booster_delay);
+
+  rocket.setBoosterOutputs(0.f, 0.f, 0.f);
+}
+
+} // namespace
+
+Rocket createRocket(const RocketParams &p) {
+  Rocket rocket(p.rocket_width, p.body_height, p.nose_height);
+
+  rocket.setBody(sf::Color(220, 220, 220));
+  rocket.setNose(sf::Color(200, 80, 80));
+  rocket.setSideThrusters(p.side_thruster_y, p.side_thruster_w,
+                          p.side_thruster_h, sf::Color(240, 200, 60));
+  rocket.setBottomThrusters(p.bottom_thruster_x, p.bottom_thruster_w,
+                            p.bottom_thruster_h, sf::Color(240, 200, 60));
+
+  configureBoosters(rocket, p);
+
+  rocket.addComponent({p.body_mass, {p.body_x, p.body_y}, /*I_local*/ 0.f});
+  rocket.addComponent({p.nose_mass, {p.nose_x, p.nose_y}, /*I_local*/ 0.f});
+  rocket.addComponent(
+      {p.tank_mass, {p.tank_x, p.tank_y}, /*I_local*/ 0.f, FEEDS_ALL});
+  if (hasStage(p)) {
+    const sf::Vector2f centre = {p.stage_x + p.stage_width / 2.f,
+                                 p.stage_y + p.stage_height / 2.f};
+    const float box = p.stage_width * p.stage_width +
+                      p.stage_height * p.stage_height;
+    rocket.addComponent(
+        {p.stage_dry_mass, centre, p.stage_dry_mass * box / 12.f, 0, 1});
+    rocket.addComponent(
+        {p.stage_fuel, centre, /*I_local*/ 0.f, FEEDS_BOTTOM, 1});
+  }
+  rocket.setInitialPosition(p.start_x, p.start_y);
+
+  if (p.start_vx != 0.f || p.start_vy != 0.f || p.start_angle != 0.f) {
+    SimState state = rocket.getState();
+    state.vel = {p.start_vx, p.start_vy};
+    state.angle = p.start_angle;
+    rocket.restoreState(state);
+  }
+  return rocket;
+}
+
+Rocket createRocket(float siteW, float siteH) {
+  return createRocket(defaultRocketParams(siteW, siteH));
+}
+
+Rocket createStage(const RocketParams &p) {
+  Rocket stage(p.stage_width, p.stage_height, 0.f);
+  stage.setBody(sf::Color(220, 220, 220));
+  configureBoosters(stage, p);
+  return stage;
+}
+
+float getLandingHeight(const Rocket &rocket) {
+  Rocket upright = rocket;
+  SimState state = rocket.getState();
+  state.angle = 0.f;
+  upright.restoreState(state);
+
+  const auto bounds = upright.getBounds();
+  return bounds.top + bounds.height - upright.getPos().y;
+}
+
+SimState interpolateState(const SimState &a, const SimState &b, float alpha) {
+  SimState state = b;
+
+  state.pos = a.pos + (b.pos - a.pos) * alpha;
+  state.angle = a.angle + (b.angle - a.angle) * alpha;
+  state.rocket_prop.r_cm =
+      a.rocket_prop.r_cm + (b.rocket_prop.r_cm - a.rocket_prop.r_cm) * alpha;
+
+  return state;
+}
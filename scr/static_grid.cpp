@@ -0,0 +1,47 @@
+#include "../include/static_grid.hpp"
+
+#include <cmath>
+
+void StaticGrid::build(const std::vector<sf::FloatRect> &bounds,
+                       float cell_size) {
+  this->bounds = bounds;
+  cell = cell_size;
+  cell_start.clear();
+  items.clear();
+  columns = rows = 0;
+
+  if (bounds.empty())
+    return;
+
+  float left = bounds[0].left, top = bounds[0].top;
+  float right = left + bounds[0].width, bottom = top + bounds[0].height;
+  for (const auto &b : bounds) {
+    left = std::min(left, b.left);
+    top = std::min(top, b.top);
+    right = std::max(right, b.left + b.width);
+    bottom = std::max(bottom, b.top + b.height);
+  }
+
+  origin = {left, top};
+  columns = static_cast<int>(std::floor((right - left) / cell)) + 1;
+  rows = static_cast<int>(std::floor((bottom - top) / cell)) + 1;
+
+  // Count per cell, prefix sum, then fill.
+  cell_start.assign(static_cast<std::size_t>(columns) * rows + 1, 0);
+
+  const auto forCells = [&](const sf::FloatRect &b, auto &&fn) {
+    for (int y = row(b.top); y <= row(b.top + b.height); y++)
+      for (int x = column(b.left); x <= column(b.left + b.width); x++)
+        fn(static_cast<std::size_t>(y) * columns + x);
+  };
+
+  for (const auto &b : bounds)
+    forCells(b, [&](std::size_t c) { cell_start[c + 1]++; });
+  for (std::size_t c = 1; c < cell_start.size(); c++)
+    cell_start[c] += cell_start[c - 1];
+
+  items.resize(cell_start.back());
+  std::vector<std::uint32_t> fill(cell_start.begin(), cell_start.end() - 1);
+  for (std::uint32_t i = 0; i < bounds.size(); i++)
+    forCells(bounds[i], [&](std::size_t c) { items[fill[c]++] = i; });
+}
@@ -0,0 +1,161 @@
+#include "../include/telemetry.hpp"
+
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+
+const char TELEMETRY_MAGIC[4] = {'R', 'K', 'T', 'L'};
+const std::uint32_t TELEMETRY_VERSION = 2;
+const std::size_t COLUMN_NAME_SIZE = 24;
+
+template <typename T> void writeValue(std::ofstream &out, T value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+} // namespace
+
+const TelemetryColumnInfo TELEMETRY_COLUMNS[TM_COLUMN_COUNT] = {
+    {"tick", TM_U32},          {"pos_x", TM_F32},
+    {"pos_y", TM_F32},         {"vel_x", TM_F32},
+    {"vel_y", TM_F32},         {"angle", TM_F32},
+    {"ang_vel", TM_F32},       {"force_x", TM_F32},
+    {"force_y", TM_F32},       {"mass", TM_F32},
+    {"cm_x", TM_F32},          {"cm_y", TM_F32},
+    {"left_output", TM_F32},   {"left_mach", TM_F32},
+    {"left_pe", TM_F32},       {"left_vexit", TM_F32},
+    {"right_output", TM_F32},  {"right_mach", TM_F32},
+    {"right_pe", TM_F32},      {"right_vexit", TM_F32},
+    {"bottom_output", TM_F32}, {"bottom_mach", TM_F32},
+    {"bottom_pe", TM_F32},     {"bottom_vexit", TM_F32},
+    {"contact", TM_U32},       {"impact_len_vel", TM_F32},
+    {"substeps", TM_U32}};
+
+TelemetryRecorder::TelemetryRecorder(const std::string &path, float dt)
+    : out(path, std::ios::binary) {
+  if (!out)
+    throw std::runtime_error("Cannot write telemetry file " + path);
+
+  out.write(TELEMETRY_MAGIC, 4);
+  writeValue(out, TELEMETRY_VERSION);
+  writeValue(out, dt);
+  writeValue(out, static_cast<std::uint32_t>(TM_COLUMN_COUNT));
+  writeValue(out, BLOCK_CAPACITY);
+
+  for (const auto &column : TELEMETRY_COLUMNS) {
+    char name[COLUMN_NAME_SIZE] = {};
+    std::strncpy(name, column.name, COLUMN_NAME_SIZE - 1);
+    out.write(name, COLUMN_NAME_SIZE);
+    writeValue(out, static_cast<std::uint32_t>(column.type));
+  }
+
+  writer = std::thread([this] { writerLoop(); });
+}
+
+TelemetryRecorder::~TelemetryRecorder() { close(); }
+
+void TelemetryRecorder::record(std::uint32_t tick, const Rocket &rocket,
+                               const SweptStep &contact) {
+  auto &block = *filling;
+  auto &row = block.rows[block.count];
+  const auto put = [&](TelemetryColumn column, float value) {
+    row[column] = std::bit_cast<std::uint32_t>(value);
+  };
+
+  row[TM_TICK] = tick;
+  put(TM_POS_X, rocket.getPos().x);
+  put(TM_POS_Y, rocket.getPos().y);
+  put(TM_VEL_X, rocket.getVel().x);
+  put(TM_VEL_Y, rocket.getVel().y);
+  put(TM_ANGLE, rocket.getAngle());
+  put(TM_ANG_VEL, rocket.getAngularVel());
+  put(TM_FORCE_X, rocket.getForce().x);
+  put(TM_FORCE_Y, rocket.getForce().y);
+  put(TM_MASS, rocket.getMass());
+  put(TM_CM_X, rocket.getCm().x);
+  put(TM_CM_Y, rocket.getCm().y);
+
+  const RocketBooster *boosters[3] = {&rocket.getLeftBooster(),
+                                      &rocket.getRightBooster(),
+                                      &rocket.getBottomBooster()};
+  for (std::uint32_t i = 0; i < 3; i++) {
+    const auto first = static_cast<TelemetryColumn>(TM_LEFT_OUTPUT + 4 * i);
+    put(first, boosters[i]->curr_output);
+    put(static_cast<TelemetryColumn>(first + 1), boosters[i]->Mach);
+    put(static_cast<TelemetryColumn>(first + 2), boosters[i]->Pe);
+    put(static_cast<TelemetryColumn>(first + 3), boosters[i]->Vexit);
+  }
+
+  row[TM_CONTACT] = contact.touched ? 1u : 0u;
+  put(TM_IMPACT_LEN_VEL, contact.touched ? contact.impact_len_vel : 0.f);
+  row[TM_SUBSTEPS] = static_cast<std::uint32_t>(contact.substeps);
+
+  records++;
+  if (++block.count == BLOCK_CAPACITY)
+    submit();
+}
+
+void TelemetryRecorder::close() {
+  if (!writer.joinable())
+    return;
+
+  if (filling->count > 0)
+    submit();
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stop = true;
+  }
+  ready.notify_one();
+  writer.join();
+  out.flush();
+}
+
+void TelemetryRecorder::submit() {
+  std::unique_lock<std::mutex> lock(mutex);
+  if (pending) {
+    stalls++;
+    drained.wait(lock, [this] { return pending == nullptr; });
+  }
+
+  pending = filling;
+  filling = filling == &blocks[0] ? &blocks[1] : &blocks[0];
+  filling->count = 0;
+  lock.unlock();
+
+  ready.notify_one();
+}
+
+void TelemetryRecorder::writerLoop() {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  for (;;) {
+    ready.wait(lock, [this] { return pending != nullptr || stop; });
+    if (!pending)
+      return;
+
+    const Block *block = pending;
+    lock.unlock();
+    writeBlock(*block);
+    lock.lock();
+
+    pending = nullptr;
+    drained.notify_one();
+  }
+}
+
+void TelemetryRecorder::writeBlock(const Block &block) {
+  // One pass over the rows, scattering into the columns.
+  for (std::uint32_t r = 0; r < block.count; r++)
+    for (std::uint32_t c = 0; c < TM_COLUMN_COUNT; c++)
+      columns[c * COLUMN_STRIDE + r] = block.rows[r][c];
+
+  writeValue(out, block.count);
+  for (std::uint32_t c = 0; c < TM_COLUMN_COUNT; c++)
+    out.write(reinterpret_cast<const char *>(columns + c * COLUMN_STRIDE),
+              block.count * sizeof(std::uint32_t));
+
+  if (!out)
+    write_failed.store(true, std::memory_order_relaxed);
+}
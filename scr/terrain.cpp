@@ -0,0 +1,250 @@
+#include "../include/terrain.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace {
+
+const char TERRAIN_MAGIC[4] = {'R', 'K', 'T', 'R'};
+const std::uint32_t TERRAIN_VERSION = 2; // 1 was in pixels.
+const std::uint32_t KIND_POLYLINE = 0;
+const std::uint32_t KIND_HEIGHTFIELD = 1;
+
+const sf::Color GROUND_COLOR(70, 60, 50);
+const sf::Color PAD_COLOR(100, 100, 100);
+
+template <typename T> void writeValue(std::ofstream &out, T value) {
+  out.write(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+template <typename T> T readValue(std::ifstream &in) {
+  T value;
+  if (!in.read(reinterpret_cast<char *>(&value), sizeof(T)))
+    throw std::runtime_error("Terrain file truncated");
+  return value;
+}
+
+} // namespace
+
+Terrain::Terrain(std::vector<sf::Vector2f> points) : points(std::move(points)) {
+  if (this->points.size() < 2)
+    throw std::runtime_error("Terrain needs at least 2 points");
+
+  for (std::size_t i = 1; i < this->points.size(); i++)
+    if (this->points[i].x <= this->points[i - 1].x)
+      throw std::runtime_error("Terrain x must be strictly increasing");
+}
+
+Terrain Terrain::heightfield(float x0, float dx,
+                             const std::vector<float> &heights) {
+  if (dx <= 0.f)
+    throw std::runtime_error("Terrain heightfield spacing must be positive");
+
+  std::vector<sf::Vector2f> points(heights.size());
+  for (std::size_t i = 0; i < heights.size(); i++)
+    points[i] = {x0 + dx * i, heights[i]};
+
+  Terrain terrain(std::move(points));
+  terrain.uniform_dx = dx;
+  return terrain;
+}
+
+Terrain Terrain::load(const std::string &path) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in)
+    throw std::runtime_error("Cannot open terrain file " + path);
+
+  char magic[4];
+  if (!in.read(magic, 4) || std::memcmp(magic, TERRAIN_MAGIC, 4) != 0)
+    throw std::runtime_error("Not a terrain file: " + path);
+  if (readValue<std::uint32_t>(in) != TERRAIN_VERSION)
+    throw std::runtime_error("Unsupported terrain file version");
+
+  const auto kind = readValue<std::uint32_t>(in);
+  const auto count = readValue<std::uint32_t>(in);
+  const auto pad_count = readValue<std::uint32_t>(in);
+
+  Terrain terrain;
+  if (kind == KIND_HEIGHTFIELD) {
+    const float x0 = readValue<float>(in);
+    const float dx = readValue<float>(in);
+
+    std::vector<float> heights(count);
+    for (auto &h : heights)
+      h = readValue<float>(in);
+    terrain = heightfield(x0, dx, heights);
+  } else if (kind == KIND_POLYLINE) {
+    std::vector<sf::Vector2f> points(count);
+    for (auto &p : points) {
+      p.x = readValue<float>(in);
+      p.y = readValue<float>(in);
+    }
+    terrain = Terrain(std::move(points));
+  } else {
+    throw std::runtime_error("Unknown terrain kind");
+  }
+
+  for (std::uint32_t i = 0; i < pad_count; i++) {
+    sf::FloatRect pad;
+    pad.left = readValue<float>(in);
+    pad.top = readValue<float>(in);
+    pad.width = readValue<float>(in);
+    pad.height = readValue<float>(in);
+    terrain.addPad(pad);
+  }
+
+  return terrain;
+}
+
+void Terrain::save(const std::string &path) const {
+  std::ofstream out(path, std::ios::binary);
+  if (!out)
+    throw std::runtime_error("Cannot write terrain file " + path);
+
+  out.write(TERRAIN_MAGIC, 4);
+  writeValue(out, TERRAIN_VERSION);
+  writeValue(out, uniform_dx > 0.f ? KIND_HEIGHTFIELD : KIND_POLYLINE);
+  writeValue(out, static_cast<std::uint32_t>(points.size()));
+  writeValue(out, static_cast<std::uint32_t>(pads.size()));
+
+  if (uniform_dx > 0.f) {
+    writeValue(out, points.front().x);
+    writeValue(out, uniform_dx);
+    for (const auto &p : points)
+      writeValue(out, p.y);
+  } else {
+    for (const auto &p : points) {
+      writeValue(out, p.x);
+      writeValue(out, p.y);
+    }
+  }
+
+  for (const auto &pad : pads) {
+    writeValue(out, pad.left);
+    writeValue(out, pad.top);
+    writeValue(out, pad.width);
+    writeValue(out, pad.height);
+  }
+}
+
+std::size_t Terrain::lowerPoint(float x) const {
+  // Index of the last point with point.x <= x, 0 left of the terrain.
+  if (x <= points.front().x)
+    return 0;
+
+  if (uniform_dx > 0.f)
+    return std::min(
+        static_cast<std::size_t>((x - points.front().x) / uniform_dx),
+        points.size() - 1);
+
+  const auto it =
+      std::upper_bound(points.begin(), points.end(), x,
+                       [](float v, const sf::Vector2f &p) { return v < p.x; });
+  return static_cast<std::size_t>(it - points.begin()) - 1;
+}
+
+void Terrain::segmentRange(float x_min, float x_max, std::size_t &first,
+                           std::size_t &last) const {
+  first = last = 0;
+  if (empty())
+    return;
+
+  const std::size_t segments = points.size() - 1;
+  first = std::min(lowerPoint(x_min), segments - 1);
+  last = std::min(lowerPoint(x_max) + 1, segments);
+}
+
+void Terrain::pointRange(float x_min, float x_max, std::size_t &first,
+                         std::size_t &last) const {
+  first = last = 0;
+  if (empty() || x_max < points.front().x || x_min > points.back().x)
+    return;
+
+  first = lowerPoint(x_min);
+  if (points[first].x < x_min)
+    first++;
+  last = lowerPoint(x_max) + 1;
+}
+
+float Terrain::groundAt(float x) const {
+  if (empty())
+    return 0.f;
+  if (x <= points.front().x)
+    return points.front().y;
+  if (x >= points.back().x)
+    return points.back().y;
+
+  const auto i = std::min(lowerPoint(x), points.size() - 2);
+  const auto &a = points[i];
+  const auto &b = points[i + 1];
+  return a.y + (b.y - a.y) * (x - a.x) / (b.x - a.x);
+}
+
+float Terrain::surfaceAt(float x) const {
+  float surface = groundAt(x);
+  for (const auto &pad : pads)
+    if (x >= pad.left && x <= pad.left + pad.width)
+      surface = std::min(surface, pad.top);
+  return surface;
+}
+
+Terrain createTerrain(float siteW, float siteH) {
+  const float dx = 1.f / 30.f;
+  const float x0 = -siteW;
+  const std::size_t count =
+      static_cast<std::size_t>(std::lround(3.f * siteW / dx)) + 1;
+
+  std::vector<sf::FloatRect> pads = {
+      {0.3f * siteW, 0.9f * siteH, 0.3f * siteW, 0.3333f},
+      {0.75f * siteW, 0.82f * siteH, 0.12f * siteW, 0.3333f}};
+
+  std::vector<float> heights(count);
+  for (std::size_t i = 0; i < count; i++) {
+    const float x = x0 + dx * i;
+    float h = 0.95f * siteH + 0.4167f * std::sin(x * 0.66f) +
+              0.2f * std::sin(x * 2.22f + 1.f) + 0.08333f * std::sin(x * 7.8f);
+
+    // Pads rest on the ground, with a ramp down to the hills on each side.
+    const float ramp = 1.f;
+    for (const auto &pad : pads) {
+      const float bottom = pad.top + pad.height;
+      const float d =
+          std::max({pad.left - x, x - (pad.left + pad.width), 0.f});
+      if (d < ramp)
+        h = bottom + (h - bottom) * (d / ramp);
+    }
+
+    heights[i] = h;
+  }
+
+  Terrain terrain = Terrain::heightfield(x0, dx, heights);
+  for (const auto &pad : pads)
+    terrain.addPad(pad);
+  return terrain;
+}
+
+TerrainMesh::TerrainMesh(const Terrain &terrain, float bottom)
+    : ground(sf::TriangleStrip), pads(sf::Quads) {
+  const auto &points = terrain.getPoints();
+
+  ground.resize(points.size() * 2);
+  for (std::size_t i = 0; i < points.size(); i++) {
+    ground[2 * i] = sf::Vertex(points[i], GROUND_COLOR);
+    ground[2 * i + 1] =
+        sf::Vertex({points[i].x, std::max(bottom, points[i].y)}, GROUND_COLOR);
+  }
+
+  const auto &rects = terrain.getPads();
+  pads.resize(rects.size() * 4);
+  for (std::size_t i = 0; i < rects.size(); i++) {
+    const auto &r = rects[i];
+    pads[4 * i] = sf::Vertex({r.left, r.top}, PAD_COLOR);
+    pads[4 * i + 1] = sf::Vertex({r.left + r.width, r.top}, PAD_COLOR);
+    pads[4 * i + 2] =
+        sf::Vertex({r.left + r.width, r.top + r.height}, PAD_COLOR);
+    pads[4 * i + 3] = sf::Vertex({r.left, r.top + r.height}, PAD_COLOR);
+  }
+}
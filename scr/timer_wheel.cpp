@@ -0,0 +1,93 @@
+#include "../include/timer_wheel.hpp"
+
+void TimerNode::unlink() {
+  if (!next)
+    return;
+  prev->next = next;
+  next->prev = prev;
+  prev = next = nullptr;
+}
+
+TimerWheel::TimerWheel() {
+  // Heads are empty circular lists.
+  for (auto &level : slots)
+    for (auto &head : level)
+      head.prev = head.next = &head;
+  overflow.prev = overflow.next = &overflow;
+}
+
+void TimerWheel::schedule(TimerNode &node, std::uint64_t deadline) {
+  node.unlink();
+  node.deadline = deadline > current ? deadline : current + 1;
+  insert(node);
+}
+
+void TimerWheel::insert(TimerNode &node) {
+  const std::uint64_t delta = node.deadline - current;
+
+  TimerNode *head = &overflow;
+  for (int level = 0; level < LEVELS; level++)
+    if (delta < std::uint64_t(1) << (BITS * (level + 1))) {
+      head = &slots[level][(node.deadline >> (BITS * level)) & (SLOTS - 1)];
+      break;
+    }
+
+  node.prev = head->prev;
+  node.next = head;
+  head->prev->next = &node;
+  head->prev = &node;
+}
+
+void TimerWheel::redistribute(TimerNode &list) {
+  if (list.next == &list)
+    return;
+
+  // Detach first: nodes can land back in this same list.
+  TimerNode *node = list.next;
+  list.prev->next = nullptr;
+  list.prev = list.next = &list;
+
+  while (node) {
+    TimerNode *following = node->next;
+    node->prev = node->next = nullptr;
+    insert(*node);
+    node = following;
+  }
+}
+
+void TimerWheel::advance() {
+  current++;
+
+  // Lower levels first: a level l slot only holds deadlines in the span
+  // that starts now, which is empty below it by then.
+  int level = 1;
+  for (; level < LEVELS; level++) {
+    if (current & ((std::uint64_t(1) << (BITS * level)) - 1))
+      break;
+    redistribute(slots[level][(current >> (BITS * level)) & (SLOTS - 1)]);
+  }
+  if (level == LEVELS &&
+      !(current & ((std::uint64_t(1) << (BITS * LEVELS)) - 1)))
+    redistribute(overflow);
+
+  // Fire from a list of their own, so a node scheduled again for a later
+  // tick (even one landing in this slot) waits for it, and fire may cancel
+  // any other node.
+  TimerNode &slot = slots[0][current & (SLOTS - 1)];
+  if (slot.next == &slot)
+    return;
+
+  TimerNode due;
+  due.next = slot.next;
+  due.prev = slot.prev;
+  due.next->prev = due.prev->next = &due;
+  slot.prev = slot.next = &slot;
+
+  while (due.next != &due) {
+    TimerNode &node = *due.next;
+    node.unlink();
+    if (node.fire)
+      node.fire(node);
+  }
+  due.prev = due.next = nullptr;
+}
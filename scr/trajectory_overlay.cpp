@@ -0,0 +1,140 @@
+#include "../include/trajectory_overlay.hpp"
+
+#include <cmath>
+
+namespace {
+
+// Farther than this from the predicted path means the prediction is stale.
+constexpr float MAX_DEVIATION = 0.033f;
+
+// Trail points closer than this to the previous one are skipped.
+constexpr float MIN_TRAIL_SPACING = 0.033f;
+
+const sf::Color TRAIL_COLOR(120, 180, 255, 160);
+const sf::Color PREDICTION_COLOR(255, 255, 255, 110);
+const sf::Color IMPACT_COLOR(255, 70, 70);
+
+float distance(const sf::Vector2f &a, const sf::Vector2f &b) {
+  return std::hypot(a.x - b.x, a.y - b.y);
+}
+
+} // namespace
+
+TrajectoryOverlay::TrajectoryOverlay(const Rocket &prototype,
+                                     const Terrain &terrain, float step_dt)
+    : scratch(prototype), terrain(terrain), step_dt(step_dt),
+      landing_height(getLandingHeight(prototype)),
+      trail_vertices(sf::LineStrip, TRAIL_CAPACITY),
+      prediction_vertices(sf::LineStrip, PREDICTION_CAPACITY),
+      impact_marker(sf::Lines, 4) {
+  // Sized once at full capacity above; later resizes stay within it.
+  trail_vertices.resize(0);
+  prediction_vertices.resize(0);
+}
+
+void TrajectoryOverlay::update(const SimState &state,
+                               sf::Vector2<double> origin, double time) {
+  now = time;
+
+  // The origin moved: the trail follows it, the prediction starts over.
+  if (origin != this->origin) {
+    const sf::Vector2f shift(static_cast<float>(this->origin.x - origin.x),
+                             static_cast<float>(this->origin.y - origin.y));
+    for (std::size_t i = 0; i < trail.size(); i++)
+      trail[i] += shift;
+    prediction.clear();
+    this->origin = origin;
+  }
+
+  if (trail.empty() || distance(trail.back(), state.pos) >= MIN_TRAIL_SPACING)
+    trail.push_back(state.pos);
+
+  // Drop the predicted points that are already in the past.
+  Point passed{};
+  bool popped = false;
+  while (!prediction.empty() && prediction.front().time <= time) {
+    passed = prediction.front();
+    prediction.pop_front();
+    popped = true;
+  }
+
+  bool on_path = false;
+  if (popped && !prediction.empty()) {
+    const auto &next = prediction.front();
+    const auto t = static_cast<float>((time - passed.time) /
+                                      (next.time - passed.time));
+    const auto expected = passed.pos + (next.pos - passed.pos) * t;
+    on_path = distance(expected, state.pos) <= MAX_DEVIATION;
+  } else if (!popped && !prediction.empty()) {
+    // Same sample as last frame.
+    on_path = true;
+  }
+
+  if (on_path)
+    extend();
+  else
+    restart(state, time);
+
+  rebuildVertices();
+}
+
+void TrajectoryOverlay::restart(const SimState &state, double time) {
+  scratch.restoreState(state);
+  prediction.clear();
+  prediction.push_back({state.pos, time});
+  impact = false;
+
+  extend();
+}
+
+void TrajectoryOverlay::extend() {
+  const ControlInput coast;
+
+  // Height of the CM above the surface (pads or ground) at its x.
+  const auto clearance = [&](const sf::Vector2f &p) {
+    const auto x = static_cast<float>(p.x + origin.x);
+    return static_cast<float>(terrain.surfaceAt(x) - landing_height -
+                              (p.y + origin.y));
+  };
+
+  while (!impact && !prediction.full()) {
+    const auto from = prediction.back();
+    stepRocket(scratch, coast, step_dt);
+    const auto to = scratch.getPos();
+
+    // Crossing the surface is the impact.
+    const float c0 = clearance(from.pos);
+    const float c1 = clearance(to);
+    if (c0 > 0.f && c1 <= 0.f) {
+      const float t = c0 / (c0 - c1);
+      const sf::Vector2f hit = from.pos + (to - from.pos) * t;
+
+      impact = true;
+      const auto x = static_cast<float>(hit.x + origin.x);
+      impact_point = {x, terrain.surfaceAt(x)};
+      impact_time = from.time + t * step_dt;
+      prediction.push_back({hit, impact_time});
+      return;
+    }
+
+    prediction.push_back({to, from.time + step_dt});
+  }
+}
+
+void TrajectoryOverlay::rebuildVertices() {
+  trail_vertices.resize(trail.size());
+  for (std::size_t i = 0; i < trail.size(); i++)
+    trail_vertices[i] = sf::Vertex(trail[i], TRAIL_COLOR);
+
+  prediction_vertices.resize(prediction.size());
+  for (std::size_t i = 0; i < prediction.size(); i++)
+    prediction_vertices[i] = sf::Vertex(prediction[i].pos, PREDICTION_COLOR);
+
+  const float s = 0.133f;
+  const sf::Vector2f p(static_cast<float>(impact_point.x - origin.x),
+                       static_cast<float>(impact_point.y - origin.y));
+  impact_marker[0] = sf::Vertex({p.x - s, p.y - s}, IMPACT_COLOR);
+  impact_marker[1] = sf::Vertex({p.x + s, p.y + s}, IMPACT_COLOR);
+  impact_marker[2] = sf::Vertex({p.x - s, p.y + s}, IMPACT_COLOR);
+  impact_marker[3] = sf::Vertex({p.x + s, p.y - s}, IMPACT_COLOR);
+}
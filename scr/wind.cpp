@@ -0,0 +1,154 @@
+#include "../include/wind.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace {
+
+// Binomial [1 2 1] passes per axis: about 3 cells of correlation.
+const int SMOOTH_PASSES = 3;
+
+std::uint32_t nextPowerOfTwo(std::uint32_t n) {
+  std::uint32_t p = 1;
+  while (p < n)
+    p <<= 1;
+  return p;
+}
+
+// One periodic [1 2 1] / 4 pass along an axis of length n and stride
+// stride, for every line of the grid.
+void smoothAxis(std::vector<float> &grid, std::vector<float> &line,
+                std::uint32_t n, std::size_t stride) {
+  const std::size_t span = n * stride;
+  for (std::size_t outer = 0; outer < grid.size(); outer += span)
+    for (std::size_t inner = 0; inner < stride; inner++) {
+      float *base = grid.data() + outer + inner;
+      for (std::uint32_t i = 0; i < n; i++)
+        line[i] = base[i * stride];
+      for (std::uint32_t i = 0; i < n; i++)
+        base[i * stride] = 0.25f * line[(i + n - 1) & (n - 1)] +
+                           0.5f * line[i] + 0.25f * line[(i + 1) & (n - 1)];
+    }
+}
+
+// Shifts and scales to mean 0, standard deviation 1.
+void normalize(std::vector<float> &grid) {
+  double sum = 0., sum2 = 0.;
+  for (const float x : grid) {
+    sum += x;
+    sum2 += double(x) * x;
+  }
+  const double mean = sum / grid.size();
+  const double variance = sum2 / grid.size() - mean * mean;
+  const float scale = variance > 0. ? float(1. / std::sqrt(variance)) : 0.f;
+  for (float &x : grid)
+    x = (x - float(mean)) * scale;
+}
+
+struct Lattice {
+  std::uint32_t i0, i1;
+  float w; // Weight of i1.
+};
+
+Lattice lattice(float coord, std::uint32_t mask) {
+  const float floor = std::floor(coord);
+  // Two's complement: negative cells wrap like positive ones.
+  const auto i0 = static_cast<std::uint32_t>(static_cast<std::int32_t>(floor));
+  return {i0 & mask, (i0 + 1) & mask, coord - floor};
+}
+
+} // namespace
+
+WindField::WindField(std::uint64_t seed, float cell, float cell_time,
+                     std::uint32_t nx, std::uint32_t ny, std::uint32_t nt)
+    : cell(cell), cell_time(cell_time), nx(nextPowerOfTwo(nx)),
+      ny(nextPowerOfTwo(ny)), nt(nextPowerOfTwo(nt)) {
+  if (!(cell > 0.f) || !(cell_time > 0.f))
+    throw std::runtime_error("WindField needs positive cell sizes");
+
+  const std::size_t size = std::size_t(this->nx) * this->ny * this->nt;
+  u.resize(size);
+  v.resize(size);
+
+  std::mt19937_64 rng(seed);
+  std::normal_distribution<float> normal;
+  for (std::size_t i = 0; i < size; i++) {
+    u[i] = normal(rng);
+    v[i] = normal(rng);
+  }
+
+  std::vector<float> line(std::max({this->nx, this->ny, this->nt}));
+  for (auto *grid : {&u, &v}) {
+    for (int pass = 0; pass < SMOOTH_PASSES; pass++) {
+      smoothAxis(*grid, line, this->nx, 1);
+      smoothAxis(*grid, line, this->ny, this->nx);
+      smoothAxis(*grid, line, this->nt, std::size_t(this->nx) * this->ny);
+    }
+    normalize(*grid);
+  }
+}
+
+float WindField::wrapTime(double time) const {
+  const double period = double(cell_time) * nt;
+  double t = std::fmod(time, period);
+  if (t < 0.)
+    t += period;
+  const auto cells = static_cast<float>(t / cell_time);
+  // Rounding can land exactly on nt.
+  return cells < float(nt) ? cells : 0.f;
+}
+
+float WindField::meanSpeed(const WindParams &params, float y) {
+  const float height = params.ground_y - y;
+  if (params.speed == 0.f || height <= 0.f)
+    return 0.f;
+  return params.speed *
+         std::pow(height / params.reference_height, params.shear);
+}
+
+void WindField::sample(const WindParams &params, const float *x,
+                       const float *y, std::size_t n, double time, float *u_out,
+                       float *v_out) const {
+  if (params.gust == 0.f) {
+    for (std::size_t i = 0; i < n; i++) {
+      u_out[i] = meanSpeed(params, y[i]);
+      v_out[i] = 0.f;
+    }
+    return;
+  }
+
+  // One time for the batch: both time slices and their weight are shared.
+  const auto t = lattice(wrapTime(time + params.phase), nt - 1);
+  const std::size_t plane = std::size_t(nx) * ny;
+  const float *u0 = u.data() + t.i0 * plane, *u1 = u.data() + t.i1 * plane;
+  const float *v0 = v.data() + t.i0 * plane, *v1 = v.data() + t.i1 * plane;
+  const float inv_cell = 1.f / cell;
+
+  for (std::size_t i = 0; i < n; i++) {
+    const auto lx = lattice(x[i] * inv_cell, nx - 1);
+    const auto ly = lattice(y[i] * inv_cell, ny - 1);
+    const std::size_t c00 = ly.i0 * nx + lx.i0, c10 = ly.i0 * nx + lx.i1;
+    const std::size_t c01 = ly.i1 * nx + lx.i0, c11 = ly.i1 * nx + lx.i1;
+
+    const float w00 = (1.f - lx.w) * (1.f - ly.w), w10 = lx.w * (1.f - ly.w);
+    const float w01 = (1.f - lx.w) * ly.w, w11 = lx.w * ly.w;
+
+    auto bilinear = [&](const float *g) {
+      return w00 * g[c00] + w10 * g[c10] + w01 * g[c01] + w11 * g[c11];
+    };
+    const float ua = bilinear(u0), ub = bilinear(u1);
+    const float va = bilinear(v0), vb = bilinear(v1);
+
+    u_out[i] = meanSpeed(params, y[i]) + params.gust * (ua + (ub - ua) * t.w);
+    v_out[i] = params.gust * (va + (vb - va) * t.w);
+  }
+}
+
+sf::Vector2f WindField::sample(const WindParams &params, sf::Vector2f pos,
+                               double time) const {
+  sf::Vector2f wind;
+  sample(params, &pos.x, &pos.y, 1, time, &wind.x, &wind.y);
+  return wind;
+}
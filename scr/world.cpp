@@ -0,0 +1,555 @@
+#include "../include/world.hpp"
+#include "../include/profiler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+
+// Sleeping vehicles do not move in a pair: infinite mass.
+float inverseMass(const Rocket &rocket, bool sleeping) {
+  return sleeping ? 0.f : 1.f / rocket.getMass();
+}
+float inverseInertia(const Rocket &rocket, bool sleeping) {
+  return sleeping ? 0.f : 1.f / rocket.getInertia();
+}
+
+bool hasCommand(const ControlInput &input) {
+  return input.bottom || input.left || input.right ||
+         input.dBottomOut != 0.f || input.dLeftOut != 0.f ||
+         input.dRightOut != 0.f || input.dBottomAe != 0.f ||
+         input.dLeftAe != 0.f || input.dRightAe != 0.f || input.stage != 0;
+}
+
+} // namespace
+
+World::Vehicle::Vehicle(const Rocket &rocket, Precision precision)
+    : rocket(rocket), contacts(rocket), flight(precision, rocket) {}
+
+World::World(const Terrain &terrain, unsigned threads, Precision precision)
+    : terrain(terrain), precision(precision), pool(threads) {}
+
+std::size_t World::addVehicle(const Rocket &rocket) {
+  const auto index = vehicles.size();
+
+  vehicles.emplace_back(rocket, precision);
+  auto &vehicle = vehicles.back();
+  vehicle.contacts.setTerrain(terrain);
+  vehicle.contacts.setOrigin(sf::Vector2f(origin));
+  vehicle.bounds = vehicle.contacts.hullBounds(rocket.getTransform());
+
+  order.push_back(static_cast<std::uint32_t>(index));
+
+  wind_vehicles.reserve(vehicles.size());
+  active.reserve(vehicles.size());
+  coupled.reserve(vehicles.size());
+  for (auto *batch : {&wind_x, &wind_y, &wind_u, &wind_v})
+    batch->resize(vehicles.size());
+  return index;
+}
+
+std::size_t World::addStage(std::size_t vehicle, std::uint8_t stage,
+                            const Rocket &prototype, sf::Vector2f offset) {
+  // Shaped as it will separate, so its hull and bounds start right.
+  Rocket whole = vehicles[vehicle].rocket;
+  Rocket body = prototype;
+  whole.separate(stage, body, offset);
+
+  const auto index = addVehicle(body);
+  auto &added = vehicles[index];
+  added.mounted = true;
+  added.parent = static_cast<std::uint32_t>(vehicle);
+  added.stage = stage;
+  added.offset = offset;
+
+  // Its terrain broadphase is built on the first query: now, not in the
+  // step it separates. And it touches its vehicle as it separates: room
+  // for that pair.
+  ContactManifold unused;
+  added.contacts.collide(added.rocket, unused);
+  pairs.reserve(pairs.capacity() + 1);
+  previous.reserve(previous.capacity() + 1);
+  return index;
+}
+
+void World::setInput(std::size_t i, const ControlInput &input) {
+  vehicles[i].input = input;
+  if (hasCommand(input))
+    wake(i);
+}
+
+void World::wake(std::size_t i) {
+  vehicles[i].sleeping = false;
+  vehicles[i].rest_time = 0.f;
+}
+
+void World::saveState(WorldState &state) const {
+  state.vehicles.resize(vehicles.size());
+  for (std::size_t i = 0; i < vehicles.size(); i++) {
+    const auto &vehicle = vehicles[i];
+    auto &saved = state.vehicles[i];
+
+    vehicle.rocket.saveState(saved.rocket);
+    saved.manifold = vehicle.contacts.getManifold();
+    saved.contact = vehicle.contact;
+    saved.bounds = vehicle.bounds;
+    saved.sleeping = vehicle.sleeping;
+    saved.mounted = vehicle.mounted;
+    saved.rest_time = vehicle.rest_time;
+  }
+
+  state.order = order;
+  state.pairs = pairs;
+  state.flights.resize(precision != Precision::FLOAT ? vehicles.size() : 0);
+  for (std::size_t i = 0; i < state.flights.size(); i++)
+    state.flights[i] = vehicles[i].flight;
+  state.time = time;
+  state.origin = origin;
+}
+
+void World::restoreState(const WorldState &state) {
+  if (state.vehicles.size() != vehicles.size() ||
+      state.order.size() != order.size())
+    throw std::runtime_error("World state has another vehicle count");
+  // Flight models of this world's precision, when the state has them.
+  const bool flights = state.flights.size() == vehicles.size() &&
+                       !state.flights.empty() &&
+                       state.flights[0].getPrecision() == precision;
+
+  for (std::size_t i = 0; i < vehicles.size(); i++) {
+    auto &vehicle = vehicles[i];
+    const auto &saved = state.vehicles[i];
+
+    vehicle.rocket.restoreState(saved.rocket);
+    vehicle.contacts.setManifold(saved.manifold);
+    vehicle.contact = saved.contact;
+    vehicle.input = {};
+    vehicle.sleeping = saved.sleeping != 0;
+    vehicle.mounted = saved.mounted != 0;
+    vehicle.rest_time = saved.rest_time;
+    vehicle.bounds = saved.bounds;
+    if (flights)
+      vehicle.flight = state.flights[i];
+    else
+      vehicle.syncFlight();
+  }
+
+  order = state.order;
+  pairs = state.pairs;
+  time = state.time;
+  origin = state.origin;
+  for (auto &vehicle : vehicles)
+    vehicle.contacts.setOrigin(sf::Vector2f(origin));
+}
+
+void World::rebase(sf::Vector2f shift) {
+  origin.x += shift.x;
+  origin.y += shift.y;
+
+  for (auto &vehicle : vehicles) {
+    vehicle.rocket.applyPos(-shift);
+    vehicle.flight.shift(shift);
+    vehicle.contacts.setOrigin(sf::Vector2f(origin));
+    vehicle.bounds.left -= shift.x;
+    vehicle.bounds.top -= shift.y;
+  }
+  for (auto &pair : pairs)
+    for (int k = 0; k < pair.count; k++)
+      pair.points[k].point -= shift;
+}
+
+void World::followFocus() {
+  const auto &pos = vehicles[focus].rocket.getPos();
+  if (!(std::max(std::abs(pos.x), std::abs(pos.y)) > rebase_distance))
+    return;
+
+  const auto snap = [](float v) {
+    return std::round(v / REBASE_GRID) * REBASE_GRID;
+  };
+  rebase({snap(pos.x), snap(pos.y)});
+}
+
+void World::setWind(const WindField *field, const WindParams &params) {
+  wind_field = field;
+  wind_params = params;
+  windy = field || params.speed != 0.f;
+  if (!windy)
+    for (auto &vehicle : vehicles)
+      vehicle.rocket.setWind({0.f, 0.f});
+}
+
+void World::sampleWind() {
+  wind_vehicles.clear();
+  for (std::uint32_t i = 0; i < vehicles.size(); i++) {
+    if (vehicles[i].sleeping || vehicles[i].mounted)
+      continue;
+    const auto pos = getWorldPos(i);
+    wind_x[wind_vehicles.size()] = static_cast<float>(pos.x);
+    wind_y[wind_vehicles.size()] = static_cast<float>(pos.y);
+    wind_vehicles.push_back(i);
+  }
+
+  const auto n = wind_vehicles.size();
+  if (wind_field) {
+    wind_field->sample(wind_params, wind_x.data(), wind_y.data(), n, time,
+                       wind_u.data(), wind_v.data());
+  } else {
+    for (std::size_t k = 0; k < n; k++) {
+      wind_u[k] = WindField::meanSpeed(wind_params, wind_y[k]);
+      wind_v[k] = 0.f;
+    }
+  }
+
+  for (std::size_t k = 0; k < n; k++)
+    vehicles[wind_vehicles[k]].rocket.setWind({wind_u[k], wind_v[k]});
+}
+
+void World::step(float dt) {
+  PROFILE_SCOPE(PROFILE_WORLD_STEP);
+
+  for (std::uint32_t i = 0; i < vehicles.size(); i++)
+    if (vehicles[i].input.stage != 0)
+      separateStage(i);
+  if (rebase_distance > 0.f && focus < vehicles.size())
+    followFocus();
+  if (windy)
+    sampleWind();
+
+  // Vehicles against the terrain do not depend on each other.
+  pool.parallelFor(vehicles.size(), [&](std::size_t i, unsigned) {
+    auto &vehicle = vehicles[i];
+    vehicle.touching = false;
+    if (vehicle.mounted)
+      return;
+    if (!vehicle.sleeping)
+      stepVehicle(vehicle, dt);
+    else
+      vehicle.contact.impact_len_vel = 0.f; // Still resting, no new impact.
+  });
+
+  PROFILE_SCOPE(PROFILE_PAIRS);
+  previous.swap(pairs);
+  findPairs();
+
+  for (auto &pair : pairs)
+    preparePair(pair);
+
+  // Vehicles in a pair keep iterating their terrain contacts along with the
+  // pairs, so a vehicle pushed into the ground by another one is held by it
+  // in the same step instead of the next.
+  coupled.clear();
+  for (std::uint32_t i = 0; i < vehicles.size(); i++)
+    if (vehicles[i].touching && !vehicles[i].sleeping)
+      coupled.push_back(i);
+
+  for (int it = 0; it < iterations; it++) {
+    for (auto &pair : pairs)
+      solvePair(pair);
+    for (const auto i : coupled)
+      vehicles[i].contacts.relax(vehicles[i].rocket, 1);
+  }
+
+  for (auto &pair : pairs)
+    correctPair(pair);
+  for (auto &vehicle : vehicles)
+    if (vehicle.touching && !vehicle.sleeping)
+      vehicle.syncFlight();
+
+  stats.awake = stats.sleeping = stats.mounted = 0;
+  for (auto &vehicle : vehicles) {
+    if (vehicle.mounted) {
+      stats.mounted++;
+      continue;
+    }
+    updateSleep(vehicle, dt);
+    if (vehicle.sleeping)
+      stats.sleeping++;
+    else
+      stats.awake++;
+  }
+  stats.touching_pairs = pairs.size();
+  time += dt;
+}
+
+void World::separateStage(std::uint32_t parent) {
+  const auto stage = vehicles[parent].input.stage;
+  vehicles[parent].input.stage = 0;
+  if (vehicles[parent].mounted)
+    return;
+
+  // Already separated (or never added): nothing to do, as for an engine
+  // fired with an empty tank.
+  for (auto &body : vehicles) {
+    if (!body.mounted || body.parent != parent || body.stage != stage)
+      continue;
+
+    vehicles[parent].rocket.separate(stage, body.rocket, body.offset);
+    vehicles[parent].syncFlight();
+    body.syncFlight();
+    body.mounted = false;
+    body.sleeping = false;
+    body.rest_time = 0.f;
+    body.input = {};
+    body.contact = {};
+    body.contacts.setManifold({});
+    body.bounds = body.contacts.hullBounds(body.rocket.getTransform());
+    return;
+  }
+}
+
+void World::stepVehicle(Vehicle &vehicle, float dt) {
+  vehicle.contact =
+      vehicle.flight.step(vehicle.contacts, vehicle.rocket, vehicle.input, dt);
+  vehicle.input = {};
+  vehicle.bounds =
+      vehicle.contacts.hullBounds(vehicle.rocket.getTransform());
+}
+
+void World::findPairs() {
+  // Bounds move little per step, so the previous order is nearly sorted.
+  for (std::size_t i = 1; i < order.size(); i++) {
+    const auto item = order[i];
+    const float left = vehicles[item].bounds.left;
+
+    std::size_t j = i;
+    for (; j > 0 && vehicles[order[j - 1]].bounds.left > left; j--)
+      order[j] = order[j - 1];
+    order[j] = item;
+  }
+
+  pairs.clear();
+  active.clear();
+  stats.pairs = 0;
+
+  for (const auto index : order) {
+    if (vehicles[index].mounted)
+      continue;
+    const auto &bounds = vehicles[index].bounds;
+
+    // Drop the vehicles that end before this one starts.
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [&](std::uint32_t other) {
+                                  const auto &b = vehicles[other].bounds;
+                                  return b.left + b.width < bounds.left;
+                                }),
+                 active.end());
+
+    for (const auto other : active) {
+      const auto &b = vehicles[other].bounds;
+      if (b.top > bounds.top + bounds.height || bounds.top > b.top + b.height)
+        continue;
+      if (vehicles[index].sleeping && vehicles[other].sleeping)
+        continue;
+
+      stats.pairs++;
+      pairs.emplace_back();
+      if (!collidePair(std::min(index, other), std::max(index, other),
+                       pairs.back())) {
+        pairs.pop_back();
+        continue;
+      }
+
+      // A moving vehicle wakes a sleeping one; a resting one leans on it
+      // as on static ground.
+      if (vehicles[index].sleeping && isMoving(vehicles[other]))
+        wake(index);
+      if (vehicles[other].sleeping && isMoving(vehicles[index]))
+        wake(other);
+      vehicles[index].touching = vehicles[other].touching = true;
+    }
+
+    active.push_back(index);
+  }
+
+  // Sorted by key for the warm start lookup.
+  std::sort(pairs.begin(), pairs.end(),
+            [](const PairManifold &x, const PairManifold &y) {
+              return x.key() < y.key();
+            });
+}
+
+bool World::collidePair(std::uint32_t a, std::uint32_t b,
+                        PairManifold &out) const {
+  out.a = a;
+  out.b = b;
+  out.count = 0;
+
+  const auto &va = vehicles[a];
+  const auto &vb = vehicles[b];
+  const sf::Transform ta = va.rocket.getTransform();
+  const sf::Transform tb = vb.rocket.getTransform();
+  const sf::Transform ia = ta.getInverse();
+  const sf::Transform ib = tb.getInverse();
+
+  // Hull vertices of one vehicle inside the parts of the other; the normal
+  // out of the other's part points into it, flipped to run from a to b.
+  const auto add = [&](const ContactSolver &from, const sf::Transform &tf,
+                       const ContactSolver &into, const sf::Transform &ti,
+                       const sf::Transform &ii, float sign,
+                       std::uint32_t kind) {
+    const auto &hull = from.getHull();
+    for (std::uint32_t v = 0; v < hull.size(); v++) {
+      if (out.count == MAX_PAIR_CONTACTS)
+        return;
+
+      const auto world = tf.transformPoint(hull[v]);
+      float depth;
+      sf::Vector2f normal;
+      const int p = into.pointInParts(world, ti, ii, depth, normal);
+      if (p < 0)
+        continue;
+
+      auto &contact = out.points[out.count++];
+      contact = {};
+      contact.point = world;
+      contact.normal = normal * sign;
+      contact.penetration = depth;
+      contact.id = kind | v << 8 | static_cast<std::uint32_t>(p);
+    }
+  };
+
+  add(va.contacts, ta, vb.contacts, tb, ib, 1.f, 0u);
+  add(vb.contacts, tb, va.contacts, ta, ia, -1.f, 1u << 16);
+
+  return out.count > 0;
+}
+
+void World::preparePair(PairManifold &pair) {
+  auto &a = vehicles[pair.a].rocket;
+  auto &b = vehicles[pair.b].rocket;
+  const bool sa = vehicles[pair.a].sleeping, sb = vehicles[pair.b].sleeping;
+  const float ima = inverseMass(a, sa), iia = inverseInertia(a, sa);
+  const float imb = inverseMass(b, sb), iib = inverseInertia(b, sb);
+
+  const auto found = std::lower_bound(
+      previous.begin(), previous.end(), pair.key(),
+      [](const PairManifold &m, std::uint64_t key) { return m.key() < key; });
+  const PairManifold *last =
+      found != previous.end() && found->key() == pair.key() ? &*found
+                                                             : nullptr;
+
+  for (int i = 0; i < pair.count; i++) {
+    auto &c = pair.points[i];
+    const sf::Vector2f t(-c.normal.y, c.normal.x);
+
+    c.ra = c.point - a.getPos();
+    c.rb = c.point - b.getPos();
+
+    const float rna = cross(c.ra, c.normal), rnb = cross(c.rb, c.normal);
+    const float rta = cross(c.ra, t), rtb = cross(c.rb, t);
+    c.normal_mass = 1.f / (ima + imb + iia * rna * rna + iib * rnb * rnb);
+    c.tangent_mass = 1.f / (ima + imb + iia * rta * rta + iib * rtb * rtb);
+
+    // Bounce only on real impacts.
+    const auto dv = b.getVel() + cross(b.getAngularVel(), c.rb) - a.getVel() -
+                    cross(a.getAngularVel(), c.ra);
+    const float vn = dot(dv, c.normal);
+    c.bias = vn < -restitution_speed ? -restitution * vn : 0.f;
+
+    if (!last)
+      continue;
+
+    for (int j = 0; j < last->count; j++) {
+      if (last->points[j].id != c.id)
+        continue;
+
+      c.normal_impulse = last->points[j].normal_impulse;
+      c.tangent_impulse = last->points[j].tangent_impulse;
+
+      const auto P = c.normal * c.normal_impulse + t * c.tangent_impulse;
+      a.applyVel(-P * ima);
+      a.applyAngVel(-cross(c.ra, P) * iia);
+      b.applyVel(P * imb);
+      b.applyAngVel(cross(c.rb, P) * iib);
+      break;
+    }
+  }
+}
+
+void World::solvePair(PairManifold &pair) {
+  auto &a = vehicles[pair.a].rocket;
+  auto &b = vehicles[pair.b].rocket;
+  const bool sa = vehicles[pair.a].sleeping, sb = vehicles[pair.b].sleeping;
+  const float ima = inverseMass(a, sa), iia = inverseInertia(a, sa);
+  const float imb = inverseMass(b, sb), iib = inverseInertia(b, sb);
+
+  const auto apply = [&](const PairContact &c, const sf::Vector2f &P) {
+    a.applyVel(-P * ima);
+    a.applyAngVel(-cross(c.ra, P) * iia);
+    b.applyVel(P * imb);
+    b.applyAngVel(cross(c.rb, P) * iib);
+  };
+  const auto relative = [&](const PairContact &c) {
+    return b.getVel() + cross(b.getAngularVel(), c.rb) - a.getVel() -
+           cross(a.getAngularVel(), c.ra);
+  };
+
+  for (int i = 0; i < pair.count; i++) {
+    auto &c = pair.points[i];
+    const sf::Vector2f t(-c.normal.y, c.normal.x);
+
+    // Friction, bounded by the normal impulse.
+    float dPt = -c.tangent_mass * dot(relative(c), t);
+    const float maxPt = friction * c.normal_impulse;
+    const float Pt = std::clamp(c.tangent_impulse + dPt, -maxPt, maxPt);
+    dPt = Pt - c.tangent_impulse;
+    c.tangent_impulse = Pt;
+    apply(c, t * dPt);
+
+    // Normal: accumulated impulse never pulls.
+    float dPn = c.normal_mass * (-dot(relative(c), c.normal) + c.bias);
+    const float Pn = std::max(c.normal_impulse + dPn, 0.f);
+    dPn = Pn - c.normal_impulse;
+    c.normal_impulse = Pn;
+    apply(c, c.normal * dPn);
+  }
+}
+
+void World::correctPair(PairManifold &pair) {
+  // Translation only, split by inverse mass, as ContactSolver does.
+  auto &a = vehicles[pair.a].rocket;
+  auto &b = vehicles[pair.b].rocket;
+  const float ima = inverseMass(a, vehicles[pair.a].sleeping);
+  const float imb = inverseMass(b, vehicles[pair.b].sleeping);
+  const float share_a = ima / (ima + imb);
+
+  sf::Vector2f separation = {0.f, 0.f}; // Moves b away from a.
+  for (int it = 0; it < position_iterations; it++) {
+    for (int i = 0; i < pair.count; i++) {
+      const auto &c = pair.points[i];
+      const float C = c.penetration - dot(separation, c.normal) - slop;
+      if (C > 0.f)
+        separation += c.normal * (position_correction * C);
+    }
+  }
+
+  a.applyPos(-separation * share_a);
+  b.applyPos(separation * (1.f - share_a));
+}
+
+bool World::isMoving(const Vehicle &vehicle) const {
+  return !vehicle.sleeping &&
+         (vehicle.rocket.getLenVel() >= sleep_speed * sleep_speed ||
+          std::abs(vehicle.rocket.getAngularVel()) >= sleep_angular_speed);
+}
+
+void World::updateSleep(Vehicle &vehicle, float dt) {
+  if (vehicle.sleeping)
+    return;
+
+  const bool resting =
+      (vehicle.contact.touched || vehicle.touching) && !isMoving(vehicle);
+
+  if (!resting) {
+    vehicle.rest_time = 0.f;
+    return;
+  }
+
+  vehicle.rest_time += dt;
+  if (vehicle.rest_time >= sleep_time) {
+    vehicle.sleeping = true;
+    vehicle.rocket.applyVel(-vehicle.rocket.getVel());
+    vehicle.rocket.setAngVel(0.f);
+  }
+}
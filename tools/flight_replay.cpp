@@ -0,0 +1,161 @@
+#include "../include/profiler.hpp"
+#include "../include/replay.hpp"
+#include "../include/scenario.hpp"
+#include "../include/simulation.hpp"
+#include "../include/terrain.hpp"
+#include "../include/world.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+/*
+        Headless flight log replay, as fast as the physics runs.
+
+        flight-replay LOG [--terrain FILE] [--scenario FILE] [--seek SECONDS]
+                          [--every SECONDS] [--profile FILE]
+
+        Without --seek the whole log is replayed, printing every impact above
+  the crash speed and the player state every --every seconds. With --seek
+  the world jumps to that time (nearest keyframe, then fast forward) and
+  the state there is printed. The terrain must be the one the flight used:
+  the built-in one unless main was given a file; so must the scenario,
+  whose vehicle, wind and rebase_distance the flight used. The precision
+  is the log's own. --profile writes the profiler histograms of the run as
+  JSON.
+*/
+
+using Clock = std::chrono::steady_clock;
+
+double elapsedMs(Clock::time_point since) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - since)
+      .count();
+}
+
+void printVehicle(const World &world, std::size_t i, double t) {
+  const auto &rocket = world.getVehicle(i);
+  const auto &contact = world.getContact(i);
+  const auto pos = world.getWorldPos(i);
+  std::printf("t=%9.3f  vehicle %zu  pos (%.2f, %.2f)  vel (%.2f, %.2f)  "
+              "angle %.4f  mass %.2f  %s\n",
+              t, i, pos.x, pos.y, rocket.getVel().x,
+              rocket.getVel().y, rocket.getAngle(), rocket.getMass(),
+              world.isSleeping(i)     ? "sleeping"
+              : contact.touched       ? "contact"
+                                      : "flying");
+}
+
+void replayAll(FlightReplay &replay, World &world, double every) {
+  const double dt = replay.getDt();
+  const auto print_ticks =
+      std::max<std::uint64_t>(1, static_cast<std::uint64_t>(every / dt + 0.5));
+  const auto begin = Clock::now();
+
+  replay.seek(world, 0);
+  while (replay.step(world)) {
+    const double t = replay.getTick() * dt;
+
+    for (std::size_t i = 0; i < world.size(); i++) {
+      const auto &contact = world.getContact(i);
+      if (contact.touched &&
+          contact.impact_len_vel > CRASH_SPEED * CRASH_SPEED)
+        std::printf("t=%9.3f  vehicle %zu  impact, len_vel %.1f\n", t, i,
+                    contact.impact_len_vel);
+    }
+
+    if (replay.getTick() % print_ticks == 0)
+      for (std::size_t i = 0; i < world.size(); i++)
+        printVehicle(world, i, t);
+  }
+
+  const double run_ms = elapsedMs(begin);
+  std::printf("replayed in %.1f ms (%.0fx real time)\n", run_ms,
+              replay.getTicks() * dt * 1000. / std::max(run_ms, 1e-3));
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr,
+                 "usage: %s LOG [--terrain FILE] [--scenario FILE] "
+                 "[--seek SECONDS] [--every SECONDS] [--profile FILE]\n",
+                 argv[0]);
+    return 2;
+  }
+
+  const char *terrain_path = nullptr;
+  const char *scenario_path = nullptr;
+  double seek = -1.;
+  double every = 10.;
+  const char *profile_path = nullptr;
+  for (int i = 2; i + 1 < argc; i += 2) {
+    if (!std::strcmp(argv[i], "--terrain"))
+      terrain_path = argv[i + 1];
+    else if (!std::strcmp(argv[i], "--scenario"))
+      scenario_path = argv[i + 1];
+    else if (!std::strcmp(argv[i], "--seek"))
+      seek = std::atof(argv[i + 1]);
+    else if (!std::strcmp(argv[i], "--every"))
+      every = std::atof(argv[i + 1]);
+    else if (!std::strcmp(argv[i], "--profile"))
+      profile_path = argv[i + 1];
+  }
+
+  try {
+    auto begin = Clock::now();
+    FlightReplay replay(argv[1]);
+    const double load_ms = elapsedMs(begin);
+
+    const Terrain terrain =
+        terrain_path ? Terrain::load(terrain_path)
+                     : createTerrain(SITE_WIDTH, SITE_HEIGHT);
+    ScenarioFile scenario;
+    scenario.base = defaultScenario(SITE_WIDTH, SITE_HEIGHT);
+    if (scenario_path)
+      scenario = ScenarioFile::load(scenario_path, SITE_WIDTH, SITE_HEIGHT);
+    const auto wind = scenario.windField();
+
+    // In the recorded precision: a log only replays into its own.
+    World world(terrain, std::thread::hardware_concurrency(),
+                replay.getPrecision());
+    const auto prototype = createRocket(scenario.base.rocket);
+    world.addVehicle(prototype);
+    world.setWind(wind.get(), scenario.base.wind);
+    world.rebase_distance = scenario.base.rebase_distance;
+
+    const double dt = replay.getDt();
+    std::printf("%s: %llu ticks (%.1f s), %zu keyframes, loaded in %.2f ms\n",
+                argv[1], static_cast<unsigned long long>(replay.getTicks()),
+                replay.getTicks() * dt, replay.getKeyframes(), load_ms);
+
+    if (seek >= 0.) {
+      begin = Clock::now();
+      replay.seek(world, static_cast<std::uint64_t>(seek / dt + 0.5));
+      const double seek_ms = elapsedMs(begin);
+
+      std::printf("seek to tick %llu in %.3f ms\n",
+                  static_cast<unsigned long long>(replay.getTick()), seek_ms);
+      for (std::size_t i = 0; i < world.size(); i++)
+        printVehicle(world, i, replay.getTick() * dt);
+    } else {
+      replayAll(replay, world, every);
+    }
+
+    if (profile_path) {
+      std::ofstream out(profile_path);
+      Profiler::writeJson(out, Profiler::snapshot());
+      if (!out)
+        throw std::runtime_error(std::string("Cannot write ") + profile_path);
+    }
+
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,112 @@
+#include "../include/scenario.hpp"
+#include "../include/thread_pool.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <mutex>
+#include <string>
+
+/*
+        Headless runs of a scenario file, all cores, one table row per run.
+
+        rocket-sweep SCENARIO [--out FILE] [--threads N] [--terrain FILE]
+
+        Without a sweep in the file the single run is printed. With one,
+  every point of the design is flown in its own World and written to
+  --out (default sweep.rksw; a .csv name writes CSV) as it finishes, see
+  SweepWriter for the layout. A run that throws (an impossible vehicle)
+  is kept as a failed row. The terrain must be the one main uses: the
+  built-in one unless given a file.
+*/
+
+using Clock = std::chrono::steady_clock;
+
+void printResult(const ScenarioResult &result) {
+  const float *metrics = reinterpret_cast<const float *>(&result);
+  for (std::size_t i = 0; i < SCENARIO_METRIC_COUNT; i++)
+    std::printf("%-14s %12.4f\n", SCENARIO_METRICS[i], metrics[i]);
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr,
+                 "usage: %s SCENARIO [--out FILE] [--threads N] "
+                 "[--terrain FILE]\n",
+                 argv[0]);
+    return 2;
+  }
+
+  const char *out_path = "sweep.rksw";
+  const char *terrain_path = nullptr;
+  unsigned threads = std::thread::hardware_concurrency();
+  for (int i = 2; i + 1 < argc; i += 2) {
+    if (!std::strcmp(argv[i], "--out"))
+      out_path = argv[i + 1];
+    else if (!std::strcmp(argv[i], "--threads"))
+      threads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+    else if (!std::strcmp(argv[i], "--terrain"))
+      terrain_path = argv[i + 1];
+  }
+
+  try {
+    const auto file = ScenarioFile::load(argv[1], SITE_WIDTH, SITE_HEIGHT);
+    const Terrain terrain =
+        terrain_path ? Terrain::load(terrain_path)
+                     : createTerrain(SITE_WIDTH, SITE_HEIGHT);
+    const auto wind = file.windField();
+
+    if (file.sweep.kind == SweepKind::NONE) {
+      printResult(runScenario(file.base, terrain, wind.get()));
+      return 0;
+    }
+
+    const auto design = file.sweep.expand();
+    const std::size_t runs = file.sweep.size();
+    const std::size_t dims = file.sweep.axes.size();
+
+    SweepWriter writer(out_path, file.sweep);
+    ThreadPool pool(threads);
+    std::atomic<std::size_t> failed{0};
+    std::atomic<std::size_t> done{0};
+    std::mutex progress;
+    auto last_report = Clock::now();
+    const auto begin = last_report;
+
+    std::printf("%s: %zu runs over %zu parameters on %u threads -> %s\n",
+                argv[1], runs, dims, pool.size(), out_path);
+
+    pool.parallelFor(runs, [&](std::size_t i, unsigned) {
+      const float *values = design.data() + i * dims;
+      try {
+        const auto result = runScenario(file.at(values), terrain, wind.get());
+        writer.write(static_cast<std::uint32_t>(i), values, &result);
+      } catch (const std::exception &) {
+        writer.write(static_cast<std::uint32_t>(i), values, nullptr);
+        failed++;
+      }
+
+      const auto finished = ++done;
+      std::unique_lock<std::mutex> lock(progress, std::try_to_lock);
+      if (lock && Clock::now() - last_report > std::chrono::seconds(1)) {
+        last_report = Clock::now();
+        std::fprintf(stderr, "%zu / %zu\n", finished, runs);
+      }
+    });
+
+    writer.close();
+    if (writer.failed())
+      throw std::runtime_error(std::string("Cannot write ") + out_path);
+
+    const double seconds =
+        std::chrono::duration<double>(Clock::now() - begin).count();
+    std::printf("%zu runs (%zu failed) in %.2f s, %.1f runs/s\n", runs,
+                failed.load(), seconds, runs / std::max(seconds, 1e-9));
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+}
@@ -0,0 +1,81 @@
+#include "../include/live_telemetry.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <thread>
+
+/*
+        Prints the live telemetry ring of a running simulator.
+
+        telemetry-reader [--name NAME] [--vehicle INDEX] [--every N] [--all]
+
+        Starts at the latest sample (--all: the oldest still in the ring) and
+  prints every Nth sample of the chosen vehicle, or of all of them without
+  --vehicle, with the running count of samples it was too slow to see.
+  Polls every millisecond when caught up; the simulator never waits on it.
+*/
+
+int main(int argc, char **argv) {
+  const char *name = LIVE_TELEMETRY_NAME;
+  long vehicle = -1;
+  long every = 1;
+  bool all = false;
+
+  for (int i = 1; i < argc; i++) {
+    if (!std::strcmp(argv[i], "--all"))
+      all = true;
+    else if (i + 1 < argc && !std::strcmp(argv[i], "--name"))
+      name = argv[++i];
+    else if (i + 1 < argc && !std::strcmp(argv[i], "--vehicle"))
+      vehicle = std::atol(argv[++i]);
+    else if (i + 1 < argc && !std::strcmp(argv[i], "--every"))
+      every = std::max(1l, std::atol(argv[++i]));
+    else {
+      std::fprintf(stderr,
+                   "usage: %s [--name NAME] [--vehicle INDEX] [--every N] "
+                   "[--all]\n",
+                   argv[0]);
+      return 2;
+    }
+  }
+
+  try {
+    LiveTelemetryReader reader(name);
+    if (!all)
+      reader.skipToLatest();
+
+    LiveSample sample;
+    long seen = 0;
+
+    for (;;) {
+      if (!reader.next(sample)) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        continue;
+      }
+      if (vehicle >= 0 && sample.vehicle != static_cast<std::uint32_t>(vehicle))
+        continue;
+      if (seen++ % every != 0)
+        continue;
+
+      std::printf("tick %8llu  v%-3u pos (%8.2f, %8.2f)  vel (%7.2f, %7.2f)  "
+                  "angle %7.2f deg  mass %7.2f  fuel %6.2f  "
+                  "out %5.2f/%5.2f/%5.2f  %s%s dropped %llu\n",
+                  static_cast<unsigned long long>(sample.tick), sample.vehicle,
+                  sample.pos[0], sample.pos[1], sample.vel[0], sample.vel[1],
+                  sample.angle * RADIANS_TO_DEGREES, sample.mass,
+                  sample.fuel_mass, sample.output[0], sample.output[1],
+                  sample.output[2],
+                  sample.flags & LIVE_CONTACT ? "contact " : "",
+                  sample.flags & LIVE_SLEEPING ? "sleeping " : "",
+                  static_cast<unsigned long long>(reader.getDropped()));
+      std::fflush(stdout);
+    }
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+}